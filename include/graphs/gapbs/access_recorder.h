@@ -0,0 +1,482 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef ACCESS_RECORDER_H_
+#define ACCESS_RECORDER_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "access_trace.h"
+#include "pickle_job.h"
+#include "wrapper.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  AccessRecorder, TracedIterator
+
+Records which arrays index which during a run and proposes a PickleJob
+ - Only compiled in with PICKLE_TRACE_ACCESSES=1; then pvector::operator[],
+   Bitmap::get_bit, CSRGraph::out_neigh/in_neigh with iteration over the
+   Neighborhood, and iteration over a SlidingQueue report each element they
+   read to AccessRecorder::Get(), identified by the array's descriptor
+ - Each thread keeps its last kRecentValues loaded values. When an access to
+   array B uses an index equal to a recent value loaded from array A, that is
+   an Index link A -> B; when its address equals a recent value, a Pointer
+   link (the matching idea of indirect memory prefetchers [1])
+ - Sampling records bursts: the first burst of every period accesses of a
+   thread, so chains within a burst are still seen whole
+ - ProposeJob() keeps the links that explain at least min_share of the
+   target's recorded accesses (of the source's loads for Pointer links),
+   strongest first and skipping any that would close a cycle. It orders the
+   arrays from the most used root (an array no kept link points to) and
+   builds fresh descriptors with the links as dst_indexing_array_id, the
+   link kinds as addressing modes and the arrays' own access types. A second
+   target of one array gets an alias descriptor (aliasArrayDescriptor),
+   since a descriptor has one target.
+ - Descriptors are recognized by address; one freed and reallocated during
+   the recording shows up as the same array
+ - With trace_records > 0, Start() also keeps every access (not only the
+   sampled ones) up to that many per thread, and the jobs the kernel sends
+   while recording (AddJob); WriteTrace() saves them as an AccessTrace
+   (access_trace.h) for tools/trace_analyzer.cpp to replay offline
+
+[1] Xiangyao Yu, Christopher J. Hughes, Nadathur Satish, and Srinivas
+    Devadas. "IMP: Indirect Memory Prefetcher." MICRO, 2015.
+*/
+
+
+class AccessRecorder {
+ public:
+  static const int kRecentValues = 8;
+  static const uint64_t kMinLinkCount = 32;
+
+  static AccessRecorder& Get() {
+    static AccessRecorder recorder;
+    return recorder;
+  }
+
+  // Records the first burst accesses of every period per thread
+  void Start(uint64_t burst = 4096, uint64_t period = 4096,
+             uint64_t trace_records = 0) {
+    burst_ = std::max<uint64_t>(burst, 1);
+    period_ = std::max(period, burst_);
+    trace_records_ = trace_records;
+    jobs_.clear();
+    logs_.clear();
+    for (int t=0; t < MaxThreads(); t++)
+      logs_.emplace_back(new ThreadLog());
+    recording_ = true;
+  }
+
+  void Stop() { recording_ = false; }
+
+  bool recording() const { return recording_; }
+
+  // A read of element index of array (at address), whose value may index or
+  // point into another array if has_value
+  void Load(const PickleArrayDescriptor *array, uint64_t index,
+            const void *address, bool has_value, uint64_t value) {
+    if (!recording_)
+      return;
+    ThreadLog &log = *logs_[ThreadNum()];
+    const bool sampled = log.ticks++ % period_ < burst_;
+    const bool traced = log.trace.num_records() < trace_records_;
+    if (!sampled && !traced)
+      return;
+    ArrayStats &stats = log.arrays[array];
+    if (!stats.seen)
+      stats.Snapshot(*array);
+    const uint64_t addr = reinterpret_cast<uint64_t>(address);
+    if (traced)
+      log.trace.Append(addr, has_value, value);
+    if (!sampled)
+      return;
+    stats.loads++;
+    for (int i=0; i < kRecentValues; i++) {
+      const Recent &r = log.recent[(log.head + kRecentValues - 1 - i) %
+                                   kRecentValues];
+      if (r.array == nullptr || r.array == array)
+        continue;
+      if (r.value == index) {
+        log.links[LinkKey(r.array, array, AddressingMode::Index)]++;
+        break;
+      }
+      if (r.value == addr) {
+        log.links[LinkKey(r.array, array, AddressingMode::Pointer)]++;
+        break;
+      }
+    }
+    if (has_value) {
+      log.recent[log.head] = Recent{array, value};
+      log.head = (log.head + 1) % kRecentValues;
+    }
+  }
+
+  template <typename T_>
+  void Load(const PickleArrayDescriptor *array, uint64_t index,
+            const T_ *element) {
+    if constexpr (std::is_integral<T_>::value || std::is_pointer<T_>::value)
+      Load(array, index, element, true, (uint64_t)*element);
+    else
+      Load(array, index, element, false, 0);
+  }
+
+  // A job (its descriptor) the kernel sends while recording, kept for the
+  // trace
+  void AddJob(const std::vector<uint8_t> &job_descriptor) {
+    if (!recording_ || trace_records_ == 0)
+      return;
+    #pragma omp critical
+    jobs_.push_back(job_descriptor);
+  }
+
+  // The trace carries the jobs the kernel sent, then the proposed one
+  bool WriteTrace(const std::string &filename,
+                  const PickleJob &proposed) const {
+    AccessTrace trace;
+    std::map<std::pair<uint64_t, uint64_t>, bool> listed;
+    for (const std::unique_ptr<ThreadLog> &log : logs_) {
+      for (const auto &kv : log->arrays) {
+        const ArrayStats &a = kv.second;
+        if (listed[{a.vaddr_start, a.vaddr_end}])
+          continue;
+        listed[{a.vaddr_start, a.vaddr_end}] = true;
+        trace.arrays.push_back(TraceArray{a.vaddr_start, a.vaddr_end,
+                                          a.element_size,
+                                          (uint64_t) a.access_type, a.name});
+      }
+      trace.stream_records.push_back(log->trace.num_records());
+      trace.streams.push_back(log->trace.bytes());
+    }
+    trace.jobs = jobs_;
+    trace.jobs.push_back(proposed.getJobDescriptor());
+    if (!trace.Write(filename))
+      return false;
+    uint64_t records = 0, bytes = 0;
+    for (size_t t=0; t < trace.streams.size(); t++) {
+      records += trace.stream_records[t];
+      bytes += trace.streams[t].size();
+    }
+    std::cout << "Wrote " << records << " accesses (" << bytes << " bytes) and "
+              << trace.jobs.size() << " jobs to " << filename << std::endl;
+    return true;
+  }
+
+  PickleJob ProposeJob(const std::string &kernel_name,
+                       double min_share = 0.2) const {
+    Summary s = Summarize(min_share);
+    PickleJob job(kernel_name);
+    std::map<const PickleArrayDescriptor*,
+             std::shared_ptr<PickleArrayDescriptor>> proposed;
+    for (const PickleArrayDescriptor *a : s.order)
+      proposed[a] = MakeDescriptor(s.arrays.at(a));
+    for (const PickleArrayDescriptor *a : s.order) {
+      job.addArrayDescriptor(proposed[a]);
+      std::shared_ptr<PickleArrayDescriptor> source = proposed[a];
+      bool first_target = true;
+      for (const KeptLink &l : s.kept) {
+        if (l.src != a)
+          continue;
+        if (!first_target) {
+          source = aliasArrayDescriptor(proposed[a]);
+          job.addArrayDescriptor(source);
+        }
+        source->setAddressingMode(l.mode);
+        source->dst_indexing_array_id = proposed[l.dst]->getArrayId();
+        first_target = false;
+      }
+    }
+    return job;
+  }
+
+  void PrintReport(double min_share = 0.2) const {
+    Summary s = Summarize(min_share);
+    std::cout << "Recorded " << s.arrays.size() << " arrays, "
+              << s.links.size() << " candidate links" << std::endl;
+    for (const auto &kv : s.links) {
+      const PickleArrayDescriptor *src, *dst;
+      AddressingMode mode;
+      std::tie(src, dst, mode) = kv.first;
+      const uint64_t dst_loads = s.arrays.at(dst).loads;
+      bool kept = false;
+      for (const KeptLink &l : s.kept)
+        kept |= l.src == src && l.dst == dst && l.mode == mode;
+      std::cout << (kept ? "  kept    " : "  dropped ") << Label(s, src)
+                << " -> " << Label(s, dst)
+                << (mode == AddressingMode::Index ? " (Index) " : " (Pointer) ")
+                << kv.second << " of " << dst_loads << " accesses"
+                << std::endl;
+    }
+  }
+
+ private:
+  typedef std::tuple<const PickleArrayDescriptor*,
+                     const PickleArrayDescriptor*, AddressingMode> LinkKey;
+
+  struct ArrayStats {
+    std::string name;
+    uint64_t vaddr_start = 0;
+    uint64_t vaddr_end = 0;
+    uint64_t element_size = 0;
+    AccessType access_type = AccessType::SingleElement;
+    uint64_t loads = 0;
+    bool seen = false;
+
+    void Snapshot(const PickleArrayDescriptor &d) {
+      seen = true;
+      name = d.name;
+      vaddr_start = d.vaddr_start;
+      vaddr_end = d.vaddr_end;
+      element_size = d.element_size;
+      access_type = d.access_type;
+    }
+  };
+
+  struct Recent {
+    const PickleArrayDescriptor *array;
+    uint64_t value;
+  };
+
+  struct alignas(64) ThreadLog {
+    Recent recent[kRecentValues] = {};
+    int head = 0;
+    uint64_t ticks = 0;
+    std::unordered_map<const PickleArrayDescriptor*, ArrayStats> arrays;
+    std::map<LinkKey, uint64_t> links;
+    TraceStreamWriter trace;
+  };
+
+  struct KeptLink {
+    const PickleArrayDescriptor *src;
+    const PickleArrayDescriptor *dst;
+    AddressingMode mode;
+  };
+
+  struct Summary {
+    std::map<const PickleArrayDescriptor*, ArrayStats> arrays;
+    std::map<LinkKey, uint64_t> links;
+    std::vector<KeptLink> kept;
+    std::vector<const PickleArrayDescriptor*> order;
+  };
+
+  bool recording_ = false;
+  uint64_t burst_ = 1;
+  uint64_t period_ = 1;
+  uint64_t trace_records_ = 0;
+  std::vector<std::unique_ptr<ThreadLog>> logs_;
+  std::vector<std::vector<uint8_t>> jobs_;
+
+  Summary Summarize(double min_share) const {
+    Summary s;
+    for (const std::unique_ptr<ThreadLog> &log : logs_) {
+      for (const auto &kv : log->arrays) {
+        ArrayStats &merged = s.arrays[kv.first];
+        uint64_t loads = merged.loads;
+        merged = kv.second;
+        merged.loads += loads;
+      }
+      for (const auto &kv : log->links)
+        s.links[kv.first] += kv.second;
+    }
+    // Candidates: each must be seen kMinLinkCount times and explain
+    // min_share of the accesses to dst, or for a Pointer link of the loads
+    // from src since it matches the first element of each list only
+    std::vector<std::pair<uint64_t, KeptLink>> candidates;
+    for (const auto &kv : s.links) {
+      const PickleArrayDescriptor *src = std::get<0>(kv.first);
+      const PickleArrayDescriptor *dst = std::get<1>(kv.first);
+      const AddressingMode mode = std::get<2>(kv.first);
+      if (kv.second < kMinLinkCount)
+        continue;
+      if (kv.second < min_share * s.arrays[dst].loads &&
+          (mode != AddressingMode::Pointer ||
+           kv.second < min_share * s.arrays[src].loads))
+        continue;
+      candidates.push_back({kv.second, KeptLink{src, dst, mode}});
+    }
+    // Strongest first, one link per (src, dst) and none that closes a cycle
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [] (const std::pair<uint64_t, KeptLink> &a,
+                         const std::pair<uint64_t, KeptLink> &b) {
+                       return a.first > b.first;
+                     });
+    for (const auto &c : candidates) {
+      const KeptLink &l = c.second;
+      bool duplicate = false;
+      for (const KeptLink &k : s.kept)
+        duplicate |= k.src == l.src && k.dst == l.dst;
+      if (!duplicate && !Reaches(s.kept, l.dst, l.src))
+        s.kept.push_back(l);
+    }
+    // Arrays reachable from roots, most used root first, breadth first
+    std::map<const PickleArrayDescriptor*, bool> linked, targeted;
+    for (const KeptLink &l : s.kept) {
+      linked[l.src] = linked[l.dst] = true;
+      targeted[l.dst] = true;
+    }
+    std::vector<const PickleArrayDescriptor*> roots;
+    for (const auto &kv : linked) {
+      if (!targeted.count(kv.first))
+        roots.push_back(kv.first);
+    }
+    std::sort(roots.begin(), roots.end(),
+              [&s] (const PickleArrayDescriptor *a,
+                    const PickleArrayDescriptor *b) {
+                return s.arrays[a].loads > s.arrays[b].loads;
+              });
+    std::map<const PickleArrayDescriptor*, bool> placed;
+    for (const PickleArrayDescriptor *root : roots) {
+      size_t next = s.order.size();
+      s.order.push_back(root);
+      placed[root] = true;
+      while (next < s.order.size()) {
+        const PickleArrayDescriptor *a = s.order[next++];
+        for (const KeptLink &l : s.kept) {
+          if (l.src == a && !placed[l.dst]) {
+            s.order.push_back(l.dst);
+            placed[l.dst] = true;
+          }
+        }
+      }
+    }
+    // links only among arrays on a cycle with no root
+    for (const auto &kv : linked) {
+      if (!placed[kv.first])
+        s.order.push_back(kv.first);
+    }
+    return s;
+  }
+
+  static bool Reaches(const std::vector<KeptLink> &links,
+                      const PickleArrayDescriptor *from,
+                      const PickleArrayDescriptor *to) {
+    std::vector<const PickleArrayDescriptor*> stack = {from};
+    std::map<const PickleArrayDescriptor*, bool> seen;
+    while (!stack.empty()) {
+      const PickleArrayDescriptor *a = stack.back();
+      stack.pop_back();
+      if (a == to)
+        return true;
+      if (seen[a])
+        continue;
+      seen[a] = true;
+      for (const KeptLink &l : links) {
+        if (l.src == a)
+          stack.push_back(l.dst);
+      }
+    }
+    return false;
+  }
+
+  static std::shared_ptr<PickleArrayDescriptor> MakeDescriptor(
+      const ArrayStats &stats) {
+    std::shared_ptr<PickleArrayDescriptor> d(new PickleArrayDescriptor());
+    d->setName(stats.name);
+    d->vaddr_start = stats.vaddr_start;
+    d->vaddr_end = stats.vaddr_end;
+    d->element_size = stats.element_size;
+    d->setAccessType(stats.access_type);
+    return d;
+  }
+
+  static std::string Label(const Summary &s, const PickleArrayDescriptor *a) {
+    const ArrayStats &stats = s.arrays.at(a);
+    std::string label = stats.name == "unknown" ? "array" : stats.name;
+    return label + "[" +
+           std::to_string((stats.vaddr_end - stats.vaddr_start) /
+                          std::max<uint64_t>(stats.element_size, 1)) +
+           " x " + std::to_string(stats.element_size) + "B]";
+  }
+
+  static int ThreadNum() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+  static int MaxThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+};
+
+
+// Pointer into an array that reports each element it reads; converts back
+// to T_* so code taking plain pointers keeps working
+template <typename T_>
+class TracedIterator {
+ public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef typename std::remove_cv<T_>::type value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef T_* pointer;
+  typedef T_& reference;
+
+  TracedIterator() : ptr_(nullptr), base_(nullptr), array_(nullptr) {}
+  TracedIterator(T_ *ptr, const T_ *base, const PickleArrayDescriptor *array) :
+      ptr_(ptr), base_(base), array_(array) {}
+
+  operator T_*() const { return ptr_; }
+
+  T_& operator*() const {
+    AccessRecorder::Get().Load(array_, ptr_ - base_, ptr_);
+    return *ptr_;
+  }
+  T_* operator->() const { return &**this; }
+  T_& operator[](difference_type n) const { return *(*this + n); }
+
+  TracedIterator& operator++() { ++ptr_; return *this; }
+  TracedIterator& operator--() { --ptr_; return *this; }
+  TracedIterator operator++(int) { TracedIterator old = *this; ++ptr_; return old; }
+  TracedIterator operator--(int) { TracedIterator old = *this; --ptr_; return old; }
+  TracedIterator& operator+=(difference_type n) { ptr_ += n; return *this; }
+  TracedIterator& operator-=(difference_type n) { ptr_ -= n; return *this; }
+  TracedIterator operator+(difference_type n) const {
+    return TracedIterator(ptr_ + n, base_, array_);
+  }
+  TracedIterator operator-(difference_type n) const {
+    return TracedIterator(ptr_ - n, base_, array_);
+  }
+  friend TracedIterator operator+(difference_type n, const TracedIterator &it) {
+    return it + n;
+  }
+  difference_type operator-(const TracedIterator &rhs) const {
+    return ptr_ - rhs.ptr_;
+  }
+
+  bool operator==(const TracedIterator &rhs) const { return ptr_ == rhs.ptr_; }
+  bool operator!=(const TracedIterator &rhs) const { return ptr_ != rhs.ptr_; }
+  bool operator<(const TracedIterator &rhs) const { return ptr_ < rhs.ptr_; }
+  bool operator>(const TracedIterator &rhs) const { return ptr_ > rhs.ptr_; }
+  bool operator<=(const TracedIterator &rhs) const { return ptr_ <= rhs.ptr_; }
+  bool operator>=(const TracedIterator &rhs) const { return ptr_ >= rhs.ptr_; }
+
+ private:
+  T_ *ptr_;
+  const T_ *base_;
+  const PickleArrayDescriptor *array_;
+};
+
+#endif  // ACCESS_RECORDER_H_
@@ -0,0 +1,225 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef ACCESS_TRACE_H_
+#define ACCESS_TRACE_H_
+
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/*
+GAP Benchmark Suite
+Class:  AccessTrace, TraceStreamWriter, TraceStreamReader
+
+On-disk memory-access trace written by AccessRecorder (access_recorder.h)
+and replayed by tools/trace_analyzer.cpp
+ - Header: the arrays seen (address range, element size, access type, name)
+   and the job descriptors the kernel sent (PickleJob::getJobDescriptor)
+ - One stream per thread; each record is the address read and, for
+   elements that can index another array, the value read. Addresses and
+   values are stored as zigzag varint deltas to the thread's previous ones,
+   so sequential scans take one or two bytes per record
+ - Little-endian only, like the job descriptor itself
+*/
+
+
+struct TraceArray {
+  uint64_t vaddr_start;
+  uint64_t vaddr_end;
+  uint64_t element_size;
+  uint64_t access_type;
+  std::string name;
+};
+
+
+class TraceStreamWriter {
+ public:
+  TraceStreamWriter() : num_records_(0), prev_addr_(0), prev_value_(0) {}
+
+  void Append(uint64_t addr, bool has_value, uint64_t value) {
+    PutVarint((ZigZag(addr - prev_addr_) << 1) | (has_value ? 1 : 0));
+    prev_addr_ = addr;
+    if (has_value) {
+      PutVarint(ZigZag(value - prev_value_));
+      prev_value_ = value;
+    }
+    num_records_++;
+  }
+
+  uint64_t num_records() const { return num_records_; }
+  const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+ private:
+  std::vector<uint8_t> bytes_;
+  uint64_t num_records_;
+  uint64_t prev_addr_;
+  uint64_t prev_value_;
+
+  static uint64_t ZigZag(uint64_t delta) {
+    int64_t d = static_cast<int64_t>(delta);
+    return (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+  }
+
+  void PutVarint(uint64_t x) {
+    while (x >= 0x80) {
+      bytes_.push_back(static_cast<uint8_t>(x) | 0x80);
+      x >>= 7;
+    }
+    bytes_.push_back(static_cast<uint8_t>(x));
+  }
+};
+
+
+class TraceStreamReader {
+ public:
+  TraceStreamReader(const uint8_t *begin, const uint8_t *end) :
+      pos_(begin), end_(end), prev_addr_(0), prev_value_(0) {}
+
+  // False at the end of the stream (or on a truncated record)
+  bool Next(uint64_t *addr, bool *has_value, uint64_t *value) {
+    uint64_t head;
+    if (!GetVarint(&head))
+      return false;
+    prev_addr_ += UnZigZag(head >> 1);
+    *addr = prev_addr_;
+    *has_value = head & 1;
+    if (*has_value) {
+      uint64_t delta;
+      if (!GetVarint(&delta))
+        return false;
+      prev_value_ += UnZigZag(delta);
+      *value = prev_value_;
+    }
+    return true;
+  }
+
+ private:
+  const uint8_t *pos_;
+  const uint8_t *end_;
+  uint64_t prev_addr_;
+  uint64_t prev_value_;
+
+  static uint64_t UnZigZag(uint64_t x) {
+    return (x >> 1) ^ (~(x & 1) + 1);
+  }
+
+  bool GetVarint(uint64_t *x) {
+    *x = 0;
+    for (int shift = 0; pos_ < end_ && shift < 64; shift += 7) {
+      uint8_t b = *pos_++;
+      *x |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0)
+        return true;
+    }
+    return false;
+  }
+};
+
+
+struct AccessTrace {
+  std::vector<TraceArray> arrays;
+  std::vector<std::vector<uint8_t>> jobs;
+  std::vector<uint64_t> stream_records;
+  std::vector<std::vector<uint8_t>> streams;
+
+  static constexpr const char* kMagic = "PKTRACE1";
+
+  bool Write(const std::string &filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+      std::cout << "Couldn't write trace to " << filename << std::endl;
+      return false;
+    }
+    out.write(kMagic, 8);
+    PutU64(out, arrays.size());
+    for (const TraceArray &a : arrays) {
+      PutU64(out, a.vaddr_start);
+      PutU64(out, a.vaddr_end);
+      PutU64(out, a.element_size);
+      PutU64(out, a.access_type);
+      PutBytes(out, a.name.data(), a.name.size());
+    }
+    PutU64(out, jobs.size());
+    for (const std::vector<uint8_t> &job : jobs)
+      PutBytes(out, job.data(), job.size());
+    PutU64(out, streams.size());
+    for (size_t t=0; t < streams.size(); t++) {
+      PutU64(out, stream_records[t]);
+      PutBytes(out, streams[t].data(), streams[t].size());
+    }
+    return out.good();
+  }
+
+  bool Read(const std::string &filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char magic[8];
+    if (!in.read(magic, 8) || std::memcmp(magic, kMagic, 8) != 0) {
+      std::cout << filename << " is not an access trace" << std::endl;
+      return false;
+    }
+    uint64_t n;
+    if (!GetU64(in, &n))
+      return Truncated(filename);
+    arrays.resize(n);
+    for (TraceArray &a : arrays) {
+      std::vector<uint8_t> name;
+      if (!GetU64(in, &a.vaddr_start) || !GetU64(in, &a.vaddr_end) ||
+          !GetU64(in, &a.element_size) || !GetU64(in, &a.access_type) ||
+          !GetBytes(in, &name))
+        return Truncated(filename);
+      a.name.assign(name.begin(), name.end());
+    }
+    if (!GetU64(in, &n))
+      return Truncated(filename);
+    jobs.resize(n);
+    for (std::vector<uint8_t> &job : jobs) {
+      if (!GetBytes(in, &job))
+        return Truncated(filename);
+    }
+    if (!GetU64(in, &n))
+      return Truncated(filename);
+    stream_records.resize(n);
+    streams.resize(n);
+    for (size_t t=0; t < n; t++) {
+      if (!GetU64(in, &stream_records[t]) || !GetBytes(in, &streams[t]))
+        return Truncated(filename);
+    }
+    return true;
+  }
+
+ private:
+  static void PutU64(std::ofstream &out, uint64_t x) {
+    out.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  }
+
+  static void PutBytes(std::ofstream &out, const void *data, uint64_t size) {
+    PutU64(out, size);
+    out.write(static_cast<const char*>(data), size);
+  }
+
+  static bool GetU64(std::ifstream &in, uint64_t *x) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(x), sizeof(*x)));
+  }
+
+  static bool GetBytes(std::ifstream &in, std::vector<uint8_t> *bytes) {
+    uint64_t size;
+    if (!GetU64(in, &size))
+      return false;
+    bytes->resize(size);
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char*>(bytes->data()), size));
+  }
+
+  static bool Truncated(const std::string &filename) {
+    std::cout << "Access trace " << filename << " is truncated" << std::endl;
+    return false;
+  }
+};
+
+#endif  // ACCESS_TRACE_H_
@@ -6,8 +6,11 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <cstdlib>
 #include <functional>
+#include <memory>
 #include <random>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include <stdio.h>
@@ -19,8 +22,12 @@
 #else
 #include "graph.h"
 #endif // ENABLE_PICKLE
+#include "benchmark_report.h"
+#include "reorder.h"
+#include "streaming_graph.h"
 #include "timer.h"
 #include "util.h"
+#include "weighted_graph.h"
 #include "writer.h"
 
 
@@ -40,6 +47,8 @@ typedef NodeWeight<NodeID, WeightT> WNode;
 
 typedef CSRGraph<NodeID> Graph;
 typedef CSRGraph<NodeID, WNode> WGraph;
+typedef WeightedCSRGraph<NodeID, WeightT> SWGraph;
+typedef StreamingGraph<NodeID> StreamGraph;
 
 typedef BuilderBase<NodeID, NodeID, WeightT> Builder;
 typedef BuilderBase<NodeID, WNode, WeightT> WeightedBuilder;
@@ -49,21 +58,39 @@ typedef WriterBase<NodeID, WNode> WeightedWriter;
 
 
 // Used to pick random non-zero degree starting points for search algorithms
+// Given the mapping of a reordering (Reordering::mapping()), picks are made
+// among the IDs of g and handed out relabeled, so a picker feeding the kernel
+// and one feeding its verifier agree on the sources.
 template<typename GraphT_>
 class SourcePicker {
  public:
-  explicit SourcePicker(const GraphT_ &g, NodeID given_source = -1)
+  explicit SourcePicker(const GraphT_ &g, NodeID given_source = -1,
+                        const VertexMapping<NodeID> *to_new = nullptr)
       : given_source(given_source), rng(kRandSeed), udist(0, g.num_nodes()-1),
-        g_(g) {}
+        g_(g), to_new_(to_new) {}
 
   NodeID PickNext() {
-    if (given_source != -1)
-      return given_source;
-    NodeID source;
-    do {
-      source = udist(rng);
-    } while (g_.out_degree(source) == 0);
-    return source;
+    NodeID source = given_source;
+    if (source == -1) {
+      do {
+        source = udist(rng);
+      } while (g_.out_degree(source) == 0);
+    }
+    return to_new_ != nullptr ? to_new_->ToNew(source) : source;
+  }
+
+  // Next num_sources picks, e.g. one batch for a multi-source search
+  std::vector<NodeID> PickBatch(size_t num_sources) {
+    std::vector<NodeID> sources(num_sources);
+    for (NodeID &source : sources)
+      source = PickNext();
+    return sources;
+  }
+
+  // Advances past n picks, e.g. the sources consumed by warm-up trials
+  void Skip(int64_t n) {
+    for (int64_t i=0; i < n; i++)
+      PickNext();
   }
 
  private:
@@ -71,27 +98,178 @@ class SourcePicker {
   std::mt19937 rng;
   std::uniform_int_distribution<NodeID> udist;
   const GraphT_ &g_;
+  const VertexMapping<NodeID> *to_new_;
+};
+
+
+// Bounded min-heap that keeps the k largest (value, key) pairs pushed into it
+// - Push is O(log k) and only touches the heap once a pair beats the current
+//   k-th largest, so streaming n pairs is O(n log k) at worst
+// - Heaps filled by different threads are combined with Merge
+template<typename KeyT, typename ValT>
+class TopKHeap {
+ public:
+  typedef std::pair<ValT, KeyT> Entry;
+
+  explicit TopKHeap(size_t k) : k_(k) {
+    heap_.reserve(k);
+  }
+
+  void Push(KeyT key, ValT val) {
+    Entry entry(val, key);
+    if (heap_.size() < k_) {
+      heap_.push_back(entry);
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    } else if (k_ != 0 && entry > heap_.front()) {
+      std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+      heap_.back() = entry;
+      std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    }
+  }
+
+  void Merge(const TopKHeap &other) {
+    for (const Entry &entry : other.heap_)
+      Push(entry.second, entry.first);
+  }
+
+  // Largest first
+  std::vector<Entry> Sorted() const {
+    std::vector<Entry> sorted(heap_);
+    std::sort(sorted.begin(), sorted.end(), std::greater<Entry>());
+    return sorted;
+  }
+
+ private:
+  size_t k_;
+  std::vector<Entry> heap_;
 };
 
 
+// Streams pair_at(0..n-1) through one TopKHeap per thread and merges them
+template<typename KeyT, typename ValT, typename PairFunc>
+std::vector<std::pair<ValT, KeyT>> ParallelTopK(int64_t n, size_t k,
+                                                PairFunc pair_at) {
+  TopKHeap<KeyT, ValT> top_k(k);
+  #pragma omp parallel
+  {
+    TopKHeap<KeyT, ValT> local_top_k(k);
+    #pragma omp for schedule(static) nowait
+    for (int64_t i=0; i < n; i++) {
+      std::pair<KeyT, ValT> kvp = pair_at(i);
+      local_top_k.Push(kvp.first, kvp.second);
+    }
+    #pragma omp critical
+    top_k.Merge(local_top_k);
+  }
+  return top_k.Sorted();
+}
+
+
 // Returns k pairs with largest values from list of key-value pairs
 template<typename KeyT, typename ValT>
 std::vector<std::pair<ValT, KeyT>> TopK(
     const std::vector<std::pair<KeyT, ValT>> &to_sort, size_t k) {
-  std::vector<std::pair<ValT, KeyT>> top_k;
-  ValT min_so_far = 0;
-  for (auto kvp : to_sort) {
-    if ((top_k.size() < k) || (kvp.second > min_so_far)) {
-      top_k.push_back(std::make_pair(kvp.second, kvp.first));
-      std::sort(top_k.begin(), top_k.end(),
-                std::greater<std::pair<ValT, KeyT>>());
-      if (top_k.size() > k)
-        top_k.resize(k);
-      min_so_far = top_k.back().first;
+  return ParallelTopK<KeyT, ValT>(to_sort.size(), k,
+                                  [&to_sort](int64_t i) { return to_sort[i]; });
+}
+
+
+// Returns k (score, index) pairs with largest scores, reading the scores in
+// place instead of materializing (index, score) pairs first
+template<typename ValT>
+std::vector<std::pair<ValT, NodeID>> TopK(const pvector<ValT> &scores,
+                                          size_t k) {
+  return ParallelTopK<NodeID, ValT>(scores.size(), k, [&scores](int64_t i) {
+    return std::make_pair(static_cast<NodeID>(i), scores[i]);
+  });
+}
+
+
+// Vertex relabeling requested on the command line (-o). The kernel runs on
+// graph(), g relabeled by the method (g itself without -o), and takes its
+// sources through ToNew() or a SourcePicker given mapping(). BenchmarkKernel
+// translates every result back to the IDs of g with ToOriginal() before it
+// is printed or verified against g. The layout tells what to translate:
+// per-vertex values are put back in original order (kPerVertex) and, when
+// they are vertex IDs themselves (BFS parents, component labels), mapped
+// back too (kPerVertexIDs); other results (counts, per-source stats) are
+// kept as they are (kUnchanged). g must outlive the Reordering.
+template<typename GraphT_>
+class Reordering {
+ public:
+  enum ResultLayout { kUnchanged, kPerVertex, kPerVertexIDs };
+
+  // No relabeling, e.g. for graphs that cannot be reordered
+  explicit Reordering(const GraphT_ &g) : g_(g), layout_(kUnchanged) {}
+
+  Reordering(const CLApp &cli, const GraphT_ &g, ResultLayout layout) :
+      Reordering(cli, g, g, layout) {}
+
+  // source is the graph g was converted from (e.g. the AoS graph of a
+  // WeightedCSRGraph); it is relabeled and converted the same way
+  template<typename SourceGraphT>
+  Reordering(const CLApp &cli, const GraphT_ &g, const SourceGraphT &source,
+             ResultLayout layout) : g_(g), layout_(layout) {
+    if (cli.reorder_method() == ReorderMethod::kNone)
+      return;
+    Timer t;
+    t.Start();
+    relabeled_.reset(new GraphT_(
+        ReorderGraph(source, cli.reorder_method(), &mapping_)));
+    t.Stop();
+    PrintLabel("Reorder Method", ReorderMethodName(cli.reorder_method()));
+    PrintTime("Reorder Time", t.Seconds());
+  }
+
+  bool enabled() const { return relabeled_ != nullptr; }
+  const GraphT_& original() const { return g_; }
+  const GraphT_& graph() const { return enabled() ? *relabeled_ : g_; }
+
+  // nullptr without relabeling
+  const VertexMapping<NodeID>* mapping() const {
+    return enabled() ? &mapping_ : nullptr;
+  }
+
+  NodeID ToNew(NodeID v) const {
+    return enabled() ? mapping_.ToNew(v) : v;
+  }
+
+  std::vector<NodeID> ToNew(const std::vector<NodeID> &vertices) const {
+    std::vector<NodeID> relabeled(vertices.size());
+    for (size_t i=0; i < vertices.size(); i++)
+      relabeled[i] = ToNew(vertices[i]);
+    return relabeled;
+  }
+
+  template<typename ResultT>
+  ResultT ToOriginal(ResultT result) const {
+    return result;
+  }
+
+  template<typename T_>
+  pvector<T_> ToOriginal(pvector<T_> by_new_id) const {
+    if (!enabled() || layout_ == kUnchanged)
+      return by_new_id;
+    pvector<T_> by_old_id = mapping_.ToOriginal(by_new_id);
+    if constexpr (std::is_same<T_, NodeID>::value) {
+      if (layout_ == kPerVertexIDs) {
+        // negative values (e.g. unreached) are not IDs
+        #pragma omp parallel for
+        for (NodeID n=0; n < (NodeID) by_old_id.size(); n++) {
+          if (by_old_id[n] >= 0)
+            by_old_id[n] = mapping_.ToOld(by_old_id[n]);
+        }
+      }
     }
+    return by_old_id;
   }
-  return top_k;
-}
+
+ private:
+  const GraphT_ &g_;
+  ResultLayout layout_;
+  std::unique_ptr<GraphT_> relabeled_;
+  VertexMapping<NodeID> mapping_;
+};
 
 
 bool VerifyUnimplemented(...) {
@@ -100,33 +278,99 @@ bool VerifyUnimplemented(...) {
 }
 
 
-// Calls (and times) kernel according to command line arguments
+#if PICKLE_TRACE_ACCESSES==1
+// Accesses per thread to keep for PICKLE_TRACE_FILE, 0 if it is not set
+inline uint64_t TraceRecordsFromEnv() {
+  if (getenv("PICKLE_TRACE_FILE") == nullptr)
+    return 0;
+  const char *records = getenv("PICKLE_TRACE_RECORDS");
+  return records != nullptr ? strtoull(records, nullptr, 10) : 1ULL << 24;
+}
+#endif
+
+
+// Calls (and times) kernel according to command line arguments. Warm-up
+// trials (-w) run first and are neither verified nor part of the stats.
+// Returns false if verification failed or the median regressed past the
+// baseline (-b), so kernels can turn it into their exit status.
+// Built with PICKLE_TRACE_ACCESSES=1, the first trial runs under the
+// AccessRecorder, which then prints the links it found and the PickleJob it
+// proposes for the kernel (its time includes the recording overhead). With
+// PICKLE_TRACE_FILE set, it also saves the trial's accesses and jobs there
+// for tools/trace_analyzer.cpp (up to PICKLE_TRACE_RECORDS per thread).
+// With a Reordering, the kernel runs on its graph() and stats and verify
+// see the results translated back to the original graph (not timed).
 template<typename GraphT_, typename GraphFunc, typename AnalysisFunc,
          typename VerifierFunc>
-void BenchmarkKernel(const CLApp &cli, const GraphT_ &g,
+bool BenchmarkKernel(const CLApp &cli, const Reordering<GraphT_> &reordering,
                      GraphFunc kernel, AnalysisFunc stats,
-                     VerifierFunc verify) {
+                     VerifierFunc verify,
+                     const BenchmarkDeviceInfo &device = {}) {
+  const GraphT_ &g = reordering.original();
+  const GraphT_ &run_g = reordering.graph();
   g.PrintStats();
-  double total_seconds = 0;
+  BenchmarkReport report(cli, device);
+  report.SetGraph(g);
+  bool all_ok = true;
   Timer trial_timer;
+  for (int iter=0; iter < cli.num_warmups(); iter++) {
+    trial_timer.Start();
+    kernel(run_g);
+    trial_timer.Stop();
+    printf("Warm-up %2d Time", iter+1);
+    PrintTime("", trial_timer.Seconds());
+    report.AddWarmup(trial_timer.Seconds());
+  }
   for (int iter=0; iter < cli.num_trials(); iter++) {
+#if PICKLE_TRACE_ACCESSES==1
+    const char *trace_file = getenv("PICKLE_TRACE_FILE");
+    if (iter == 0)
+      AccessRecorder::Get().Start(4096, 4096, TraceRecordsFromEnv());
+#endif
     trial_timer.Start();
-    auto result = kernel(g);
+    auto run_result = kernel(run_g);
     trial_timer.Stop();
+    auto result = reordering.ToOriginal(std::move(run_result));
+#if PICKLE_TRACE_ACCESSES==1
+    if (iter == 0) {
+      AccessRecorder::Get().Stop();
+      AccessRecorder::Get().PrintReport();
+      PickleJob proposed = AccessRecorder::Get().ProposeJob(cli.name());
+      proposed.print();
+      if (trace_file != nullptr)
+        AccessRecorder::Get().WriteTrace(trace_file, proposed);
+    }
+#endif
     printf("Trial %2d Time", iter+1);
     PrintTime("", trial_timer.Seconds());
-    total_seconds += trial_timer.Seconds();
+    report.AddTrial(trial_timer.Seconds());
     if (cli.do_analysis() && (iter == (cli.num_trials()-1)))
       stats(g, result);
     if (cli.do_verify()) {
       trial_timer.Start();
-      PrintLabel("Verification",
-                 verify(std::ref(g), std::ref(result)) ? "PASS" : "FAIL");
+      bool verified = verify(std::ref(g), std::ref(result));
+      PrintLabel("Verification", verified ? "PASS" : "FAIL");
       trial_timer.Stop();
       PrintTime("Verification Time", trial_timer.Seconds());
+      report.SetVerified(verified);
+      all_ok &= verified;
     }
   }
-  PrintTime("Average Time", total_seconds / cli.num_trials());
+  report.PrintSummary();
+  all_ok &= report.CompareToBaseline();
+  report.Write();
+  return all_ok;
+}
+
+template<typename GraphT_, typename GraphFunc, typename AnalysisFunc,
+         typename VerifierFunc>
+bool BenchmarkKernel(const CLApp &cli, const GraphT_ &g,
+                     GraphFunc kernel, AnalysisFunc stats,
+                     VerifierFunc verify,
+                     const BenchmarkDeviceInfo &device = {}) {
+  return BenchmarkKernel(cli, Reordering<GraphT_>(g), kernel, stats, verify,
+                         device);
 }
 
+
 #endif  // BENCHMARK_H_
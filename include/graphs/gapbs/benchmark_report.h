@@ -0,0 +1,286 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef BENCHMARK_REPORT_H_
+#define BENCHMARK_REPORT_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "command_line.h"
+#include "reorder.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  TrialStats, BenchmarkReport
+
+Summarizes the trial times of BenchmarkKernel and writes them out
+ - TrialStats computes min/median/p95/mean/stddev over the measured trials
+   (warm-up trials are never part of it)
+ - BenchmarkReport records the run (graph, reordering, threads, device specs,
+   every trial time, verification) and writes it as JSON (-j) or as one CSV
+   row (-c), emitting the CSV header only when the file is new so repeated
+   runs accumulate in one file
+ - A JSON report from an earlier run can be given as a baseline (-b); the
+   median of this run is compared against the baseline median and anything
+   slower by more than the threshold (-x, in percent) is a regression
+*/
+
+
+class TrialStats {
+ public:
+  explicit TrialStats(std::vector<double> samples)
+      : sorted_(std::move(samples)) {
+    std::sort(sorted_.begin(), sorted_.end());
+  }
+
+  size_t count() const { return sorted_.size(); }
+  double min() const { return sorted_.empty() ? 0 : sorted_.front(); }
+  double max() const { return sorted_.empty() ? 0 : sorted_.back(); }
+  double median() const { return Percentile(50); }
+  double p95() const { return Percentile(95); }
+
+  double mean() const {
+    if (sorted_.empty())
+      return 0;
+    double total = 0;
+    for (double s : sorted_)
+      total += s;
+    return total / sorted_.size();
+  }
+
+  // Sample standard deviation (n-1), zero for fewer than two trials
+  double stddev() const {
+    if (sorted_.size() < 2)
+      return 0;
+    double avg = mean();
+    double sum_sq = 0;
+    for (double s : sorted_)
+      sum_sq += (s - avg) * (s - avg);
+    return std::sqrt(sum_sq / (sorted_.size() - 1));
+  }
+
+  // Linear interpolation between closest ranks
+  double Percentile(double p) const {
+    if (sorted_.empty())
+      return 0;
+    double rank = p / 100 * (sorted_.size() - 1);
+    size_t lo = static_cast<size_t>(rank);
+    size_t hi = std::min(lo + 1, sorted_.size() - 1);
+    return sorted_[lo] + (rank - lo) * (sorted_[hi] - sorted_[lo]);
+  }
+
+ private:
+  std::vector<double> sorted_;
+};
+
+
+// Device description carried into the report; kernels built with
+// ENABLE_PICKLE=1 fill it from PickleDeviceManager::getDevicePrefetcherSpecs
+struct BenchmarkDeviceInfo {
+  bool enabled = false;
+  uint64_t availability = 0;
+  uint64_t prefetch_distance = 0;
+  uint64_t prefetch_mode = 0;
+  uint64_t bulk_mode_chunk_size = 0;
+};
+
+
+class BenchmarkReport {
+ public:
+  BenchmarkReport(const CLApp &cli, const BenchmarkDeviceInfo &device)
+      : cli_(cli), device_(device) {}
+
+  template <typename GraphT_>
+  void SetGraph(const GraphT_ &g) {
+    num_nodes_ = g.num_nodes();
+    num_edges_ = g.num_edges();
+    directed_ = g.directed();
+  }
+
+  void AddWarmup(double seconds) { warmups_.push_back(seconds); }
+  void AddTrial(double seconds) { trials_.push_back(seconds); }
+
+  void SetVerified(bool passed) {
+    verification_ = (passed && verification_ != "FAIL") ? "PASS" : "FAIL";
+  }
+
+  TrialStats Stats() const { return TrialStats(trials_); }
+
+  void PrintSummary() const {
+    TrialStats stats = Stats();
+    PrintTime("Average Time", stats.mean());
+    PrintTime("Min Time", stats.min());
+    PrintTime("Median Time", stats.median());
+    PrintTime("P95 Time", stats.p95());
+    PrintTime("Std Dev", stats.stddev());
+  }
+
+  // Returns false if the median regressed past the threshold
+  bool CompareToBaseline() {
+    if (cli_.baseline_filename() == "")
+      return true;
+    if (!ReadJSONNumber(cli_.baseline_filename(), "median",
+                        &baseline_median_)) {
+      std::cout << "Couldn't read median from baseline "
+                << cli_.baseline_filename() << std::endl;
+      std::exit(-6);
+    }
+    double change = 100 * (Stats().median() - baseline_median_) /
+                    baseline_median_;
+    regressed_ = change > cli_.regression_threshold();
+    PrintTime("Baseline Median", baseline_median_);
+    printf("%-21s%+3.2lf%%\n", "Median Change:", change);
+    PrintLabel("Regression", regressed_ ? "YES" : "NO");
+    return !regressed_;
+  }
+
+  void Write() const {
+    if (cli_.json_filename() != "")
+      WriteJSON(cli_.json_filename());
+    if (cli_.csv_filename() != "")
+      WriteCSV(cli_.csv_filename());
+  }
+
+  void WriteJSON(const std::string &filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-5);
+    }
+    TrialStats stats = Stats();
+    out.precision(9);
+    out << "{\n";
+    out << "  \"kernel\": \"" << cli_.name() << "\",\n";
+    out << "  \"graph\": {\"input\": \"" << GraphInput() << "\", "
+        << "\"nodes\": " << num_nodes_ << ", \"edges\": " << num_edges_
+        << ", \"directed\": " << (directed_ ? "true" : "false")
+        << ", \"degree\": " << AverageDegree() << "},\n";
+    out << "  \"reorder\": \"" << ReorderMethodName(cli_.reorder_method())
+        << "\",\n";
+    out << "  \"threads\": " << NumThreads() << ",\n";
+    out << "  \"pickle\": {\"enabled\": "
+        << (device_.enabled ? "true" : "false")
+        << ", \"availability\": " << device_.availability
+        << ", \"prefetch_distance\": " << device_.prefetch_distance
+        << ", \"prefetch_mode\": " << device_.prefetch_mode
+        << ", \"bulk_mode_chunk_size\": " << device_.bulk_mode_chunk_size
+        << "},\n";
+    out << "  \"warmup_trials\": " << warmups_.size() << ",\n";
+    out << "  \"trials\": [";
+    for (size_t i=0; i < trials_.size(); i++)
+      out << (i == 0 ? "" : ", ") << trials_[i];
+    out << "],\n";
+    out << "  \"time\": {\"min\": " << stats.min()
+        << ", \"median\": " << stats.median()
+        << ", \"p95\": " << stats.p95()
+        << ", \"mean\": " << stats.mean()
+        << ", \"stddev\": " << stats.stddev()
+        << ", \"max\": " << stats.max() << "},\n";
+    if (cli_.baseline_filename() != "") {
+      out << "  \"baseline\": {\"file\": \"" << cli_.baseline_filename()
+          << "\", \"median\": " << baseline_median_
+          << ", \"threshold\": " << cli_.regression_threshold()
+          << ", \"regression\": " << (regressed_ ? "true" : "false")
+          << "},\n";
+    }
+    out << "  \"verification\": \"" << verification_ << "\"\n";
+    out << "}\n";
+  }
+
+  void WriteCSV(const std::string &filename) const {
+    bool is_new = !std::ifstream(filename).good();
+    std::ofstream out(filename, std::ios::app);
+    if (!out.is_open()) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-5);
+    }
+    TrialStats stats = Stats();
+    if (is_new) {
+      out << "kernel,input,nodes,edges,directed,degree,reorder,threads,"
+          << "pickle,availability,prefetch_distance,prefetch_mode,"
+          << "bulk_mode_chunk_size,warmup_trials,trials,min,median,p95,mean,"
+          << "stddev,max,verification\n";
+    }
+    out.precision(9);
+    out << "\"" << cli_.name() << "\"," << GraphInput() << ","
+        << num_nodes_ << "," << num_edges_ << "," << directed_ << ","
+        << AverageDegree() << "," << ReorderMethodName(cli_.reorder_method())
+        << "," << NumThreads() << "," << device_.enabled << ","
+        << device_.availability << "," << device_.prefetch_distance << ","
+        << device_.prefetch_mode << "," << device_.bulk_mode_chunk_size << ","
+        << warmups_.size() << "," << stats.count() << "," << stats.min()
+        << "," << stats.median() << "," << stats.p95() << "," << stats.mean()
+        << "," << stats.stddev() << "," << stats.max() << ","
+        << verification_ << "\n";
+  }
+
+  // Finds the first number stored under "key" in a JSON file. Reports only
+  // have one "median" (inside "time"), which is all baselines need.
+  static bool ReadJSONNumber(const std::string &filename,
+                             const std::string &key, double *value) {
+    std::ifstream in(filename);
+    if (!in.is_open())
+      return false;
+    std::stringstream contents;
+    contents << in.rdbuf();
+    std::string text = contents.str();
+    size_t pos = text.find("\"" + key + "\"");
+    if (pos == std::string::npos)
+      return false;
+    pos = text.find(':', pos);
+    if (pos == std::string::npos)
+      return false;
+    const char *start = text.c_str() + pos + 1;
+    char *end;
+    *value = std::strtod(start, &end);
+    return end != start;
+  }
+
+ private:
+  const CLApp &cli_;
+  BenchmarkDeviceInfo device_;
+  int64_t num_nodes_ = 0;
+  int64_t num_edges_ = 0;
+  bool directed_ = false;
+  std::vector<double> warmups_;
+  std::vector<double> trials_;
+  std::string verification_ = "skipped";
+  double baseline_median_ = 0;
+  bool regressed_ = false;
+
+  std::string GraphInput() const {
+    if (cli_.filename() != "")
+      return cli_.filename();
+    return std::string(cli_.uniform() ? "uniform" : "kron") + "-" +
+           std::to_string(cli_.scale()) + "-" + std::to_string(cli_.degree());
+  }
+
+  int64_t AverageDegree() const {
+    return num_nodes_ == 0 ? 0 : num_edges_ / num_nodes_;
+  }
+
+  static int NumThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+};
+
+#endif  // BENCHMARK_REPORT_H_
@@ -0,0 +1,213 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef BITMAP_H_
+#define BITMAP_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "pickle_job.h"
+#include "platform_atomics.h"
+#include "sliding_queue.h"
+
+#if PICKLE_TRACE_ACCESSES==1
+#include "access_recorder.h"
+#endif
+
+
+/*
+GAP Benchmark Suite
+Class:  Bitmap
+Author: Scott Beamer
+
+Parallel bitmap that is thread-safe
+ - Can set bits in parallel (set_bit_atomic) unlike std::vector<bool>
+ - The array descriptor uses AccessType::SetBits: as the first array of a job
+   the device walks the set bits, and as a target it is indexed by bit
+   position, so a dense frontier can drive or receive a neighbor chain
+ - swap() exchanges storage together with descriptors, so a descriptor keeps
+   describing the same memory; a job built before a swap follows the buffer
+   it was built from
+
+QueueToBitmap and BitmapToQueue convert a frontier between the sparse
+SlidingQueue and the dense Bitmap. BitmapToQueue skips empty stretches of
+the bitmap kSkipWords words at a time with SIMD (AVX2 or NEON when available)
+before extracting set bits with count-trailing-zeros.
+*/
+
+
+class Bitmap {
+ public:
+  explicit Bitmap(size_t size) {
+    num_bits_ = size;
+    uint64_t num_words = (size + kBitsPerWord - 1) / kBitsPerWord;
+    start_ = new uint64_t[num_words];
+    end_ = start_ + num_words;
+
+    // Initializing array descriptor
+    array_descriptor = std::shared_ptr<PickleArrayDescriptor>(new PickleArrayDescriptor());
+    AddressRange addr_range = getAddressRange();
+    array_descriptor->vaddr_start = addr_range.start;
+    array_descriptor->vaddr_end = addr_range.end;
+    array_descriptor->element_size = getElementSize();
+    array_descriptor->setAccessType(AccessType::SetBits);
+  }
+
+  ~Bitmap() {
+    delete[] start_;
+    array_descriptor = nullptr;
+  }
+
+  void reset() {
+    #pragma omp parallel for
+    for (uint64_t *word = start_; word < end_; word++)
+      *word = 0;
+  }
+
+  void set_bit(size_t pos) {
+    start_[word_offset(pos)] |= ((uint64_t) 1l << bit_offset(pos));
+  }
+
+  void set_bit_atomic(size_t pos) {
+    uint64_t old_val, new_val;
+    do {
+      old_val = start_[word_offset(pos)];
+      new_val = old_val | ((uint64_t) 1l << bit_offset(pos));
+    } while (!compare_and_swap(start_[word_offset(pos)], old_val, new_val));
+  }
+
+  bool get_bit(size_t pos) const {
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().Load(array_descriptor.get(), pos,
+                               start_ + word_offset(pos), false, 0);
+#endif
+    return (start_[word_offset(pos)] >> bit_offset(pos)) & 1l;
+  }
+
+  void swap(Bitmap &other) {
+    std::swap(start_, other.start_);
+    std::swap(end_, other.end_);
+    std::swap(num_bits_, other.num_bits_);
+    std::swap(array_descriptor, other.array_descriptor);
+  }
+
+  // Copies the bits of other, a bitmap of the same size
+  void copy_from(const Bitmap &other) {
+    #pragma omp parallel for
+    for (size_t w=0; w < num_words(); w++)
+      start_[w] = other.start_[w];
+  }
+
+  size_t size() const {
+    return num_bits_;
+  }
+
+  size_t num_words() const {
+    return end_ - start_;
+  }
+
+  const uint64_t* words() const {
+    return start_;
+  }
+
+  // -------------------- Array descriptor interface --------------------
+  AddressRange getAddressRange() const {
+    return AddressRange((uint64_t)start_, (uint64_t)end_);
+  }
+
+  uint64_t getElementSize() const {
+    return sizeof(uint64_t);
+  }
+
+  std::shared_ptr<PickleArrayDescriptor> getArrayDescriptor() const {
+    return this->array_descriptor;
+  }
+
+  void indexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) {
+    descriptor->dst_indexing_array_id = this->array_descriptor->getArrayId();
+  }
+  // -------------------------- Interface END ---------------------------
+
+  static const uint64_t kBitsPerWord = 64;
+
+ private:
+  uint64_t *start_;
+  uint64_t *end_;
+  size_t num_bits_;
+
+  // Array Description
+  std::shared_ptr<PickleArrayDescriptor> array_descriptor;
+
+  static uint64_t word_offset(size_t n) { return n / kBitsPerWord; }
+  static uint64_t bit_offset(size_t n) { return n & (kBitsPerWord - 1); }
+};
+
+
+// Number of words BitmapToQueue tests for zero at once
+const size_t kSkipWords = 4;
+
+// True if all kSkipWords words starting at words are zero
+inline bool AllZeroWords(const uint64_t *words) {
+#if defined(__AVX2__)
+  __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words));
+  return _mm256_testz_si256(block, block);
+#elif defined(__ARM_NEON)
+  uint64x2_t block = vorrq_u64(vld1q_u64(words), vld1q_u64(words + 2));
+  return vmaxvq_u32(vreinterpretq_u32_u64(block)) == 0;
+#else
+  return (words[0] | words[1] | words[2] | words[3]) == 0;
+#endif
+}
+
+
+template <typename NodeID_>
+void QueueToBitmap(const SlidingQueue<NodeID_> &queue, Bitmap &bm) {
+  #pragma omp parallel for
+  for (auto q_iter = queue.begin(); q_iter < queue.end(); q_iter++) {
+    NodeID_ u = *q_iter;
+    bm.set_bit_atomic(u);
+  }
+}
+
+
+// Appends the set bits of bm to queue (in increasing order per thread chunk)
+// and slides the queue's window so they form its next frontier
+template <typename NodeID_>
+void BitmapToQueue(const Bitmap &bm, SlidingQueue<NodeID_> &queue) {
+  const uint64_t *words = bm.words();
+  const int64_t num_blocks = bm.num_words() / kSkipWords;
+  #pragma omp parallel
+  {
+    QueueBuffer<NodeID_> lqueue(queue);
+    auto ExtractWord = [&lqueue] (uint64_t word, int64_t w) {
+      while (word != 0) {
+        int bit = __builtin_ctzll(word);
+        lqueue.push_back(w * Bitmap::kBitsPerWord + bit);
+        word &= word - 1;
+      }
+    };
+    #pragma omp for schedule(static, 256) nowait
+    for (int64_t b=0; b < num_blocks; b++) {
+      if (AllZeroWords(words + b * kSkipWords))
+        continue;
+      for (size_t w = b * kSkipWords; w < (b + 1) * kSkipWords; w++)
+        ExtractWord(words[w], w);
+    }
+    #pragma omp single nowait
+    for (size_t w = num_blocks * kSkipWords; w < bm.num_words(); w++)
+      ExtractWord(words[w], w);
+    lqueue.flush();
+  }
+  queue.slide_window();
+}
+
+#endif  // BITMAP_H_
@@ -0,0 +1,417 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef BUILDER_H_
+#define BUILDER_H_
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "command_line.h"
+#include "pvector.h"
+#include "generator.h"
+#include "graph.h"
+#include "platform_atomics.h"
+#include "reader.h"
+#include "reorder.h"
+#include "shared_graph.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  BuilderBase
+Author: Scott Beamer
+
+Given arguments from the command line (cli), returns a built graph
+ - MakeGraph() will parse cli and obtain edgelist to call
+   MakeGraphFromEdgelist() to perform the actual graph construction
+ - edgelist can be from file (Reader) or synthetically generated (Generator)
+ - CSR is built with a parallel degree histogram, a parallel prefix sum and a
+   parallel scatter; neighborhoods are then sorted and deduplicated (squished)
+   unless squishing is turned off
+ - In-place building (-m) sorts the edge list and compacts the destinations
+   into the edge list's own storage, which the graph adopts after
+   pvector::leak(), so the edge list is never copied; the pages it no
+   longer needs are released
+ - With -S name, the graph is built (or read) by the first process to ask
+   for it and then shared read-only with the others through shared memory,
+   mapped at the same address everywhere (shared_graph.h)
+ - The returned CSRGraph has its array descriptors constructed
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          typename WeightT_ = NodeID_, bool invert = true>
+class BuilderBase {
+  typedef EdgePair<NodeID_, DestID_> Edge;
+  typedef pvector<Edge> EdgeList;
+  typedef CSRGraph<NodeID_, DestID_, invert> CSRGraphT;
+
+  const CLBase &cli_;
+  bool symmetrize_;
+  bool needs_weights_;
+  bool in_place_ = false;
+  bool squish_ = true;
+  int64_t num_nodes_ = -1;
+
+ public:
+  explicit BuilderBase(const CLBase &cli, bool squish = true)
+      : cli_(cli), squish_(squish) {
+    symmetrize_ = cli_.symmetrize();
+    needs_weights_ = !std::is_same<NodeID_, DestID_>::value;
+    in_place_ = cli_.in_place();
+    if (in_place_ && needs_weights_) {
+      std::cout << "In-place building (-m) does not support weighted graphs"
+                << std::endl;
+      std::exit(-30);
+    }
+  }
+
+  DestID_ GetSource(EdgePair<NodeID_, NodeID_> e) {
+    return e.u;
+  }
+
+  DestID_ GetSource(EdgePair<NodeID_, NodeWeight<NodeID_, WeightT_>> e) {
+    return NodeWeight<NodeID_, WeightT_>(e.u, e.v.w);
+  }
+
+  NodeID_ FindMaxNodeID(const EdgeList &el) {
+    NodeID_ max_seen = 0;
+    #pragma omp parallel for reduction(max : max_seen)
+    for (auto it = el.begin(); it < el.end(); it++) {
+      Edge e = *it;
+      max_seen = std::max(max_seen, e.u);
+      max_seen = std::max(max_seen, (NodeID_) e.v);
+    }
+    return max_seen;
+  }
+
+  pvector<NodeID_> CountDegrees(const EdgeList &el, bool transpose) {
+    pvector<NodeID_> degrees(num_nodes_, 0);
+    #pragma omp parallel for
+    for (auto it = el.begin(); it < el.end(); it++) {
+      Edge e = *it;
+      if (symmetrize_ || (!symmetrize_ && !transpose))
+        fetch_and_add(degrees[e.u], 1);
+      if (symmetrize_ || (!symmetrize_ && transpose))
+        fetch_and_add(degrees[(NodeID_) e.v], 1);
+    }
+    return degrees;
+  }
+
+  static pvector<SGOffset> PrefixSum(const pvector<NodeID_> &degrees) {
+    pvector<SGOffset> sums(degrees.size() + 1);
+    SGOffset total = 0;
+    for (size_t n=0; n < degrees.size(); n++) {
+      sums[n] = total;
+      total += degrees[n];
+    }
+    sums[degrees.size()] = total;
+    return sums;
+  }
+
+  static pvector<SGOffset> ParallelPrefixSum(const pvector<NodeID_> &degrees) {
+    const size_t block_size = 1<<20;
+    const size_t num_blocks = (degrees.size() + block_size - 1) / block_size;
+    pvector<SGOffset> local_sums(num_blocks);
+    #pragma omp parallel for
+    for (size_t block=0; block < num_blocks; block++) {
+      SGOffset lsum = 0;
+      size_t block_end = std::min((block + 1) * block_size, degrees.size());
+      for (size_t i=block * block_size; i < block_end; i++)
+        lsum += degrees[i];
+      local_sums[block] = lsum;
+    }
+    pvector<SGOffset> bulk_prefix(num_blocks+1);
+    SGOffset total = 0;
+    for (size_t block=0; block < num_blocks; block++) {
+      bulk_prefix[block] = total;
+      total += local_sums[block];
+    }
+    bulk_prefix[num_blocks] = total;
+    pvector<SGOffset> prefix(degrees.size() + 1);
+    #pragma omp parallel for
+    for (size_t block=0; block < num_blocks; block++) {
+      SGOffset local_total = bulk_prefix[block];
+      size_t block_end = std::min((block + 1) * block_size, degrees.size());
+      for (size_t i=block * block_size; i < block_end; i++) {
+        prefix[i] = local_total;
+        local_total += degrees[i];
+      }
+    }
+    prefix[degrees.size()] = bulk_prefix[num_blocks];
+    return prefix;
+  }
+
+  // Removes self-loops and redundant edges
+  // Side effect: neighbor IDs will be sorted
+  void SquishCSR(const CSRGraphT &g, bool transpose,
+                 DestID_*** sq_index, DestID_** sq_neighs) {
+    pvector<NodeID_> diffs(g.num_nodes());
+    DestID_ *n_start, *n_end;
+    #pragma omp parallel for private(n_start, n_end)
+    for (NodeID_ n=0; n < g.num_nodes(); n++) {
+      if (transpose) {
+        n_start = g.in_neigh(n).begin();
+        n_end = g.in_neigh(n).end();
+      } else {
+        n_start = g.out_neigh(n).begin();
+        n_end = g.out_neigh(n).end();
+      }
+      std::sort(n_start, n_end);
+      DestID_ *new_end = std::unique(n_start, n_end);
+      new_end = std::remove(n_start, new_end, n);
+      diffs[n] = new_end - n_start;
+    }
+    pvector<SGOffset> sq_offsets = ParallelPrefixSum(diffs);
+    *sq_neighs = new DestID_[sq_offsets[g.num_nodes()]];
+    *sq_index = CSRGraphT::GenIndex(sq_offsets, *sq_neighs);
+    #pragma omp parallel for private(n_start)
+    for (NodeID_ n=0; n < g.num_nodes(); n++) {
+      if (transpose)
+        n_start = g.in_neigh(n).begin();
+      else
+        n_start = g.out_neigh(n).begin();
+      std::copy(n_start, n_start+diffs[n], (*sq_index)[n]);
+    }
+  }
+
+  CSRGraphT SquishGraph(const CSRGraphT &g) {
+    DestID_ **out_index, *out_neighs, **in_index, *in_neighs;
+    SquishCSR(g, false, &out_index, &out_neighs);
+    if (g.directed()) {
+      if (invert)
+        SquishCSR(g, true, &in_index, &in_neighs);
+      return CSRGraphT(g.num_nodes(), out_index, out_neighs, in_index,
+                       in_neighs);
+    } else {
+      return CSRGraphT(g.num_nodes(), out_index, out_neighs);
+    }
+  }
+
+  /*
+  In-Place Graph Building Steps
+    - symmetrize by appending reversed edges to the edge list (if needed)
+    - sort edges by source then destination
+    - squish: drop self-loops and duplicates from each vertex's run of edges
+      in parallel, leaving the kept edges at the front of its run
+    - build the inverse graph (if needed) by scattering from the kept edges
+    - compact destinations to the front of the edge list storage in rounds
+      whose writes only land on already-consumed edges, so each round is
+      parallel; the graph then adopts that storage via pvector::leak() and
+      the pages past the neighbors are handed back to the OS
+  */
+  void MakeCSRInPlace(EdgeList &el, DestID_*** index, DestID_** neighs,
+                      DestID_*** inv_index, DestID_** inv_neighs) {
+    static_assert(std::is_trivially_destructible<Edge>::value &&
+                  sizeof(DestID_) <= sizeof(Edge),
+                  "in-place building reinterprets edge storage as neighbors");
+    if (symmetrize_) {
+      const size_t num_directed = el.size();
+      el.resize(2 * num_directed);
+      #pragma omp parallel for
+      for (size_t e=0; e < num_directed; e++)
+        el[num_directed + e] = Edge(static_cast<NodeID_>(el[e].v),
+                                    GetSource(el[e]));
+    }
+    ParallelSort(el.begin(), el.end(), std::less<Edge>());
+    bool saved_symmetrize = symmetrize_;
+    symmetrize_ = false;  // reverse edges are already in el
+    pvector<NodeID_> degrees = CountDegrees(el, false);
+    symmetrize_ = saved_symmetrize;
+    pvector<SGOffset> runs = ParallelPrefixSum(degrees);
+    if (squish_) {
+      #pragma omp parallel for schedule(dynamic, 1024)
+      for (NodeID_ n=0; n < num_nodes_; n++) {
+        Edge *run_start = el.begin() + runs[n];
+        Edge *new_end = std::unique(run_start, el.begin() + runs[n+1]);
+        new_end = std::remove_if(run_start, new_end, [n] (Edge e) {
+          return static_cast<NodeID_>(e.v) == n;
+        });
+        degrees[n] = new_end - run_start;
+      }
+    }
+    pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
+    const size_t num_edges = offsets[num_nodes_];
+    if (!symmetrize_ && invert) {
+      MakeInverseCSR(el, runs, degrees, inv_index, inv_neighs);
+      if (squish_) {
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (NodeID_ n=0; n < num_nodes_; n++)
+          std::sort((*inv_index)[n], (*inv_index)[n+1]);
+      }
+    }
+    // neighbor e is read from an edge at or after e and written over edges
+    // at or before e, so a round's writes land below lo and its reads above
+    *neighs = reinterpret_cast<DestID_*>(el.data());
+    const size_t kSerialPrefix = 1<<10;
+    const size_t kBlockSize = 1<<14;
+    size_t lo = std::min(kSerialPrefix, num_edges);
+    CompactNeighbors(el, runs, offsets, 0, lo, *neighs);
+    while (lo < num_edges) {
+      size_t hi = std::max(lo + 1, lo * sizeof(Edge) / sizeof(DestID_));
+      hi = std::min(hi, num_edges);
+      #pragma omp parallel for
+      for (size_t block=lo; block < hi; block += kBlockSize)
+        CompactNeighbors(el, runs, offsets, block,
+                         std::min(block + kBlockSize, hi), *neighs);
+      lo = hi;
+    }
+    ReleaseTail(*neighs + num_edges,
+                reinterpret_cast<char*>(el.data() + el.capacity()));
+    el.leak();
+    *index = CSRGraphT::GenIndex(offsets, *neighs);
+  }
+
+  // Scatters the first degrees[n] edges of each run into a transposed CSR
+  void MakeInverseCSR(const EdgeList &el, const pvector<SGOffset> &runs,
+                      const pvector<NodeID_> &degrees, DestID_*** inv_index,
+                      DestID_** inv_neighs) {
+    pvector<NodeID_> in_degrees(num_nodes_, 0);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      for (SGOffset e=runs[n]; e < runs[n] + degrees[n]; e++) {
+        Edge edge = el[e];
+        fetch_and_add(in_degrees[static_cast<NodeID_>(edge.v)], 1);
+      }
+    }
+    pvector<SGOffset> in_offsets = ParallelPrefixSum(in_degrees);
+    *inv_neighs = new DestID_[in_offsets[num_nodes_]];
+    *inv_index = CSRGraphT::GenIndex(in_offsets, *inv_neighs);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      for (SGOffset e=runs[n]; e < runs[n] + degrees[n]; e++) {
+        Edge edge = el[e];
+        NodeID_ v = static_cast<NodeID_>(edge.v);
+        (*inv_neighs)[fetch_and_add(in_offsets[v], 1)] = GetSource(edge);
+      }
+    }
+  }
+
+  // Writes neighbors [first, last), neighbor i of vertex n coming from the
+  // i-th kept edge of n's run
+  static void CompactNeighbors(const EdgeList &el,
+                               const pvector<SGOffset> &runs,
+                               const pvector<SGOffset> &offsets,
+                               size_t first, size_t last, DestID_ *neighs) {
+    if (first >= last)
+      return;
+    NodeID_ n = std::upper_bound(offsets.begin(), offsets.end(),
+                                 static_cast<SGOffset>(first)) -
+                offsets.begin() - 1;
+    for (size_t e=first; e < last; e++) {
+      while (offsets[n+1] <= static_cast<SGOffset>(e))
+        n++;
+      neighs[e] = el[runs[n] + (e - offsets[n])].v;
+    }
+  }
+
+  // Returns the whole pages in [start, end) to the OS; the memory stays
+  // allocated, so delete[] on the neighbors still frees all of it
+  static void ReleaseTail(void *start, void *end) {
+    const uintptr_t kPageBytes = sysconf(_SC_PAGESIZE);
+    uintptr_t first = (reinterpret_cast<uintptr_t>(start) + kPageBytes - 1) /
+                      kPageBytes * kPageBytes;
+    uintptr_t last = reinterpret_cast<uintptr_t>(end) / kPageBytes *
+                     kPageBytes;
+    if (first < last)
+      madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+  }
+
+  void MakeCSR(const EdgeList &el, bool transpose, DestID_*** index,
+               DestID_** neighs) {
+    pvector<NodeID_> degrees = CountDegrees(el, transpose);
+    pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
+    *neighs = new DestID_[offsets[num_nodes_]];
+    *index = CSRGraphT::GenIndex(offsets, *neighs);
+    #pragma omp parallel for
+    for (auto it = el.begin(); it < el.end(); it++) {
+      Edge e = *it;
+      if (symmetrize_ || (!symmetrize_ && !transpose))
+        (*neighs)[fetch_and_add(offsets[e.u], 1)] = e.v;
+      if (symmetrize_ || (!symmetrize_ && transpose))
+        (*neighs)[fetch_and_add(offsets[static_cast<NodeID_>(e.v)], 1)] =
+            GetSource(e);
+    }
+  }
+
+  CSRGraphT MakeGraphFromEL(EdgeList &el) {
+    DestID_ **index = nullptr, **inv_index = nullptr;
+    DestID_ *neighs = nullptr, *inv_neighs = nullptr;
+    Timer t;
+    t.Start();
+    if (num_nodes_ == -1)
+      num_nodes_ = FindMaxNodeID(el)+1;
+    if (needs_weights_)
+      Generator<NodeID_, DestID_, WeightT_>::InsertWeights(el);
+    if (in_place_) {
+      MakeCSRInPlace(el, &index, &neighs, &inv_index, &inv_neighs);
+    } else {
+      MakeCSR(el, false, &index, &neighs);
+      if (!symmetrize_ && invert)
+        MakeCSR(el, true, &inv_index, &inv_neighs);
+    }
+    t.Stop();
+    PrintTime("Build Time", t.Seconds());
+    if (symmetrize_)
+      return CSRGraphT(num_nodes_, index, neighs);
+    else
+      return CSRGraphT(num_nodes_, index, neighs, inv_index, inv_neighs);
+  }
+
+  // What the graph was made from, so processes sharing a graph (-S) can
+  // tell whether the one in shared memory is theirs
+  std::string SharedGraphKey() const {
+    std::ostringstream key;
+    key << "f=" << cli_.filename() << " g=" << cli_.scale()
+        << " k=" << cli_.degree() << " u=" << cli_.uniform()
+        << " s=" << symmetrize_ << " squish=" << (squish_ && !in_place_)
+        << " dest=" << sizeof(DestID_) << " invert=" << invert;
+    return key.str();
+  }
+
+  CSRGraphT MakeGraph() {
+    if (cli_.shared_graph() != "")
+      return OpenSharedGraph<NodeID_, DestID_, invert>(
+          cli_.shared_graph(), SharedGraphKey(),
+          [this] { return MakePrivateGraph(); });
+    return MakePrivateGraph();
+  }
+
+  CSRGraphT MakePrivateGraph() {
+    CSRGraphT g;
+    {  // extra scope to trigger earlier deletion of el (save memory)
+      EdgeList el;
+      if (cli_.filename() != "") {
+        Reader<NodeID_, DestID_, WeightT_, invert> r(cli_.filename());
+        if ((r.GetSuffix() == ".sg") || (r.GetSuffix() == ".wsg")) {
+          return r.ReadSerializedGraph();
+        } else if (r.GetSuffix() == ".csg") {
+          return r.ReadCompressedGraph();
+        } else {
+          el = r.ReadFile(needs_weights_);
+        }
+      } else if (cli_.scale() != -1) {
+        Generator<NodeID_, DestID_, WeightT_> gen(cli_.scale(), cli_.degree());
+        el = gen.GenerateEL(cli_.uniform());
+      }
+      g = MakeGraphFromEL(el);
+    }
+    if (in_place_ || !squish_)
+      return g;
+    return SquishGraph(g);
+  }
+};
+
+#endif  // BUILDER_H_
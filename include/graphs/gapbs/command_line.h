@@ -0,0 +1,340 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef COMMAND_LINE_H_
+#define COMMAND_LINE_H_
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "reorder.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  CLBase
+Author: Scott Beamer
+
+Handles command line argument parsing
+ - Through inheritance, can add more options to object
+ - For example, most kernels will use CLApp
+ - Without -f, -g or -u the input defaults to a Kronecker graph of scale
+   kDefaultScale so the kernels run without any external graph files
+ - Synthetic graphs (-g, -u and the default) are always symmetrized
+*/
+
+
+class CLBase {
+ protected:
+  int argc_;
+  char** argv_;
+  std::string name_;
+  std::string get_args_ = "f:g:hk:su:mS:";
+  std::vector<std::string> help_strings_;
+
+  static const int kDefaultScale = 16;
+
+  int scale_ = -1;
+  int degree_ = 16;
+  std::string filename_ = "";
+  bool symmetrize_ = false;
+  bool uniform_ = false;
+  bool in_place_ = false;
+  std::string shared_graph_ = "";
+  bool invalid_args_ = false;
+
+  void AddHelpLine(char opt, std::string opt_arg, std::string text,
+                   std::string def = "") {
+    const int kBufLen = 100;
+    char buf[kBufLen];
+    if (opt_arg != "")
+      opt_arg = "<" + opt_arg + ">";
+    if (def != "")
+      def = "[" + def + "]";
+    snprintf(buf, kBufLen, " -%c %-9s: %-54s%10s", opt, opt_arg.c_str(),
+            text.c_str(), def.c_str());
+    help_strings_.push_back(buf);
+  }
+
+ public:
+  CLBase(int argc, char** argv, std::string name = "") :
+         argc_(argc), argv_(argv), name_(name) {
+    AddHelpLine('h', "", "print this help message");
+    AddHelpLine('f', "file", "load graph from file (.el .wel .sg .wsg .csg)");
+    AddHelpLine('s', "", "symmetrize input edge list", "false");
+    AddHelpLine('g', "scale", "generate 2^scale kronecker graph");
+    AddHelpLine('u', "scale", "generate 2^scale uniform-random graph");
+    AddHelpLine('k', "degree", "average degree for synthetic graph",
+                std::to_string(degree_));
+    AddHelpLine('m', "", "reduces memory usage during graph building",
+                "false");
+    AddHelpLine('S', "name", "share graph with other processes (/dev/shm)");
+  }
+
+  virtual ~CLBase() {}
+
+  bool ParseArgs() {
+    signed char c_opt;
+    extern char *optarg;          // from and for getopt
+    while ((c_opt = getopt(argc_, argv_, get_args_.c_str())) != -1) {
+      HandleArg(c_opt, optarg);
+    }
+    if (invalid_args_)
+      return false;
+    if (filename_ != "" && scale_ != -1) {
+      std::cout << "Only one graph input may be specified. (Use -h for help)"
+                << std::endl;
+      return false;
+    }
+    if (filename_ == "" && scale_ == -1) {
+      std::cout << "No graph input specified, generating a kronecker graph "
+                << "of scale " << kDefaultScale << std::endl;
+      scale_ = kDefaultScale;
+    }
+    if (scale_ != -1)
+      symmetrize_ = true;
+    return true;
+  }
+
+  void virtual HandleArg(signed char opt, char* opt_arg) {
+    switch (opt) {
+      case 'f': filename_ = std::string(opt_arg);           break;
+      case 'g': scale_ = atoi(opt_arg);                     break;
+      case 'h': PrintUsage();                               break;
+      case 'k': degree_ = atoi(opt_arg);                    break;
+      case 'm': in_place_ = true;                           break;
+      case 's': symmetrize_ = true;                         break;
+      case 'u': uniform_ = true; scale_ = atoi(opt_arg);    break;
+      case 'S': shared_graph_ = std::string(opt_arg);       break;
+    }
+  }
+
+  void PrintUsage() {
+    std::cout << name_ << std::endl;
+    // std::sort(help_strings_.begin(), help_strings_.end());
+    for (std::string h : help_strings_)
+      std::cout << h << std::endl;
+    std::exit(0);
+  }
+
+  std::string name() const { return name_; }
+  int scale() const { return scale_; }
+  int degree() const { return degree_; }
+  std::string filename() const { return filename_; }
+  bool symmetrize() const { return symmetrize_; }
+  bool uniform() const { return uniform_; }
+  bool in_place() const { return in_place_; }
+  std::string shared_graph() const { return shared_graph_; }
+};
+
+
+
+class CLApp : public CLBase {
+  bool do_analysis_ = false;
+  int num_trials_ = 16;
+  int64_t start_vertex_ = -1;
+  bool do_verify_ = false;
+  bool enable_logging_ = false;
+  ReorderMethod reorder_method_ = ReorderMethod::kNone;
+  int num_warmups_ = 0;
+  std::string json_filename_ = "";
+  std::string csv_filename_ = "";
+  std::string baseline_filename_ = "";
+  double regression_threshold_ = 5;
+
+ public:
+  CLApp(int argc, char** argv, std::string name) : CLBase(argc, argv, name) {
+    get_args_ += "alr:n:o:vw:j:c:b:x:";
+    AddHelpLine('a', "", "output analysis of last run", "false");
+    AddHelpLine('l', "", "log performance within each trial", "false");
+    AddHelpLine('n', "n", "perform n trials", std::to_string(num_trials_));
+    AddHelpLine('r', "node", "start from node r", "rand");
+    AddHelpLine('o', "method", "reorder vertices (degree hub rcm gorder)",
+                "none");
+    AddHelpLine('v', "", "verify the output of each run", "false");
+    AddHelpLine('w', "n", "perform n untimed warm-up trials first",
+                std::to_string(num_warmups_));
+    AddHelpLine('j', "file", "write trial times and stats as JSON to file");
+    AddHelpLine('c', "file", "append trial stats as a CSV row to file");
+    AddHelpLine('b', "file", "compare median to JSON report in file");
+    AddHelpLine('x', "percent", "median slowdown over baseline that fails",
+                std::to_string(regression_threshold_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'a': do_analysis_ = true;                    break;
+      case 'l': enable_logging_ = true;                 break;
+      case 'n': num_trials_ = atoi(opt_arg);            break;
+      case 'o':
+        if (!ParseReorderMethod(opt_arg, &reorder_method_)) {
+          std::cout << "Unknown reorder method " << opt_arg
+                    << " (Use -h for help)" << std::endl;
+          invalid_args_ = true;
+        }
+        break;
+      case 'r': start_vertex_ = atol(opt_arg);          break;
+      case 'v': do_verify_ = true;                      break;
+      case 'w': num_warmups_ = atoi(opt_arg);           break;
+      case 'j': json_filename_ = std::string(opt_arg);  break;
+      case 'c': csv_filename_ = std::string(opt_arg);   break;
+      case 'b': baseline_filename_ = std::string(opt_arg);  break;
+      case 'x': regression_threshold_ = std::stod(opt_arg); break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  bool do_analysis() const { return do_analysis_; }
+  int num_trials() const { return num_trials_; }
+  int64_t start_vertex() const { return start_vertex_; }
+  bool do_verify() const { return do_verify_; }
+  bool logging_en() const { return enable_logging_; }
+  ReorderMethod reorder_method() const { return reorder_method_; }
+  int num_warmups() const { return num_warmups_; }
+  std::string json_filename() const { return json_filename_; }
+  std::string csv_filename() const { return csv_filename_; }
+  std::string baseline_filename() const { return baseline_filename_; }
+  double regression_threshold() const { return regression_threshold_; }
+};
+
+
+
+class CLIterApp : public CLApp {
+  int num_iters_;
+
+ public:
+  CLIterApp(int argc, char** argv, std::string name, int num_iters) :
+    CLApp(argc, argv, name), num_iters_(num_iters) {
+    get_args_ += "i:";
+    AddHelpLine('i', "i", "perform i iterations", std::to_string(num_iters_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'i': num_iters_ = atoi(opt_arg);            break;
+      default: CLApp::HandleArg(opt, opt_arg);
+    }
+  }
+
+  int num_iters() const { return num_iters_; }
+};
+
+
+
+class CLPageRank : public CLApp {
+  int max_iters_;
+  double tolerance_;
+  int num_batches_ = 0;
+
+ public:
+  CLPageRank(int argc, char** argv, std::string name, double tolerance,
+             int max_iters) :
+    CLApp(argc, argv, name), max_iters_(max_iters), tolerance_(tolerance) {
+    get_args_ += "i:t:d:";
+    AddHelpLine('i', "i", "perform at most i iterations",
+                std::to_string(max_iters_));
+    AddHelpLine('t', "t", "use tolerance t", std::to_string(tolerance_));
+    AddHelpLine('d', "d", "apply d batches of random edge updates first",
+                std::to_string(num_batches_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'i': max_iters_ = atoi(opt_arg);            break;
+      case 't': tolerance_ = std::stod(opt_arg);       break;
+      case 'd': num_batches_ = atoi(opt_arg);          break;
+      default: CLApp::HandleArg(opt, opt_arg);
+    }
+  }
+
+  int max_iters() const { return max_iters_; }
+  double tolerance() const { return tolerance_; }
+  int num_batches() const { return num_batches_; }
+};
+
+
+
+template<typename WeightT_>
+class CLDelta : public CLApp {
+  WeightT_ delta_ = 1;
+
+ public:
+  CLDelta(int argc, char** argv, std::string name) : CLApp(argc, argv, name) {
+    get_args_ += "d:";
+    AddHelpLine('d', "d", "delta parameter", std::to_string(delta_));
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'd':
+        if (std::is_floating_point<WeightT_>::value)
+          delta_ = static_cast<WeightT_>(atof(opt_arg));
+        else
+          delta_ = static_cast<WeightT_>(atol(opt_arg));
+        break;
+      default: CLApp::HandleArg(opt, opt_arg);
+    }
+  }
+
+  WeightT_ delta() const { return delta_; }
+};
+
+
+
+class CLConvert : public CLBase {
+  std::string out_filename_ = "";
+  bool out_weighted_ = false;
+  bool out_el_ = false;
+  bool out_sg_ = false;
+  bool out_sgs_ = false;
+  bool out_csg_ = false;
+  int num_shards_ = 16;
+
+ public:
+  CLConvert(int argc, char** argv, std::string name)
+      : CLBase(argc, argv, name) {
+    get_args_ += "e:b:wx:n:z:";
+    AddHelpLine('b', "file", "output serialized graph to file");
+    AddHelpLine('x', "file", "output sharded serialized graph (.sgs) to file");
+    AddHelpLine('n', "n", "number of shards for -x",
+                std::to_string(num_shards_));
+    AddHelpLine('z', "file", "output compressed graph (.csg) to file");
+    AddHelpLine('e', "file", "output edge list to file");
+    AddHelpLine('w', "file", "make output weighted");
+  }
+
+  void HandleArg(signed char opt, char* opt_arg) override {
+    switch (opt) {
+      case 'b': out_sg_ = true; out_filename_ = std::string(opt_arg);   break;
+      case 'e': out_el_ = true; out_filename_ = std::string(opt_arg);   break;
+      case 'w': out_weighted_ = true;                                   break;
+      case 'x': out_sgs_ = true; out_filename_ = std::string(opt_arg);  break;
+      case 'n':
+        num_shards_ = atoi(opt_arg);
+        if (num_shards_ < 1) {
+          std::cout << "Number of shards must be at least 1 (Use -h for help)"
+                    << std::endl;
+          invalid_args_ = true;
+        }
+        break;
+      case 'z': out_csg_ = true; out_filename_ = std::string(opt_arg);  break;
+      default: CLBase::HandleArg(opt, opt_arg);
+    }
+  }
+
+  std::string out_filename() const { return out_filename_; }
+  bool out_weighted() const { return out_weighted_; }
+  bool out_el() const { return out_el_; }
+  bool out_sg() const { return out_sg_; }
+  bool out_sgs() const { return out_sgs_; }
+  bool out_csg() const { return out_csg_; }
+  int num_shards() const { return num_shards_; }
+};
+
+#endif  // COMMAND_LINE_H_
@@ -0,0 +1,545 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef COMPRESSED_GRAPH_H_
+#define COMPRESSED_GRAPH_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "graph.h"
+#include "pvector.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  CompressedGraph
+
+Unweighted graph whose neighbor lists are stored delta encoded and bit
+packed, for cold graphs whose raw neighbor arrays dominate memory and load
+I/O (.csg, WriterBase::WriteCompressedGraph)
+ - A neighborhood is its degree and first neighbor as varints, then the
+   gaps between consecutive neighbors in blocks of 64, each bit packed to
+   its widest gap (a byte of width, then the gaps). Neighborhoods are
+   sorted while being encoded, so they come back sorted
+ - Full blocks are packed in 4 vertical lanes (gap i in lane i % 4, as in
+   SIMD-BP128): one 128-bit load gives the same bit slice of 4 consecutive
+   gaps, so the decoder unpacks 4 gaps per shift and mask and turns them
+   into neighbor IDs with an in-register prefix sum. SSE2 on x86-64 and
+   NEON on AArch64, plain C++ elsewhere; the layout is the same for all.
+   The partial last block, which is all there is for most low-degree
+   vertices, is packed gap after gap and decoded without branches
+ - The byte offset of every neighborhood is kept, so a single neighborhood
+   can be decoded on its own (DecodeOutNeigh / DecodeInNeigh), e.g. by code
+   that walks a compressed graph that stays compressed
+ - Decode() expands the whole graph into a regular CSRGraph in parallel:
+   one pass reads the degrees, a prefix sum places every neighborhood and a
+   second pass decodes them in place
+ - The format saves space, not load time: with the file in the page cache,
+   reading a .csg and decoding it is slower than reading the .sg, since
+   faulting in the decoded neighbor array alone costs about as much as the
+   raw read. It only pays off when reading the file is the bottleneck
+*/
+
+
+// Layout of a .csg file: this header, then for the out-neighborhoods (and,
+// for directed graphs, the in-neighborhoods) num_nodes+1 byte offsets
+// (uint64_t) followed by the encoded bytes
+struct CompressedGraphHeader {
+  static constexpr const char* kMagic = "PKCSG001";
+
+  char magic[8];
+  uint64_t directed;
+  int64_t num_nodes;
+  int64_t num_edges_directed;
+  uint64_t out_bytes;
+  uint64_t in_bytes;
+};
+
+
+class NeighborCodec {
+ public:
+  static const int kBlockSize = 64;
+
+  static uint8_t* PutVarint(uint64_t value, uint8_t *out) {
+    while (value >= 0x80) {
+      *out++ = static_cast<uint8_t>(value) | 0x80;
+      value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+  }
+
+  static const uint8_t* GetVarint(const uint8_t *in, uint64_t *value) {
+    if (*in < 0x80) {
+      *value = *in;
+      return in + 1;
+    }
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+      uint8_t byte = *in++;
+      v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (byte < 0x80)
+        break;
+    }
+    *value = v;
+    return in;
+  }
+
+  // Decode reads up to this many bytes past the end of an encoding
+  static const int kPadding = 8;
+
+  // Most bytes a neighborhood of the given degree encodes to
+  static size_t MaxBytes(int64_t degree) {
+    return 20 + degree * 4 + (degree / kBlockSize + 1);
+  }
+
+  // Encodes sorted neighbors; returns the end of the written bytes
+  static uint8_t* Encode(const uint32_t *neighs, int64_t degree,
+                         uint8_t *out) {
+    out = PutVarint(degree, out);
+    if (degree == 0)
+      return out;
+    out = PutVarint(neighs[0], out);
+    int64_t i = 1;
+    uint32_t gaps[kBlockSize];
+    while (i < degree) {
+      const int count = std::min<int64_t>(kBlockSize, degree - i);
+      uint32_t widest = 0;
+      for (int j=0; j < count; j++) {
+        gaps[j] = neighs[i+j] - neighs[i+j-1];
+        widest |= gaps[j];
+      }
+      const int bits = widest == 0 ? 0 : 32 - __builtin_clz(widest);
+      *out++ = bits;
+      if (count == kBlockSize)
+        out = PackBlock(gaps, bits, out);
+      else
+        out = PackTail(gaps, count, bits, out);
+      i += count;
+    }
+    return out;
+  }
+
+  static uint64_t Degree(const uint8_t *in) {
+    uint64_t degree;
+    GetVarint(in, &degree);
+    return degree;
+  }
+
+  // Decodes one neighborhood into out; returns its degree
+  static int64_t Decode(const uint8_t *in, uint32_t *out) {
+    uint64_t degree, value;
+    in = GetVarint(in, &degree);
+    if (degree == 0)
+      return 0;
+    in = GetVarint(in, &value);
+    out[0] = value;
+    uint64_t i = 1;
+    for (; i + kBlockSize <= degree; i += kBlockSize) {
+      const int bits = *in++;
+      UnpackBlock(in, bits, out[i-1], out + i);
+      in += BlockBytes(bits);
+    }
+    if (i < degree) {
+      const int bits = *in++;
+      UnpackTail(in, degree - i, bits, out[i-1], out + i);
+    }
+    return degree;
+  }
+
+ private:
+  // 4 lanes of 32-bit words, interleaved
+  static size_t BlockBytes(int bits) {
+    return 16 * ((kBlockSize / 4 * bits + 31) / 32);
+  }
+
+  // Gap 4j+l is bits [j*bits, (j+1)*bits) of lane l, whose 32-bit words are
+  // interleaved with the other lanes' (word k of lane l at word 4k+l)
+  static uint8_t* PackBlock(const uint32_t *gaps, int bits, uint8_t *out) {
+    uint32_t words[kBlockSize] = {};
+    for (int j=0; j < kBlockSize / 4; j++) {
+      const int bit = j * bits, k = bit >> 5, s = bit & 31;
+      for (int l=0; l < 4; l++) {
+        const uint32_t gap = gaps[4*j + l];
+        words[4*k + l] |= gap << s;
+        if (s + bits > 32)
+          words[4*(k+1) + l] |= gap >> (32 - s);
+      }
+    }
+    std::memcpy(out, words, BlockBytes(bits));
+    return out + BlockBytes(bits);
+  }
+
+  // The partial last block: count gaps of the given width, one after the
+  // other from bit 0 of the first byte
+  static uint8_t* PackTail(const uint32_t *gaps, int count, int bits,
+                           uint8_t *out) {
+    uint64_t pending = 0;
+    int pending_bits = 0;
+    for (int j=0; j < count; j++) {
+      pending |= static_cast<uint64_t>(gaps[j]) << pending_bits;
+      pending_bits += bits;
+      for (; pending_bits >= 8; pending_bits -= 8) {
+        *out++ = pending;
+        pending >>= 8;
+      }
+    }
+    if (pending_bits > 0)
+      *out++ = pending;
+    return out;
+  }
+
+  // Branch-free: every gap is one unaligned 64-bit load, shift and mask
+  static void UnpackTail(const uint8_t *in, int count, int bits,
+                         uint32_t base, uint32_t *out) {
+    const uint64_t mask = (1ULL << bits) - 1;
+    uint32_t prev = base;
+    for (int j=0; j < count; j++) {
+      const int bit = j * bits;
+      uint64_t word;
+      std::memcpy(&word, in + (bit >> 3), sizeof(word));
+      prev += static_cast<uint32_t>((word >> (bit & 7)) & mask);
+      out[j] = prev;
+    }
+  }
+
+  // out[i] = base + the first i+1 gaps
+  static void UnpackBlock(const uint8_t *in, int bits, uint32_t base,
+                          uint32_t *out) {
+#if defined(__SSE2__)
+    const __m128i *words = reinterpret_cast<const __m128i*>(in);
+    const __m128i mask = _mm_set1_epi32(
+        bits == 32 ? 0xffffffffu : (1u << bits) - 1);
+    __m128i prev = _mm_set1_epi32(base);
+    for (int j=0; j < kBlockSize / 4; j++) {
+      const int bit = j * bits, k = bit >> 5, s = bit & 31;
+      __m128i v = _mm_setzero_si128();
+      if (bits != 0) {
+        v = _mm_srl_epi32(_mm_loadu_si128(words + k), _mm_cvtsi32_si128(s));
+        if (s + bits > 32)
+          v = _mm_or_si128(v, _mm_sll_epi32(_mm_loadu_si128(words + k + 1),
+                                            _mm_cvtsi32_si128(32 - s)));
+        v = _mm_and_si128(v, mask);
+      }
+      v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+      v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+      v = _mm_add_epi32(v, prev);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4*j), v);
+      prev = _mm_shuffle_epi32(v, 0xff);
+    }
+#elif defined(__ARM_NEON)
+    const uint32x4_t mask = vdupq_n_u32(
+        bits == 32 ? 0xffffffffu : (1u << bits) - 1);
+    const uint32x4_t zero = vdupq_n_u32(0);
+    uint32x4_t prev = vdupq_n_u32(base);
+    for (int j=0; j < kBlockSize / 4; j++) {
+      const int bit = j * bits, k = bit >> 5, s = bit & 31;
+      uint32x4_t v = zero;
+      if (bits != 0) {
+        v = vshlq_u32(vreinterpretq_u32_u8(vld1q_u8(in + 16*k)),
+                      vdupq_n_s32(-s));
+        if (s + bits > 32)
+          v = vorrq_u32(v, vshlq_u32(
+                               vreinterpretq_u32_u8(vld1q_u8(in + 16*(k+1))),
+                               vdupq_n_s32(32 - s)));
+        v = vandq_u32(v, mask);
+      }
+      v = vaddq_u32(v, vextq_u32(zero, v, 3));
+      v = vaddq_u32(v, vextq_u32(zero, v, 2));
+      v = vaddq_u32(v, prev);
+      vst1q_u32(out + 4*j, v);
+      prev = vdupq_n_u32(vgetq_lane_u32(v, 3));
+    }
+#else
+    uint32_t words[kBlockSize];
+    std::memcpy(words, in, BlockBytes(bits));
+    const uint64_t mask = (1ULL << bits) - 1;
+    uint32_t prev = base;
+    for (int j=0; j < kBlockSize / 4; j++) {
+      const int bit = j * bits, k = bit >> 5, s = bit & 31;
+      for (int l=0; l < 4; l++) {
+        uint64_t v = 0;
+        if (bits != 0) {
+          v = words[4*k + l] >> s;
+          if (s + bits > 32)
+            v |= static_cast<uint64_t>(words[4*(k+1) + l]) << (32 - s);
+        }
+        prev += static_cast<uint32_t>(v & mask);
+        out[4*j + l] = prev;
+      }
+    }
+#endif
+  }
+};
+
+
+template <typename NodeID_>
+class CompressedGraph {
+  static_assert(sizeof(NodeID_) == sizeof(uint32_t),
+                "compressed graphs hold 32-bit vertex IDs");
+
+ public:
+  static bool IsCompressedGraphFile(const std::string &filename) {
+    const std::string suffix = ".csg";
+    return filename.size() > suffix.size() &&
+        filename.compare(filename.size() - suffix.size(), suffix.size(),
+                         suffix) == 0;
+  }
+
+  template <bool invert>
+  explicit CompressedGraph(const CSRGraph<NodeID_, NodeID_, invert> &g) {
+    Timer t;
+    t.Start();
+    header_ = {};
+    std::memcpy(header_.magic, CompressedGraphHeader::kMagic, 8);
+    header_.directed = g.directed();
+    header_.num_nodes = g.num_nodes();
+    header_.num_edges_directed = g.num_edges_directed();
+    Compress(g.num_nodes(), [&g] (NodeID_ u) { return g.out_neigh(u); },
+             &out_offsets_, &out_bytes_);
+    header_.out_bytes = out_offsets_[num_nodes()];
+    if (g.directed()) {
+      Compress(g.num_nodes(), [&g] (NodeID_ u) { return g.in_neigh(u); },
+               &in_offsets_, &in_bytes_);
+      header_.in_bytes = in_offsets_[num_nodes()];
+    }
+    t.Stop();
+    PrintTime("Compress Time", t.Seconds());
+  }
+
+  explicit CompressedGraph(const std::string &filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-6);
+    }
+    Timer t;
+    t.Start();
+    file.read(reinterpret_cast<char*>(&header_), sizeof(header_));
+    if (!file || std::memcmp(header_.magic, CompressedGraphHeader::kMagic,
+                             8) != 0) {
+      std::cout << filename << " is not a compressed graph (.csg)"
+                << std::endl;
+      std::exit(-5);
+    }
+    bool ok = ReadDirection(file, header_.out_bytes, &out_offsets_,
+                            &out_bytes_);
+    if (header_.directed)
+      ok = ok && ReadDirection(file, header_.in_bytes, &in_offsets_,
+                               &in_bytes_);
+    if (!ok) {
+      std::cout << "Compressed graph " << filename << " is truncated"
+                << std::endl;
+      std::exit(-5);
+    }
+    t.Stop();
+    PrintTime("Read Time", t.Seconds());
+  }
+
+  void Write(std::fstream &out) const {
+    out.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    WriteDirection(out, out_offsets_, out_bytes_);
+    if (directed())
+      WriteDirection(out, in_offsets_, in_bytes_);
+  }
+
+  bool directed() const { return header_.directed; }
+  int64_t num_nodes() const { return header_.num_nodes; }
+  int64_t num_edges_directed() const { return header_.num_edges_directed; }
+
+  int64_t out_degree(NodeID_ v) const {
+    return NeighborCodec::Degree(out_bytes_.data() + out_offsets_[v]);
+  }
+  int64_t in_degree(NodeID_ v) const {
+    if (!directed())
+      return out_degree(v);
+    return NeighborCodec::Degree(in_bytes_.data() + in_offsets_[v]);
+  }
+
+  // Writes the out-neighbors of v to out (room for out_degree(v)); returns
+  // how many
+  int64_t DecodeOutNeigh(NodeID_ v, NodeID_ *out) const {
+    return NeighborCodec::Decode(out_bytes_.data() + out_offsets_[v],
+                                 reinterpret_cast<uint32_t*>(out));
+  }
+  int64_t DecodeInNeigh(NodeID_ v, NodeID_ *out) const {
+    if (!directed())
+      return DecodeOutNeigh(v, out);
+    return NeighborCodec::Decode(in_bytes_.data() + in_offsets_[v],
+                                 reinterpret_cast<uint32_t*>(out));
+  }
+
+  template <bool invert = true>
+  CSRGraph<NodeID_, NodeID_, invert> Decode() const {
+    Timer t;
+    t.Start();
+    NodeID_ *neighs = nullptr, *inv_neighs = nullptr;
+    NodeID_ **index = DecodeDirection(out_offsets_, out_bytes_, &neighs);
+    CSRGraph<NodeID_, NodeID_, invert> g;
+    if (directed()) {
+      NodeID_ **inv_index = nullptr;
+      if (invert)
+        inv_index = DecodeDirection(in_offsets_, in_bytes_, &inv_neighs);
+      g = CSRGraph<NodeID_, NodeID_, invert>(num_nodes(), index, neighs,
+                                             inv_index, inv_neighs);
+    } else {
+      g = CSRGraph<NodeID_, NodeID_, invert>(num_nodes(), index, neighs);
+    }
+    t.Stop();
+    PrintTime("Decode Time", t.Seconds());
+    return g;
+  }
+
+  void PrintStats() const {
+    const uint64_t raw = num_edges_directed() * sizeof(NodeID_) *
+                         (directed() ? 2 : 1);
+    const uint64_t packed = header_.out_bytes + header_.in_bytes;
+    std::cout << "Compressed neighbors: " << packed << " bytes for " << raw
+              << " raw (" << (raw == 0 ? 0.0 : 100.0 * packed / raw) << "%)"
+              << std::endl;
+  }
+
+ private:
+  CompressedGraphHeader header_;
+  pvector<uint64_t> out_offsets_;
+  pvector<uint8_t> out_bytes_;
+  pvector<uint64_t> in_offsets_;
+  pvector<uint8_t> in_bytes_;
+
+  // Exclusive prefix sum of values[0..n) into values[0..n]
+  static void PrefixSum(pvector<uint64_t> &values) {
+    const size_t n = values.size() - 1;
+    const size_t block_size = 1 << 16;
+    const size_t num_blocks = (n + block_size - 1) / block_size;
+    pvector<uint64_t> block_sums(num_blocks + 1);
+    #pragma omp parallel for
+    for (size_t b=0; b < num_blocks; b++) {
+      uint64_t sum = 0;
+      for (size_t i=b*block_size; i < std::min(n, (b+1)*block_size); i++)
+        sum += values[i];
+      block_sums[b] = sum;
+    }
+    uint64_t total = 0;
+    for (size_t b=0; b < num_blocks; b++) {
+      uint64_t sum = block_sums[b];
+      block_sums[b] = total;
+      total += sum;
+    }
+    #pragma omp parallel for
+    for (size_t b=0; b < num_blocks; b++) {
+      uint64_t sum = block_sums[b];
+      for (size_t i=b*block_size; i < std::min(n, (b+1)*block_size); i++) {
+        uint64_t value = values[i];
+        values[i] = sum;
+        sum += value;
+      }
+    }
+    values[n] = total;
+  }
+
+  // num_bytes plus the zeroed bytes Decode may read past the end
+  static pvector<uint8_t> Padded(uint64_t num_bytes) {
+    pvector<uint8_t> bytes(num_bytes + NeighborCodec::kPadding);
+    std::fill(bytes.begin() + num_bytes, bytes.end(), 0);
+    return bytes;
+  }
+
+  // Encodes every neighborhood twice: once to size it, once in place
+  template <typename NeighFunc>
+  static void Compress(int64_t num_nodes, NeighFunc neigh,
+                       pvector<uint64_t> *offsets, pvector<uint8_t> *bytes) {
+    *offsets = pvector<uint64_t>(num_nodes + 1);
+    #pragma omp parallel
+    {
+      std::vector<uint32_t> sorted;
+      std::vector<uint8_t> scratch;
+      #pragma omp for schedule(dynamic, 1024)
+      for (NodeID_ u=0; u < num_nodes; u++) {
+        int64_t degree = SortedNeighbors(neigh(u), &sorted);
+        scratch.resize(NeighborCodec::MaxBytes(degree));
+        (*offsets)[u] = NeighborCodec::Encode(sorted.data(), degree,
+                                              scratch.data()) - scratch.data();
+      }
+      #pragma omp single
+      {
+        PrefixSum(*offsets);
+        *bytes = Padded((*offsets)[num_nodes]);
+      }
+      #pragma omp for schedule(dynamic, 1024)
+      for (NodeID_ u=0; u < num_nodes; u++) {
+        int64_t degree = SortedNeighbors(neigh(u), &sorted);
+        NeighborCodec::Encode(sorted.data(), degree,
+                              bytes->data() + (*offsets)[u]);
+      }
+    }
+  }
+
+  template <typename Neighborhood>
+  static int64_t SortedNeighbors(Neighborhood n, std::vector<uint32_t> *out) {
+    out->assign(n.begin(), n.end());
+    if (!std::is_sorted(out->begin(), out->end()))
+      std::sort(out->begin(), out->end());
+    return out->size();
+  }
+
+  NodeID_** DecodeDirection(const pvector<uint64_t> &offsets,
+                            const pvector<uint8_t> &bytes,
+                            NodeID_ **neighs) const {
+    const int64_t n = num_nodes();
+    pvector<uint64_t> edge_offsets(n + 1);
+    #pragma omp parallel for
+    for (NodeID_ u=0; u < n; u++)
+      edge_offsets[u] = NeighborCodec::Degree(bytes.data() + offsets[u]);
+    PrefixSum(edge_offsets);
+    *neighs = new NodeID_[edge_offsets[n]];
+    pvector<SGOffset> csr_offsets(n + 1);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ u=0; u < n; u++) {
+      csr_offsets[u] = edge_offsets[u];
+      NeighborCodec::Decode(bytes.data() + offsets[u],
+                            reinterpret_cast<uint32_t*>(*neighs) +
+                                edge_offsets[u]);
+    }
+    csr_offsets[n] = edge_offsets[n];
+    return CSRGraph<NodeID_, NodeID_>::GenIndex(csr_offsets, *neighs);
+  }
+
+  bool ReadDirection(std::ifstream &file, uint64_t num_bytes,
+                     pvector<uint64_t> *offsets,
+                     pvector<uint8_t> *bytes) const {
+    *offsets = pvector<uint64_t>(num_nodes() + 1);
+    *bytes = Padded(num_bytes);
+    file.read(reinterpret_cast<char*>(offsets->data()),
+              offsets->size() * sizeof(uint64_t));
+    file.read(reinterpret_cast<char*>(bytes->data()), num_bytes);
+    return static_cast<bool>(file);
+  }
+
+  static void WriteDirection(std::fstream &out,
+                             const pvector<uint64_t> &offsets,
+                             const pvector<uint8_t> &bytes) {
+    out.write(reinterpret_cast<const char*>(offsets.data()),
+              offsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              offsets[offsets.size() - 1]);
+  }
+};
+
+#endif  // COMPRESSED_GRAPH_H_
@@ -0,0 +1,569 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef DYNAMIC_GRAPH_H_
+#define DYNAMIC_GRAPH_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bitmap.h"
+#include "builder.h"
+#include "graph.h"
+#include "pickle_job.h"
+#include "pvector.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  DynamicGraph
+
+Graph that takes batches of edge insertions and deletions without being
+rebuilt
+ - A base CSRGraph plus, per direction, a delta CSR of the edges added
+   since (its own index and neighbor arrays) and a tombstone bitmap over the
+   base's neighbor array marking the edges deleted since
+ - ApplyBatch() applies a batch in parallel, one thread per source vertex
+   touched, then rebuilds the delta CSR into fresh arrays: O(vertices +
+   delta edges + batch) instead of the O(edges) of rebuilding the graph.
+   Inserting an edge already present and deleting one that is not are
+   no-ops, and self loops are dropped like the builder drops them; an
+   undirected graph stores both orientations of every edge
+ - out_neigh / in_neigh walk the live base edges, then the delta edges; the
+   tombstones are only consulted once something has been deleted
+ - The device sees the base arrays through the usual CSR descriptors and
+   the delta arrays through getOutDelta* / getInDelta*, so a job shaped
+   PickleOutDeltaChain or PickleInDeltaChain (pickle_job_shape.h) prefetches
+   both, as pr does with -d. Batches and compaction move the arrays:
+   version() changes whenever a descriptor does, and a kernel re-sets its
+   job (PickleStaticJob::setGraph) and sends it again when it sees a new
+   version
+ - StartCompaction() builds, on a thread of its own, a base graph holding
+   every live edge (each neighborhood sorted) from a snapshot; batches keep
+   being applied meanwhile and are replayed on the new base when
+   FinishCompaction() installs it. CompactionDone() tells whether that will
+   have to wait
+ - ApplyBatch() and FinishCompaction() must not overlap a traversal;
+   traversals and batches may overlap a compaction
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          bool MakeInverse = true>
+class DynamicGraph {
+  typedef CSRGraph<NodeID_, DestID_, MakeInverse> CSRGraphT;
+  typedef BuilderBase<NodeID_, DestID_, NodeID_, MakeInverse> BuilderT;
+
+ public:
+  typedef EdgePair<NodeID_, DestID_> Edge;
+  typedef pvector<Edge> EdgeList;
+
+  // Edges added to one direction since the base was built, as a CSR whose
+  // index holds pointers into its own neighbor array
+  struct DeltaLists {
+    pvector<DestID_*> index;
+    pvector<DestID_> neighbors;
+
+    DeltaLists(int64_t num_nodes, int64_t num_neighbors) :
+        index(num_nodes + 1), neighbors(num_neighbors) {
+      neighbors.indexedBy(index.getArrayDescriptor());
+    }
+
+    int64_t degree(NodeID_ v) const { return index[v+1] - index[v]; }
+  };
+
+  class Neighborhood {
+   public:
+    class iterator {
+     public:
+      iterator(DestID_ *p, DestID_ *base_end, DestID_ *delta_begin,
+               const DestID_ *base_start, const Bitmap *deleted) :
+          p_(p), base_end_(base_end), delta_begin_(delta_begin),
+          base_start_(base_start), deleted_(deleted) {
+        Settle();
+      }
+      const DestID_& operator*() const { return *p_; }
+      iterator& operator++() {
+        ++p_;
+        Settle();
+        return *this;
+      }
+      bool operator==(const iterator &rhs) const { return p_ == rhs.p_; }
+      bool operator!=(const iterator &rhs) const { return p_ != rhs.p_; }
+
+     private:
+      DestID_ *p_, *base_end_, *delta_begin_;
+      const DestID_ *base_start_;
+      const Bitmap *deleted_;
+
+      // Skips deleted base edges and steps from the base list to the delta
+      void Settle() {
+        if (base_end_ == nullptr)
+          return;
+        if (deleted_ != nullptr) {
+          while (p_ != base_end_ && deleted_->get_bit(p_ - base_start_))
+            ++p_;
+        }
+        if (p_ == base_end_) {
+          p_ = delta_begin_;
+          base_end_ = nullptr;
+        }
+      }
+    };
+
+    Neighborhood(DestID_ *base_begin, DestID_ *base_end,
+                 DestID_ *delta_begin, DestID_ *delta_end,
+                 const DestID_ *base_start, const Bitmap *deleted) :
+        base_begin_(base_begin), base_end_(base_end),
+        delta_begin_(delta_begin), delta_end_(delta_end),
+        base_start_(base_start), deleted_(deleted) {}
+
+    iterator begin() const {
+      return iterator(base_begin_, base_end_, delta_begin_, base_start_,
+                      deleted_);
+    }
+    iterator end() const {
+      return iterator(delta_end_, nullptr, delta_end_, base_start_,
+                      deleted_);
+    }
+
+   private:
+    DestID_ *base_begin_, *base_end_, *delta_begin_, *delta_end_;
+    const DestID_ *base_start_;
+    const Bitmap *deleted_;
+  };
+
+  explicit DynamicGraph(CSRGraphT &&base) :
+      base_(std::make_shared<CSRGraphT>(std::move(base))),
+      compacting_(false), version_(0) {
+    Reset();
+  }
+
+  bool directed() const { return base_->directed(); }
+  int64_t num_nodes() const { return base_->num_nodes(); }
+
+  int64_t num_edges_directed() const {
+    return base_->num_edges_directed() - out_.num_deleted +
+           out_.delta->neighbors.size();
+  }
+  int64_t num_edges() const {
+    return directed() ? num_edges_directed() : num_edges_directed() / 2;
+  }
+
+  int64_t out_degree(NodeID_ v) const {
+    return base_->out_degree(v) - out_.deleted_degree[v] +
+           out_.delta->degree(v);
+  }
+  int64_t in_degree(NodeID_ v) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    if (!directed())
+      return out_degree(v);
+    return base_->in_degree(v) - in_.deleted_degree[v] +
+           in_.delta->degree(v);
+  }
+
+  Neighborhood out_neigh(NodeID_ v) const {
+    return NeighborhoodOf(out_, v);
+  }
+  Neighborhood in_neigh(NodeID_ v) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return NeighborhoodOf(directed() ? in_ : out_, v);
+  }
+
+  Range<NodeID_> vertices() const {
+    return Range<NodeID_>(num_nodes());
+  }
+
+  const CSRGraphT& base() const { return *base_; }
+  uint64_t version() const { return version_; }
+
+  void PrintStats() const {
+    base_->PrintStats();
+    std::cout << "Since the base: " << out_.delta->neighbors.size()
+              << " edges added and " << out_.num_deleted << " deleted"
+              << std::endl;
+  }
+
+  // Applies the deletions, then the insertions
+  void ApplyBatch(const EdgeList &inserts, const EdgeList &deletes) {
+    ApplyToDirection(&out_, base_->getOutIndexAddressRange(),
+                     base_->getOutNeighborsAddressRange(), inserts, deletes,
+                     !directed(), false);
+    if constexpr (MakeInverse) {
+      if (directed())
+        ApplyToDirection(&in_, base_->getInIndexAddressRange(),
+                         base_->getInNeighborsAddressRange(), inserts,
+                         deletes, false, true);
+    }
+    if (compacting_) {
+      pending_.emplace_back(EdgeList(inserts.begin(), inserts.end()),
+                            EdgeList(deletes.begin(), deletes.end()));
+    }
+    version_++;
+  }
+
+  void StartCompaction() {
+    if (compacting_)
+      return;
+    std::shared_ptr<Snapshot> snap = std::make_shared<Snapshot>();
+    snap->base = base_;
+    snap->out = SnapshotOf(out_);
+    if constexpr (MakeInverse) {
+      if (directed())
+        snap->in = SnapshotOf(in_);
+    }
+    compacting_ = true;
+    compaction_ = std::async(std::launch::async, [snap] {
+      return Compact(*snap);
+    });
+  }
+
+  bool CompactionDone() const {
+    return compacting_ && compaction_.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+  }
+
+  void FinishCompaction() {
+    if (!compacting_)
+      return;
+    Timer t;
+    t.Start();
+    base_ = compaction_.get();
+    compacting_ = false;
+    Reset();
+    std::vector<std::pair<EdgeList, EdgeList>> pending;
+    pending.swap(pending_);
+    for (const auto &batch : pending)
+      ApplyBatch(batch.first, batch.second);
+    version_++;
+    t.Stop();
+    PrintTime("Compaction Swap", t.Seconds());
+  }
+
+  // -------------------- Array descriptor interface --------------------
+  // The base's arrays
+  std::shared_ptr<PickleArrayDescriptor> getOutIndexArrayDescriptor() const {
+    return base_->getOutIndexArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getOutNeighborsArrayDescriptor()
+      const {
+    return base_->getOutNeighborsArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInIndexArrayDescriptor() const {
+    return base_->getInIndexArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInNeighborsArrayDescriptor()
+      const {
+    return base_->getInNeighborsArrayDescriptor();
+  }
+
+  // The delta's arrays (the out ones for an undirected graph)
+  std::shared_ptr<PickleArrayDescriptor> getOutDeltaIndexArrayDescriptor()
+      const {
+    return out_.delta->index.getArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getOutDeltaNeighborsArrayDescriptor()
+      const {
+    return out_.delta->neighbors.getArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInDeltaIndexArrayDescriptor()
+      const {
+    return (directed() ? in_ : out_).delta->index.getArrayDescriptor();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInDeltaNeighborsArrayDescriptor()
+      const {
+    return (directed() ? in_ : out_).delta->neighbors.getArrayDescriptor();
+  }
+  // -------------------------- Interface END ---------------------------
+
+ private:
+  // Changes to one direction of the base
+  struct Direction {
+    std::shared_ptr<DeltaLists> delta;
+    std::unique_ptr<Bitmap> deleted;
+    pvector<NodeID_> deleted_degree;
+    int64_t num_deleted = 0;
+  };
+
+  struct DirectionSnapshot {
+    std::shared_ptr<DeltaLists> delta;
+    std::unique_ptr<Bitmap> deleted;
+    pvector<NodeID_> deleted_degree;
+  };
+
+  struct Snapshot {
+    std::shared_ptr<CSRGraphT> base;
+    DirectionSnapshot out, in;
+  };
+
+  std::shared_ptr<CSRGraphT> base_;
+  Direction out_, in_;
+  bool base_sorted_;
+  bool compacting_;
+  std::future<std::shared_ptr<CSRGraphT>> compaction_;
+  std::vector<std::pair<EdgeList, EdgeList>> pending_;
+  uint64_t version_;
+
+  static NodeID_ IdOf(const DestID_ &d) {
+    if constexpr (std::is_same<DestID_, NodeID_>::value)
+      return d;
+    else
+      return d.v;
+  }
+
+  // d, pointing at id instead (same weight)
+  static DestID_ WithId(const DestID_ &d, NodeID_ id) {
+    if constexpr (std::is_same<DestID_, NodeID_>::value)
+      return id;
+    else
+      return DestID_(id, d.w);
+  }
+
+  static bool ById(const DestID_ &a, const DestID_ &b) {
+    return IdOf(a) < IdOf(b);
+  }
+
+  // Empty deltas and tombstones over the current base
+  void Reset() {
+    ResetDirection(&out_, base_->num_edges_directed());
+    if constexpr (MakeInverse) {
+      if (directed())
+        ResetDirection(&in_, base_->num_edges_directed());
+    }
+    base_sorted_ = Sorted(base_->getOutIndexAddressRange());
+    if constexpr (MakeInverse) {
+      if (directed())
+        base_sorted_ = base_sorted_ && Sorted(base_->getInIndexAddressRange());
+    }
+  }
+
+  bool Sorted(AddressRange index_range) const {
+    const DestID_ *const *index = reinterpret_cast<const DestID_* const*>(
+        index_range.start);
+    bool sorted = true;
+    #pragma omp parallel for reduction(&& : sorted)
+    for (NodeID_ v=0; v < num_nodes(); v++)
+      sorted = sorted && std::is_sorted(index[v], index[v+1], ById);
+    return sorted;
+  }
+
+  void ResetDirection(Direction *d, int64_t num_base_edges) {
+    d->delta = std::make_shared<DeltaLists>(num_nodes(), 0);
+    #pragma omp parallel for
+    for (NodeID_ v=0; v <= num_nodes(); v++)
+      d->delta->index[v] = d->delta->neighbors.data();
+    d->deleted.reset(new Bitmap(num_base_edges));
+    d->deleted->reset();
+    d->deleted_degree = pvector<NodeID_>(num_nodes(), 0);
+    d->num_deleted = 0;
+  }
+
+  Neighborhood NeighborhoodOf(const Direction &d, NodeID_ v) const {
+    const bool in = &d == &in_;
+    DestID_ **index = reinterpret_cast<DestID_**>(
+        in ? base_->getInIndexAddressRange().start
+           : base_->getOutIndexAddressRange().start);
+    return Neighborhood(index[v], index[v+1], d.delta->index[v],
+                        d.delta->index[v+1], index[0],
+                        d.num_deleted != 0 ? d.deleted.get() : nullptr);
+  }
+
+  DirectionSnapshot SnapshotOf(const Direction &d) const {
+    DirectionSnapshot s;
+    s.delta = d.delta;
+    s.deleted.reset(new Bitmap(d.deleted->size()));
+    s.deleted->copy_from(*d.deleted);
+    s.deleted_degree = pvector<NodeID_>(d.deleted_degree.begin(),
+                                        d.deleted_degree.end());
+    return s;
+  }
+
+  // An operation on the list of src: insert (or delete) dst
+  struct Op {
+    NodeID_ src;
+    DestID_ dst;
+    bool insert;
+  };
+
+  // Orients the batch for one direction: transpose stores (v, u) for the
+  // edge (u, v), both_ways stores both
+  static std::vector<Op> Orient(const EdgeList &inserts,
+                                const EdgeList &deletes, bool both_ways,
+                                bool transpose) {
+    std::vector<Op> ops;
+    auto add = [&ops, both_ways, transpose] (const Edge &e, bool insert) {
+      const Op forward = {e.u, e.v, insert};
+      const Op backward = {IdOf(e.v), WithId(e.v, e.u), insert};
+      if (both_ways || !transpose)
+        ops.push_back(forward);
+      if (both_ways || transpose)
+        ops.push_back(backward);
+    };
+    for (const Edge &e : deletes)
+      add(e, false);
+    for (const Edge &e : inserts) {
+      if (e.u != IdOf(e.v))
+        add(e, true);
+    }
+    std::stable_sort(ops.begin(), ops.end(), [] (const Op &a, const Op &b) {
+      return a.src < b.src;
+    });
+    return ops;
+  }
+
+  // Position of a live dst in the base list [begin, end), or end
+  const DestID_* FindInBase(const DestID_ *begin, const DestID_ *end,
+                            const DestID_ *base_start, const Direction &d,
+                            const DestID_ &dst) const {
+    auto live = [&] (const DestID_ *p) {
+      return IdOf(*p) == IdOf(dst) && !d.deleted->get_bit(p - base_start);
+    };
+    if (base_sorted_) {
+      const DestID_ *p = std::lower_bound(begin, end, dst, ById);
+      for (; p != end && IdOf(*p) == IdOf(dst); p++) {
+        if (live(p))
+          return p;
+      }
+      return end;
+    }
+    for (const DestID_ *p = begin; p != end; p++) {
+      if (live(p))
+        return p;
+    }
+    return end;
+  }
+
+  void ApplyToDirection(Direction *d, AddressRange base_index_range,
+                        AddressRange base_neighbors_range,
+                        const EdgeList &inserts, const EdgeList &deletes,
+                        bool both_ways, bool transpose) {
+    const std::vector<Op> ops = Orient(inserts, deletes, both_ways,
+                                       transpose);
+    std::vector<size_t> groups;
+    for (size_t i=0; i < ops.size(); i++) {
+      if (i == 0 || ops[i].src != ops[i-1].src)
+        groups.push_back(i);
+    }
+    groups.push_back(ops.size());
+    const int64_t num_groups = groups.size() - 1;
+    DestID_ **base_index = reinterpret_cast<DestID_**>(
+        base_index_range.start);
+    const DestID_ *base_start = reinterpret_cast<const DestID_*>(
+        base_neighbors_range.start);
+    const DeltaLists &old = *d->delta;
+    std::vector<std::vector<DestID_>> lists(num_groups);
+    int64_t newly_deleted = 0;
+    #pragma omp parallel for reduction(+ : newly_deleted) schedule(dynamic, 16)
+    for (int64_t g=0; g < num_groups; g++) {
+      const NodeID_ u = ops[groups[g]].src;
+      std::vector<DestID_> &list = lists[g];
+      list.assign(old.index[u], old.index[u+1]);
+      for (size_t i=groups[g]; i < groups[g+1]; i++) {
+        const DestID_ &dst = ops[i].dst;
+        auto in_delta = std::find_if(list.begin(), list.end(),
+            [&dst] (const DestID_ &x) { return IdOf(x) == IdOf(dst); });
+        const DestID_ *in_base = FindInBase(base_index[u], base_index[u+1],
+                                            base_start, *d, dst);
+        const bool in_base_live = in_base != base_index[u+1];
+        if (ops[i].insert) {
+          if (in_delta == list.end() && !in_base_live)
+            list.push_back(dst);
+        } else if (in_delta != list.end()) {
+          list.erase(in_delta);
+        } else if (in_base_live) {
+          d->deleted->set_bit_atomic(in_base - base_start);
+          d->deleted_degree[u]++;
+          newly_deleted++;
+        }
+      }
+    }
+    d->num_deleted += newly_deleted;
+
+    pvector<NodeID_> degrees(num_nodes());
+    #pragma omp parallel for
+    for (NodeID_ v=0; v < num_nodes(); v++)
+      degrees[v] = old.degree(v);
+    #pragma omp parallel for
+    for (int64_t g=0; g < num_groups; g++)
+      degrees[ops[groups[g]].src] = lists[g].size();
+    pvector<SGOffset> offsets = BuilderT::ParallelPrefixSum(degrees);
+    std::shared_ptr<DeltaLists> delta =
+        std::make_shared<DeltaLists>(num_nodes(), offsets[num_nodes()]);
+    #pragma omp parallel for
+    for (NodeID_ v=0; v <= num_nodes(); v++)
+      delta->index[v] = delta->neighbors.data() + offsets[v];
+    // Lists the batch touched are written from lists below; copying no more
+    // than their new degree keeps a shrunk one inside its slot meanwhile
+    #pragma omp parallel for
+    for (NodeID_ v=0; v < num_nodes(); v++)
+      std::copy(old.index[v],
+                old.index[v] + std::min<int64_t>(old.degree(v), degrees[v]),
+                delta->index[v]);
+    #pragma omp parallel for
+    for (int64_t g=0; g < num_groups; g++)
+      std::copy(lists[g].begin(), lists[g].end(),
+                delta->index[ops[groups[g]].src]);
+    d->delta = delta;
+  }
+
+  // One direction's live edges as a sorted CSR: offsets, then neighbors
+  static std::pair<pvector<SGOffset>, DestID_*> CompactDirection(
+      const DirectionSnapshot &s, DestID_ **base_index, int64_t num_nodes) {
+    pvector<NodeID_> degrees(num_nodes);
+    #pragma omp parallel for
+    for (NodeID_ v=0; v < num_nodes; v++)
+      degrees[v] = (base_index[v+1] - base_index[v]) - s.deleted_degree[v] +
+                   s.delta->degree(v);
+    pvector<SGOffset> offsets = BuilderT::ParallelPrefixSum(degrees);
+    DestID_ *neighs = new DestID_[offsets[num_nodes]];
+    const DestID_ *base_start = base_index[0];
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ v=0; v < num_nodes; v++) {
+      DestID_ *out = neighs + offsets[v];
+      for (const DestID_ *p = base_index[v]; p < base_index[v+1]; p++) {
+        if (s.deleted_degree[v] == 0 || !s.deleted->get_bit(p - base_start))
+          *out++ = *p;
+      }
+      out = std::copy(s.delta->index[v], s.delta->index[v+1], out);
+      std::sort(neighs + offsets[v], out);
+    }
+    return std::make_pair(std::move(offsets), neighs);
+  }
+
+  static std::shared_ptr<CSRGraphT> Compact(const Snapshot &snap) {
+    Timer t;
+    t.Start();
+    const CSRGraphT &base = *snap.base;
+    const int64_t n = base.num_nodes();
+    auto out = CompactDirection(snap.out, reinterpret_cast<DestID_**>(
+        base.getOutIndexAddressRange().start), n);
+    DestID_ **out_index = CSRGraphT::GenIndex(out.first, out.second);
+    std::shared_ptr<CSRGraphT> g;
+    if (!base.directed()) {
+      g = std::make_shared<CSRGraphT>(n, out_index, out.second);
+    } else if constexpr (MakeInverse) {
+      auto in = CompactDirection(snap.in, reinterpret_cast<DestID_**>(
+          base.getInIndexAddressRange().start), n);
+      DestID_ **in_index = CSRGraphT::GenIndex(in.first, in.second);
+      g = std::make_shared<CSRGraphT>(n, out_index, out.second, in_index,
+                                      in.second);
+    } else {
+      g = std::make_shared<CSRGraphT>(n, out_index, out.second, nullptr,
+                                      nullptr);
+    }
+    t.Stop();
+    PrintTime("Compaction Time", t.Seconds());
+    return g;
+  }
+};
+
+#endif  // DYNAMIC_GRAPH_H_
@@ -0,0 +1,179 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "pvector.h"
+#include "graph.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  Generator
+Author: Scott Beamer
+
+Given scale and degree, generates edgelist for synthetic graph
+ - Intended to be called from Builder
+ - GenerateEL(uniform) generates and returns the edgelist
+ - Can generate uniform random (uniform=true) or R-MAT/Kronecker graph
+   according to Graph500 parameters (uniform=false)
+ - Edges are generated in fixed-size blocks and every block seeds its own
+   RNG stream from kRandSeed and the block number, so the output is
+   deterministic regardless of the number of threads
+ - Weighted graphs (DestID_ = NodeWeight) get weights in [1, 255] from
+   InsertWeights(), generated the same way
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          typename WeightT_ = NodeID_>
+class Generator {
+  typedef EdgePair<NodeID_, DestID_> Edge;
+  typedef EdgePair<NodeID_, NodeWeight<NodeID_, WeightT_>> WEdge;
+  typedef pvector<Edge> EdgeList;
+
+  // Each block of edges draws from its own stream
+  static const int64_t block_size = 1<<18;
+
+  // Maps 64 random bits to [0, range) without division (Lemire)
+  static uint64_t Bounded(uint64_t bits, uint64_t range) {
+    return static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(bits) * range) >> 64);
+  }
+
+  // SplitMix64 stream: a few ALU ops per draw, so generation is bound by
+  // writing the edge list rather than by the RNG (mt19937 is ~10x slower)
+  class BlockRNG {
+    uint64_t state_;
+   public:
+    explicit BlockRNG(int64_t block, int64_t stream = 0)
+        : state_(static_cast<uint64_t>(kRandSeed) ^
+                 (static_cast<uint64_t>(block) << 8) ^
+                 static_cast<uint64_t>(stream)) {}
+    uint64_t operator()() {
+      uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      return z ^ (z >> 31);
+    }
+  };
+
+ public:
+  Generator(int scale, int degree) {
+    scale_ = scale;
+    num_nodes_ = 1l << scale;
+    num_edges_ = num_nodes_ * degree;
+    if (num_nodes_ > std::numeric_limits<NodeID_>::max()) {
+      std::cout << "NodeID type (max: " << std::numeric_limits<NodeID_>::max();
+      std::cout << ") too small to hold " << num_nodes_ << std::endl;
+      std::cout << "Recommend changing NodeID (typedef'd in src/benchmark.h)";
+      std::cout << " to a wider type and recompiling" << std::endl;
+      std::exit(-31);
+    }
+  }
+
+  void PermuteIDs(EdgeList &el) {
+    pvector<NodeID_> permutation(num_nodes_);
+    std::mt19937 rng(kRandSeed);
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < num_nodes_; n++)
+      permutation[n] = n;
+    std::shuffle(permutation.begin(), permutation.end(), rng);
+    #pragma omp parallel for
+    for (int64_t e=0; e < num_edges_; e++)
+      el[e] = Edge(permutation[el[e].u], permutation[el[e].v]);
+  }
+
+  EdgeList MakeUniformEL() {
+    EdgeList el(num_edges_);
+    const int64_t num_blocks = (num_edges_ + block_size - 1) / block_size;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block=0; block < num_blocks; block++) {
+      BlockRNG rng(block);
+      int64_t block_end = std::min(num_edges_, (block+1) * block_size);
+      for (int64_t e=block*block_size; e < block_end; e++) {
+        NodeID_ u = static_cast<NodeID_>(Bounded(rng(), num_nodes_));
+        NodeID_ v = static_cast<NodeID_>(Bounded(rng(), num_nodes_));
+        el[e] = Edge(u, v);
+      }
+    }
+    return el;
+  }
+
+  EdgeList MakeRMatEL() {
+    // Graph500 initiator probabilities, in units of 2^-16
+    const uint64_t A = 0.57 * 65536.0;
+    const uint64_t B = 0.19 * 65536.0;
+    const uint64_t C = 0.19 * 65536.0;
+    EdgeList el(num_edges_);
+    const int64_t num_blocks = (num_edges_ + block_size - 1) / block_size;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block=0; block < num_blocks; block++) {
+      BlockRNG rng(block);
+      int64_t block_end = std::min(num_edges_, (block+1) * block_size);
+      for (int64_t e=block*block_size; e < block_end; e++) {
+        NodeID_ src = 0, dst = 0;
+        uint64_t bits = 0;
+        for (int depth=0; depth < scale_; depth++) {
+          // four 16-bit draws per 64-bit RNG call
+          if ((depth & 3) == 0)
+            bits = rng();
+          uint64_t rand_point = bits & 0xFFFF;
+          bits >>= 16;
+          // branch-free quadrant choice since the draws are unpredictable:
+          // a = [0,A], b = (A,A+B), c = [A+B,A+B+C], d = (A+B+C,1)
+          NodeID_ src_bit = rand_point >= A+B;
+          NodeID_ dst_bit = (rand_point > A) ^ src_bit ^ (rand_point > A+B+C);
+          src = (src << 1) | src_bit;
+          dst = (dst << 1) | dst_bit;
+        }
+        el[e] = Edge(src, dst);
+      }
+    }
+    PermuteIDs(el);
+    return el;
+  }
+
+  EdgeList GenerateEL(bool uniform) {
+    EdgeList el;
+    Timer t;
+    t.Start();
+    if (uniform)
+      el = MakeUniformEL();
+    else
+      el = MakeRMatEL();
+    t.Stop();
+    PrintTime("Generate Time", t.Seconds());
+    return el;
+  }
+
+  static void InsertWeights(pvector<EdgePair<NodeID_, NodeID_>> &el) {}
+
+  // Overwrites existing weights with random from [1,255]
+  static void InsertWeights(pvector<WEdge> &el) {
+    const int64_t num_edges = el.size();
+    const int64_t num_blocks = (num_edges + block_size - 1) / block_size;
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block=0; block < num_blocks; block++) {
+      BlockRNG rng(block, 1);
+      int64_t block_end = std::min(num_edges, (block+1) * block_size);
+      for (int64_t e=block*block_size; e < block_end; e++)
+        el[e].v.w = static_cast<WeightT_>(1 + Bounded(rng(), 255));
+    }
+  }
+
+ private:
+  int scale_;
+  int64_t num_nodes_;
+  int64_t num_edges_;
+};
+
+#endif  // GENERATOR_H_
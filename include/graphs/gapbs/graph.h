@@ -7,13 +7,19 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include "pvector.h"
 #include "util.h"
 #include "pickle_job.h"
 
+#if PICKLE_TRACE_ACCESSES==1
+#include "access_recorder.h"
+#endif
+
 #include <iostream>
 
 /*
@@ -25,6 +31,12 @@ Simple container for graph in CSR format
  - Intended to be constructed by a Builder
  - To make weighted, set DestID_ template type to NodeWeight
  - MakeInverse parameter controls whether graph stores its inverse
+ - Owns its arrays (delete[] on release) unless constructed with a storage
+   handle, e.g. a segment shared by several processes (shared_graph.h); the
+   arrays then live as long as the handle
+ - With PICKLE_TRACE_ACCESSES=1, out_neigh/in_neigh report the two index
+   entries bounding the list and Neighborhood iterators the neighbors they read to the
+   AccessRecorder (access_recorder.h)
 */
 
 // Used to hold node & weight, with another node it makes a weighted edge
@@ -106,28 +118,44 @@ class CSRGraph {
     NodeID_ n_;
     DestID_** g_index_;
     OffsetT start_offset_;
+    const PickleArrayDescriptor *neighbors_;
    public:
-    Neighborhood(NodeID_ n, DestID_** g_index, OffsetT start_offset) :
-        n_(n), g_index_(g_index), start_offset_(0) {
+    Neighborhood(NodeID_ n, DestID_** g_index, OffsetT start_offset,
+                 const PickleArrayDescriptor *neighbors = nullptr) :
+        n_(n), g_index_(g_index), start_offset_(0), neighbors_(neighbors) {
       OffsetT max_offset = end() - begin();
       start_offset_ = std::min(start_offset, max_offset);
 //      std::cout << "Neighborhood idx 0 " << std::hex << g_index_[0] << std::dec << "\n";
     }
+#if PICKLE_TRACE_ACCESSES==1
+    typedef TracedIterator<DestID_> iterator;
+    iterator begin() {
+      return iterator(g_index_[n_] + start_offset_, g_index_[0], neighbors_);
+    }
+    iterator end() {
+      return iterator(g_index_[n_+1], g_index_[0], neighbors_);
+    }
+#else
     typedef DestID_* iterator;
     iterator begin() { return g_index_[n_] + start_offset_; }
     iterator end()   { return g_index_[n_+1]; }
+#endif
   };
 
   void ReleaseResources() {
-    if (out_index_ != nullptr)
-      delete[] out_index_;
-    if (out_neighbors_ != nullptr)
-      delete[] out_neighbors_;
-    if (directed_) {
-      if (in_index_ != nullptr)
-        delete[] in_index_;
-      if (in_neighbors_ != nullptr)
-        delete[] in_neighbors_;
+    if (storage_ != nullptr) {
+      storage_.reset();
+    } else {
+      if (out_index_ != nullptr)
+        delete[] out_index_;
+      if (out_neighbors_ != nullptr)
+        delete[] out_neighbors_;
+      if (directed_) {
+        if (in_index_ != nullptr)
+          delete[] in_index_;
+        if (in_neighbors_ != nullptr)
+          delete[] in_neighbors_;
+      }
     }
     in_index_array_descriptor = nullptr;
     out_index_array_descriptor = nullptr;
@@ -177,19 +205,22 @@ class CSRGraph {
     out_index_(nullptr), out_neighbors_(nullptr),
     in_index_(nullptr), in_neighbors_(nullptr) {}
 
-  CSRGraph(int64_t num_nodes, DestID_** index, DestID_* neighs) :
+  CSRGraph(int64_t num_nodes, DestID_** index, DestID_* neighs,
+           std::shared_ptr<void> storage = nullptr) :
     directed_(false), num_nodes_(num_nodes),
     out_index_(index), out_neighbors_(neighs),
-    in_index_(index), in_neighbors_(neighs) {
+    in_index_(index), in_neighbors_(neighs), storage_(std::move(storage)) {
       num_edges_ = (out_index_[num_nodes_] - out_index_[0]) / 2;
       constructArrayDescriptors();
     }
 
   CSRGraph(int64_t num_nodes, DestID_** out_index, DestID_* out_neighs,
-        DestID_** in_index, DestID_* in_neighs) :
+        DestID_** in_index, DestID_* in_neighs,
+        std::shared_ptr<void> storage = nullptr) :
     directed_(true), num_nodes_(num_nodes),
     out_index_(out_index), out_neighbors_(out_neighs),
-    in_index_(in_index), in_neighbors_(in_neighs) {
+    in_index_(in_index), in_neighbors_(in_neighs),
+    storage_(std::move(storage)) {
       num_edges_ = out_index_[num_nodes_] - out_index_[0];
       constructArrayDescriptors();
 //      std::cout << "ctor CSRGraph out_index_[0] " << std::hex << out_index_[0] << std::dec << "\n";
@@ -199,6 +230,7 @@ class CSRGraph {
     num_nodes_(other.num_nodes_), num_edges_(other.num_edges_),
     out_index_(other.out_index_), out_neighbors_(other.out_neighbors_),
     in_index_(other.in_index_), in_neighbors_(other.in_neighbors_),
+    storage_(std::move(other.storage_)),
     in_index_array_descriptor(other.in_index_array_descriptor),
     out_index_array_descriptor(other.out_index_array_descriptor),
     in_neighbors_array_descriptor(other.in_neighbors_array_descriptor),
@@ -225,6 +257,7 @@ class CSRGraph {
       out_neighbors_ = other.out_neighbors_;
       in_index_ = other.in_index_;
       in_neighbors_ = other.in_neighbors_;
+      storage_ = std::move(other.storage_);
       in_index_array_descriptor = other.in_index_array_descriptor;
       out_index_array_descriptor = other.out_index_array_descriptor;
       in_neighbors_array_descriptor = other.in_neighbors_array_descriptor;
@@ -268,13 +301,37 @@ class CSRGraph {
     return in_index_[v+1] - in_index_[v];
   }
 
+  // Position of v's first neighbor in the neighbor array
+  SGOffset out_offset(NodeID_ v) const {
+    return out_index_[v] - out_index_[0];
+  }
+
+  SGOffset in_offset(NodeID_ v) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return in_index_[v] - in_index_[0];
+  }
+
   Neighborhood out_neigh(NodeID_ n, OffsetT start_offset = 0) const {
-    return Neighborhood(n, out_index_, start_offset);
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().Load(out_index_array_descriptor.get(), n,
+                               out_index_ + n);
+    AccessRecorder::Get().Load(out_index_array_descriptor.get(), n + 1,
+                               out_index_ + n + 1);
+#endif
+    return Neighborhood(n, out_index_, start_offset,
+                        out_neighbors_array_descriptor.get());
   }
 
   Neighborhood in_neigh(NodeID_ n, OffsetT start_offset = 0) const {
     static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
-    return Neighborhood(n, in_index_, start_offset);
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().Load(in_index_array_descriptor.get(), n,
+                               in_index_ + n);
+    AccessRecorder::Get().Load(in_index_array_descriptor.get(), n + 1,
+                               in_index_ + n + 1);
+#endif
+    return Neighborhood(n, in_index_, start_offset,
+                        in_neighbors_array_descriptor.get());
   }
 
   void PrintStats() const {
@@ -348,7 +405,7 @@ class CSRGraph {
   }
 
   AddressRange getOutNeighborsAddressRange() const {
-      return AddressRange((uint64_t)out_neighbors_, (uint64_t)(out_neighbors_ + num_edges_));
+      return AddressRange((uint64_t)out_neighbors_, (uint64_t)(out_neighbors_ + num_edges_directed()));
   }
   uint64_t getOutNeighborsElementSize() const {
       return sizeof(DestID_);
@@ -361,7 +418,7 @@ class CSRGraph {
   }
 
   AddressRange getInNeighborsAddressRange() const {
-      return AddressRange((uint64_t)in_neighbors_, (uint64_t)(in_neighbors_ + num_edges_));
+      return AddressRange((uint64_t)in_neighbors_, (uint64_t)(in_neighbors_ + num_edges_directed()));
   }
   uint64_t getInNeighborsElementSize() const {
       return sizeof(DestID_);
@@ -435,6 +492,8 @@ class CSRGraph {
   DestID_*  out_neighbors_;
   DestID_** in_index_;
   DestID_*  in_neighbors_;
+  // Keeps arrays the graph does not own alive (nullptr when it owns them)
+  std::shared_ptr<void> storage_;
   // Array Descriptor
   std::shared_ptr<PickleArrayDescriptor> in_index_array_descriptor;
   std::shared_ptr<PickleArrayDescriptor> out_index_array_descriptor;
@@ -0,0 +1,158 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef MS_BFS_H_
+#define MS_BFS_H_
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "graph.h"
+#include "pickle_job.h"
+#include "pvector.h"
+#include "wrapper.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  MultiSourceBFS
+
+Bit-parallel breadth-first search from many sources at once (MS-BFS [1])
+ - Source i of a batch owns bit i%64 of word i/64 in every per-vertex bitset,
+   so one pass over a neighbor list advances every search that reached it
+ - Each vertex keeps W = ceil(sources/64) words of visit (reached at the
+   current depth) and an interleaved pair of W-word seen/next bitsets in one
+   row of state, so the two bitsets touched per edge share cache lines
+ - A level pushes visit[u] & ~seen[v] into next[v] along every out edge,
+   then a commit pass folds next into seen and makes it the new visit
+ - Run() reports each vertex the first time any search reaches it at a
+   depth, with the bits of the sources that reached it, and returns the
+   number of levels. Sources themselves are reported at depth 0.
+ - CreateJob() describes the chain out-index -> neighbors -> state rows, with
+   the row size as element size, plus the visit rows read in vertex order
+
+[1] Manuel Then, Moritz Kaufmann, Fernando Chirigati, Tuan-Anh Hoang-Vu,
+    Kien Pham, Alfons Kemper, Thomas Neumann, and Huy T. Vo. "The More the
+    Merrier: Efficient Multi-Source Graph Traversal." PVLDB 8(4), 2014.
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          bool MakeInverse = true>
+class MultiSourceBFS {
+  typedef CSRGraph<NodeID_, DestID_, MakeInverse> CGraph;
+
+ public:
+  static const int kBitsPerWord = 64;
+
+  MultiSourceBFS(const CGraph &g, size_t max_sources)
+      : g_(g), words_((max_sources + kBitsPerWord - 1) / kBitsPerWord),
+        visit_(g.num_nodes() * words_), state_(g.num_nodes() * 2 * words_) {
+    visit_.getArrayDescriptor()->element_size = words_ * sizeof(uint64_t);
+    state_.getArrayDescriptor()->element_size = 2 * words_ * sizeof(uint64_t);
+  }
+
+  size_t words() const { return words_; }
+  size_t max_sources() const { return words_ * kBitsPerWord; }
+
+  PickleJob CreateJob(const std::string &kernel_name) {
+    PickleJob job = createGraphJobUsingOutgoingEdges(&g_, kernel_name,
+                                                     nullptr, &state_);
+    job.addArrayDescriptor(visit_.getArrayDescriptor());
+    return job;
+  }
+
+  // visitor(v, depth, reached) is called concurrently; reached points to
+  // words() words with the bits of the sources that first reached v at depth
+  template <typename LevelVisitor, typename ProgressFunc>
+  int Run(const std::vector<NodeID_> &sources, LevelVisitor visitor,
+          ProgressFunc progress) {
+    if (sources.size() > max_sources()) {
+      std::cout << "MultiSourceBFS: " << sources.size()
+                << " sources exceed batch of " << max_sources() << std::endl;
+      std::exit(-30);
+    }
+    visit_.fill(0);
+    state_.fill(0);
+    for (size_t i=0; i < sources.size(); i++) {
+      uint64_t bit = uint64_t(1) << (i % kBitsPerWord);
+      visit_[sources[i] * words_ + i / kBitsPerWord] |= bit;
+      Seen(sources[i])[i / kBitsPerWord] |= bit;
+    }
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ u=0; u < g_.num_nodes(); u++) {
+      if (Any(Visit(u)))
+        visitor(u, 0, Visit(u));
+    }
+    int depth = 0;
+    bool active = !sources.empty();
+    while (active) {
+      depth++;
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (NodeID_ u=0; u < g_.num_nodes(); u++) {
+        const uint64_t *visit_u = Visit(u);
+        if (!Any(visit_u))
+          continue;
+        progress(u);
+        for (NodeID_ v : g_.out_neigh(u)) {
+          const uint64_t *seen_v = Seen(v);
+          uint64_t *next_v = Next(v);
+          for (size_t w=0; w < words_; w++) {
+            uint64_t fresh = visit_u[w] & ~seen_v[w] & ~next_v[w];
+            if (fresh != 0) {
+              #pragma omp atomic
+              next_v[w] |= fresh;
+            }
+          }
+        }
+      }
+      active = false;
+      #pragma omp parallel for reduction(|| : active) schedule(dynamic, 1024)
+      for (NodeID_ u=0; u < g_.num_nodes(); u++) {
+        uint64_t *visit_u = Visit(u);
+        uint64_t *seen_u = Seen(u);
+        uint64_t *next_u = Next(u);
+        bool reached = false;
+        for (size_t w=0; w < words_; w++) {
+          uint64_t fresh = next_u[w] & ~seen_u[w];
+          seen_u[w] |= fresh;
+          next_u[w] = 0;
+          visit_u[w] = fresh;
+          reached |= fresh != 0;
+        }
+        if (reached) {
+          visitor(u, depth, visit_u);
+          active = true;
+        }
+      }
+    }
+    return depth - 1;
+  }
+
+  template <typename LevelVisitor>
+  int Run(const std::vector<NodeID_> &sources, LevelVisitor visitor) {
+    return Run(sources, visitor, [](NodeID_) {});
+  }
+
+ private:
+  const CGraph &g_;
+  size_t words_;
+  pvector<uint64_t> visit_;
+  pvector<uint64_t> state_;
+
+  uint64_t* Visit(NodeID_ u) const { return visit_.data() + u * words_; }
+  uint64_t* Seen(NodeID_ u) const { return state_.data() + u * 2 * words_; }
+  uint64_t* Next(NodeID_ u) const { return Seen(u) + words_; }
+
+  bool Any(const uint64_t *bits) const {
+    for (size_t w=0; w < words_; w++) {
+      if (bits[w] != 0)
+        return true;
+    }
+    return false;
+  }
+};
+
+#endif  // MS_BFS_H_
@@ -0,0 +1,268 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef NUMA_PARTITION_H_
+#define NUMA_PARTITION_H_
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "partition.h"
+#include "pickle_job.h"
+#include "pvector.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  NumaPartition
+
+Groups the parts of a VertexPartition into one domain per device (one Pickle
+device per socket) and places every domain on its device's NUMA node
+ - Parts are owned one per thread (VertexPartition). Part p, and so thread
+   p, belongs to domain DomainOfPart(p) = p * D / P: a domain is a run of
+   consecutive parts, i.e. a contiguous vertex range worked on by
+   consecutive threads. PickleKernelContext binds thread t to device
+   DomainOfPart(t) the same way, so each device gets the sub-jobs of its own
+   domain only
+ - Domain d lives on the d-th online NUMA node (modulo their number), since
+   the driver numbers the devices in socket order
+ - PlaceIncoming(g) / PlaceOutgoing(g) move each domain's slice of the CSR
+   index and neighbor arrays to its node, Place(array) a per-vertex array's
+   slice. Pages are moved with the mbind system call (MPOL_MF_MOVE), so no
+   libnuma is needed; a page straddling two domains goes to the later one
+ - PinThreads() pins every thread of the team to the CPUs of its domain's
+   node, so the pages it works on stay local
+ - On a single NUMA node, or with a single domain, every call is a no-op;
+   a failed move (e.g. mbind not permitted) is reported once and leaves the
+   pages where they are
+*/
+
+
+inline int DomainOfPart(int p, int num_parts, int num_domains) {
+  return static_cast<int64_t>(p) * num_domains / num_parts;
+}
+
+
+// Online NUMA nodes and their CPUs, from sysfs
+class NumaTopology {
+ public:
+  static const NumaTopology& Get() {
+    static const NumaTopology topology;
+    return topology;
+  }
+
+  int num_nodes() const { return node_ids_.size(); }
+  int node_id(int n) const { return node_ids_[n]; }
+  const std::vector<int>& cpus(int n) const { return node_cpus_[n]; }
+
+  // "0-3,8,10-11" -> 0 1 2 3 8 10 11
+  static std::vector<int> ParseList(const std::string &list) {
+    std::vector<int> ids;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+      if (item.empty() || item == "\n")
+        continue;
+      int first, last;
+      if (std::sscanf(item.c_str(), "%d-%d", &first, &last) != 2)
+        last = first = std::stoi(item);
+      for (int id = first; id <= last; id++)
+        ids.push_back(id);
+    }
+    return ids;
+  }
+
+ private:
+  std::vector<int> node_ids_;
+  std::vector<std::vector<int>> node_cpus_;
+
+  NumaTopology() {
+    const std::string root = "/sys/devices/system/node/";
+    for (int node : ParseList(ReadLine(root + "online"))) {
+      std::vector<int> cpus = ParseList(
+          ReadLine(root + "node" + std::to_string(node) + "/cpulist"));
+      if (cpus.empty())
+        continue;  // memory-only node
+      node_ids_.push_back(node);
+      node_cpus_.push_back(cpus);
+    }
+    if (node_ids_.empty()) {
+      // no sysfs: one node with every CPU
+      node_ids_.push_back(0);
+      node_cpus_.push_back(std::vector<int>());
+      for (int cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF); cpu++)
+        node_cpus_[0].push_back(cpu);
+    }
+  }
+
+  static std::string ReadLine(const std::string &path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+  }
+};
+
+
+template <typename NodeID_>
+class NumaPartition {
+ public:
+  NumaPartition(const VertexPartition<NodeID_> &part, int num_domains) :
+      num_parts_(part.num_parts()), num_domains_(std::max(num_domains, 1)),
+      domain_bounds_(num_domains_ + 1) {
+    // a domain starts at its first part; domains without parts (more
+    // domains than parts) are empty
+    int p = 0;
+    for (int d=0; d <= num_domains_; d++) {
+      while (p < num_parts_ && domain_of_part(p) < d)
+        p++;
+      domain_bounds_[d] = p < num_parts_ ? part.begin(p)
+                                         : part.end(num_parts_ - 1);
+    }
+  }
+
+  int num_domains() const { return num_domains_; }
+  int domain_of_part(int p) const {
+    return DomainOfPart(p, num_parts_, num_domains_);
+  }
+  NodeID_ begin(int d) const { return domain_bounds_[d]; }
+  NodeID_ end(int d) const { return domain_bounds_[d+1]; }
+
+  // NUMA node id of domain d
+  int node_of_domain(int d) const {
+    const NumaTopology &topology = NumaTopology::Get();
+    return topology.node_id(d % topology.num_nodes());
+  }
+
+  bool enabled() const {
+    return num_domains_ > 1 && NumaTopology::Get().num_nodes() > 1;
+  }
+
+  template <typename GraphT>
+  void PlaceIncoming(const GraphT &g) const {
+    PlaceCSR(*g.getInIndexArrayDescriptor(),
+             *g.getInNeighborsArrayDescriptor(),
+             [&g] (NodeID_ v) { return g.in_offset(v); });
+  }
+
+  template <typename GraphT>
+  void PlaceOutgoing(const GraphT &g) const {
+    PlaceCSR(*g.getOutIndexArrayDescriptor(),
+             *g.getOutNeighborsArrayDescriptor(),
+             [&g] (NodeID_ v) { return g.out_offset(v); });
+  }
+
+  // array holds one element per vertex
+  template <typename T>
+  void Place(const T *array) const {
+    if (!enabled())
+      return;
+    const uint64_t start = reinterpret_cast<uint64_t>(array);
+    for (int d=0; d < num_domains_; d++)
+      Move(start + begin(d) * sizeof(T), start + end(d) * sizeof(T),
+           d == num_domains_ - 1, node_of_domain(d));
+  }
+
+  void PinThreads() const {
+    if (!enabled())
+      return;
+    #pragma omp parallel
+    {
+      const int t = TeamThreadNum();
+      const NumaTopology &topology = NumaTopology::Get();
+      const int n = DomainOfPart(t, TeamSize(), num_domains_) %
+                    topology.num_nodes();
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      for (int cpu : topology.cpus(n))
+        CPU_SET(cpu, &cpus);
+      sched_setaffinity(0, sizeof(cpus), &cpus);
+    }
+  }
+
+ private:
+  static const uint64_t kPageBytes = 4096;
+  static const int kMpolBind = 2;
+  static const unsigned kMpolMfMove = 1 << 1;
+
+  int num_parts_;
+  int num_domains_;
+  pvector<NodeID_> domain_bounds_;
+
+  static int TeamThreadNum() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+  static int TeamSize() {
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+  }
+
+  template <typename OffsetFunc>
+  void PlaceCSR(const PickleArrayDescriptor &index,
+                const PickleArrayDescriptor &neighbors,
+                OffsetFunc offset) const {
+    if (!enabled())
+      return;
+    for (int d=0; d < num_domains_; d++) {
+      const bool last = d == num_domains_ - 1;
+      const int node = node_of_domain(d);
+      Move(index.vaddr_start + begin(d) * index.element_size,
+           index.vaddr_start + end(d) * index.element_size, last, node);
+      Move(neighbors.vaddr_start + offset(begin(d)) * neighbors.element_size,
+           neighbors.vaddr_start + offset(end(d)) * neighbors.element_size,
+           last, node);
+    }
+  }
+
+  // Pages from the one holding first up to the one holding last (included
+  // only for the last domain, the earlier ones leave it to the next domain)
+  static void Move(uint64_t first, uint64_t last, bool include_last,
+                   int node) {
+    const uint64_t start = first / kPageBytes * kPageBytes;
+    uint64_t stop = last / kPageBytes * kPageBytes;
+    if (include_last && last != stop)
+      stop += kPageBytes;
+    if (stop <= start)
+      return;
+    std::vector<unsigned long> mask(node / (8 * sizeof(unsigned long)) + 1);
+    mask[node / (8 * sizeof(unsigned long))] |=
+        1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, start, stop - start, kMpolBind, mask.data(),
+                mask.size() * 8 * sizeof(unsigned long) + 1,
+                kMpolMfMove) != 0) {
+      static bool reported = false;
+      if (!reported) {
+        reported = true;
+        std::cout << "NUMA placement failed: " << std::strerror(errno)
+                  << std::endl;
+      }
+    }
+  }
+};
+
+#endif  // NUMA_PARTITION_H_
@@ -0,0 +1,96 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PARTITION_H_
+#define PARTITION_H_
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "pvector.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  VertexPartition
+
+Splits the vertices of a graph into contiguous, edge-balanced ranges
+ - EdgeBalanced() / EdgeBalancedIncoming() give every part about the same
+   cost, counting one unit per vertex plus one per out-edge (in-edge), so
+   runs of zero-degree vertices still get spread out; each boundary is a
+   binary search over the graph's CSR offsets (out_offset / in_offset)
+ - Parts are meant to be owned one per thread: a loop over the parts with
+   "omp for schedule(static, 1)" hands part p to thread p of the team, and
+   the sub-jobs built by createGraphSubJobsUsing*Edges (wrapper.h) cover
+   exactly the same ranges, so each thread's progress channel follows a job
+   of its own slice
+ - With fewer threads than parts (e.g. a smaller team than
+   omp_get_max_threads() at construction) a thread takes several parts
+*/
+
+
+template <typename NodeID_>
+class VertexPartition {
+ public:
+  VertexPartition() : bounds_(2) {
+    bounds_[0] = 0;
+    bounds_[1] = 0;
+  }
+
+  // Balances vertices plus out-edges
+  template <typename GraphT>
+  static VertexPartition EdgeBalanced(const GraphT &g, int num_parts) {
+    return Balance(g.num_nodes(), num_parts,
+                   [&g] (NodeID_ v) { return g.out_offset(v); });
+  }
+
+  // Balances vertices plus in-edges, for pull-direction loops
+  template <typename GraphT>
+  static VertexPartition EdgeBalancedIncoming(const GraphT &g,
+                                              int num_parts) {
+    return Balance(g.num_nodes(), num_parts,
+                   [&g] (NodeID_ v) { return g.in_offset(v); });
+  }
+
+  int num_parts() const { return bounds_.size() - 1; }
+  NodeID_ begin(int p) const { return bounds_[p]; }
+  NodeID_ end(int p) const { return bounds_[p+1]; }
+
+ private:
+  pvector<NodeID_> bounds_;
+
+  // offset(v) is the number of edges before v, so the cost of [0, v) is
+  // v + offset(v)
+  template <typename OffsetFunc>
+  static VertexPartition Balance(int64_t num_nodes, int num_parts,
+                                 OffsetFunc offset) {
+    num_parts = std::max(num_parts, 1);
+    auto Cost = [&offset] (NodeID_ v) {
+      return static_cast<int64_t>(v) + offset(v);
+    };
+    const int64_t total_cost = Cost(num_nodes);
+    VertexPartition part;
+    part.bounds_ = pvector<NodeID_>(num_parts + 1);
+    part.bounds_[0] = 0;
+    part.bounds_[num_parts] = num_nodes;
+    #pragma omp parallel for
+    for (int p=1; p < num_parts; p++) {
+      const int64_t target = total_cost * p / num_parts;
+      // first vertex whose cost prefix reaches the target
+      NodeID_ lo = 0, hi = num_nodes;
+      while (lo < hi) {
+        NodeID_ mid = lo + (hi - lo) / 2;
+        if (Cost(mid) < target)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      part.bounds_[p] = lo;
+    }
+    return part;
+  }
+};
+
+
+#endif  // PARTITION_H_
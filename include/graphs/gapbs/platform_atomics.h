@@ -4,6 +4,9 @@
 #ifndef PLATFORM_ATOMICS_H_
 #define PLATFORM_ATOMICS_H_
 
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
 
 /*
 GAP Benchmark Suite
@@ -12,6 +15,17 @@ Author: Scott Beamer
 
 Wrappers for compiler intrinsics for atomic memory operations (AMOs)
  - If not using OpenMP (serial), provides serial fallbacks
+ - fetch_and_add and compare_and_swap with two or three arguments are the
+   original __sync wrappers and always sequentially consistent
+ - With gcc/clang, fetch_and_add and compare_and_swap also take a
+   std::memory_order, and fetch_and_add then also works on float and double
+ - fetch_min / fetch_max lower / raise x to val and return the old value.
+   With AArch64 LSE (__ARM_FEATURE_ATOMICS) on 32/64-bit integers they are
+   one LDSMIN/LDSMAX/LDUMIN/LDUMAX; otherwise a CAS loop that returns without
+   writing once x is already at or past val
+ - The ordered variants go through AtomicRef, which is std::atomic_ref when
+   the standard library has it (C++20) and otherwise a stand-in over the
+   same __atomic builtins
 */
 
 
@@ -32,14 +46,14 @@ Wrappers for compiler intrinsics for atomic memory operations (AMOs)
     }
 
     template<>
-    bool compare_and_swap(float &x, const float &old_val, const float &new_val) {
+    inline bool compare_and_swap(float &x, const float &old_val, const float &new_val) {
       return __sync_bool_compare_and_swap(reinterpret_cast<uint32_t*>(&x),
                                           reinterpret_cast<const uint32_t&>(old_val),
                                           reinterpret_cast<const uint32_t&>(new_val));
     }
 
     template<>
-    bool compare_and_swap(double &x, const double &old_val, const double &new_val) {
+    inline bool compare_and_swap(double &x, const double &old_val, const double &new_val) {
       return __sync_bool_compare_and_swap(reinterpret_cast<uint64_t*>(&x),
                                           reinterpret_cast<const uint64_t&>(old_val),
                                           reinterpret_cast<const uint64_t&>(new_val));
@@ -126,4 +140,213 @@ Wrappers for compiler intrinsics for atomic memory operations (AMOs)
 
 #endif  // else defined _OPENMP
 
+
+#if defined _OPENMP && defined __GNUC__
+
+  #if defined __cpp_lib_atomic_ref
+
+    template<typename T>
+    using AtomicRef = std::atomic_ref<T>;
+
+  #else   // defined __cpp_lib_atomic_ref
+
+    // The members of std::atomic_ref this file needs, for C++17
+    template<typename T>
+    class AtomicRef {
+     public:
+      explicit AtomicRef(T &x) : ptr_(&x) {}
+
+      T load(std::memory_order order) const {
+        T val;
+        __atomic_load(ptr_, &val, order);
+        return val;
+      }
+
+      bool compare_exchange_weak(T &expected, T desired,
+                                 std::memory_order success,
+                                 std::memory_order failure) const {
+        return __atomic_compare_exchange(ptr_, &expected, &desired, true,
+                                         success, failure);
+      }
+
+      bool compare_exchange_strong(T &expected, T desired,
+                                   std::memory_order order) const {
+        return __atomic_compare_exchange(ptr_, &expected, &desired, false,
+                                         order, FailureOrder(order));
+      }
+
+      template<typename U = T>
+      typename std::enable_if<std::is_integral<U>::value, T>::type
+      fetch_add(T inc, std::memory_order order) const {
+        return __atomic_fetch_add(ptr_, inc, order);
+      }
+
+      template<typename U = T>
+      typename std::enable_if<std::is_floating_point<U>::value, T>::type
+      fetch_add(T inc, std::memory_order order) const {
+        T old_val = load(std::memory_order_relaxed);
+        while (!compare_exchange_weak(old_val, old_val + inc, order,
+                                      std::memory_order_relaxed)) {}
+        return old_val;
+      }
+
+     private:
+      T *ptr_;
+
+      // A failed exchange is only a load, so it can't release
+      static std::memory_order FailureOrder(std::memory_order order) {
+        if (order == std::memory_order_acq_rel)
+          return std::memory_order_acquire;
+        if (order == std::memory_order_release)
+          return std::memory_order_relaxed;
+        return order;
+      }
+    };
+
+  #endif  // else defined __cpp_lib_atomic_ref
+
+  template<typename T, typename U>
+  T fetch_and_add(T &x, U inc, std::memory_order order) {
+    return AtomicRef<T>(x).fetch_add(static_cast<T>(inc), order);
+  }
+
+  template<typename T>
+  bool compare_and_swap(T &x, T old_val, const T &new_val,
+                        std::memory_order order) {
+    return AtomicRef<T>(x).compare_exchange_strong(old_val, new_val, order);
+  }
+
+  inline float fetch_and_add(float &x, float inc) {
+    return fetch_and_add(x, inc, std::memory_order_seq_cst);
+  }
+
+  inline double fetch_and_add(double &x, double inc) {
+    return fetch_and_add(x, inc, std::memory_order_seq_cst);
+  }
+
+  #if defined __aarch64__ && defined __ARM_FEATURE_ATOMICS
+
+    // One LSE instruction per call; Op is the mnemonic without ordering
+    // suffix, "al" is used unless the caller asked for relaxed
+    #define LSE_FETCH_OP(Op, x, val, order, old_val)                        \
+      if (sizeof(x) == 8) {                                                 \
+        if (order == std::memory_order_relaxed)                             \
+          asm volatile(Op " %x[v], %x[o], %[m]"                             \
+                       : [o] "=r"(old_val), [m] "+Q"(x) : [v] "r"(val));    \
+        else                                                                \
+          asm volatile(Op "al %x[v], %x[o], %[m]"                           \
+                       : [o] "=r"(old_val), [m] "+Q"(x) : [v] "r"(val)      \
+                       : "memory");                                         \
+      } else {                                                              \
+        if (order == std::memory_order_relaxed)                             \
+          asm volatile(Op " %w[v], %w[o], %[m]"                             \
+                       : [o] "=r"(old_val), [m] "+Q"(x) : [v] "r"(val));    \
+        else                                                                \
+          asm volatile(Op "al %w[v], %w[o], %[m]"                           \
+                       : [o] "=r"(old_val), [m] "+Q"(x) : [v] "r"(val)      \
+                       : "memory");                                         \
+      }
+
+    template<typename T>
+    struct HasLSEMinMax {
+      static const bool value = std::is_integral<T>::value &&
+                                (sizeof(T) == 4 || sizeof(T) == 8);
+    };
+
+  #else   // defined __aarch64__ && defined __ARM_FEATURE_ATOMICS
+
+    template<typename T>
+    struct HasLSEMinMax {
+      static const bool value = false;
+    };
+
+  #endif  // else defined __aarch64__ && defined __ARM_FEATURE_ATOMICS
+
+  template<typename T, typename U>
+  T fetch_min(T &x, U val, std::memory_order order = std::memory_order_seq_cst) {
+    T new_val = static_cast<T>(val);
+    T old_val;
+    if constexpr (HasLSEMinMax<T>::value) {
+  #if defined __aarch64__ && defined __ARM_FEATURE_ATOMICS
+      if (std::is_signed<T>::value) {
+        LSE_FETCH_OP("ldsmin", x, new_val, order, old_val)
+      } else {
+        LSE_FETCH_OP("ldumin", x, new_val, order, old_val)
+      }
+  #endif
+    } else {
+      AtomicRef<T> ref(x);
+      old_val = ref.load(std::memory_order_relaxed);
+      while (new_val < old_val &&
+             !ref.compare_exchange_weak(old_val, new_val, order,
+                                        std::memory_order_relaxed)) {}
+    }
+    return old_val;
+  }
+
+  template<typename T, typename U>
+  T fetch_max(T &x, U val, std::memory_order order = std::memory_order_seq_cst) {
+    T new_val = static_cast<T>(val);
+    T old_val;
+    if constexpr (HasLSEMinMax<T>::value) {
+  #if defined __aarch64__ && defined __ARM_FEATURE_ATOMICS
+      if (std::is_signed<T>::value) {
+        LSE_FETCH_OP("ldsmax", x, new_val, order, old_val)
+      } else {
+        LSE_FETCH_OP("ldumax", x, new_val, order, old_val)
+      }
+  #endif
+    } else {
+      AtomicRef<T> ref(x);
+      old_val = ref.load(std::memory_order_relaxed);
+      while (old_val < new_val &&
+             !ref.compare_exchange_weak(old_val, new_val, order,
+                                        std::memory_order_relaxed)) {}
+    }
+    return old_val;
+  }
+
+  #if defined LSE_FETCH_OP
+    #undef LSE_FETCH_OP
+  #endif
+
+#elif !defined _OPENMP
+
+  // serial fallbacks (memory orders are meaningless without threads)
+
+  template<typename T, typename U>
+  T fetch_and_add(T &x, U inc, std::memory_order) {
+    T orig_val = x;
+    x += inc;
+    return orig_val;
+  }
+
+  template<typename T>
+  bool compare_and_swap(T &x, const T &old_val, const T &new_val,
+                        std::memory_order) {
+    if (x == old_val) {
+      x = new_val;
+      return true;
+    }
+    return false;
+  }
+
+  template<typename T, typename U>
+  T fetch_min(T &x, U val, std::memory_order = std::memory_order_seq_cst) {
+    T orig_val = x;
+    if (static_cast<T>(val) < x)
+      x = static_cast<T>(val);
+    return orig_val;
+  }
+
+  template<typename T, typename U>
+  T fetch_max(T &x, U val, std::memory_order = std::memory_order_seq_cst) {
+    T orig_val = x;
+    if (x < static_cast<T>(val))
+      x = static_cast<T>(val);
+    return orig_val;
+  }
+
+#endif  // elif !defined _OPENMP
+
 #endif  // PLATFORM_ATOMICS_H_
@@ -12,6 +12,10 @@
 
 #include "pickle_job.h"
 
+#if PICKLE_TRACE_ACCESSES==1
+#include "access_recorder.h"
+#endif
+
 /*
 GAP Benchmark Suite
 Class:  pvector
@@ -21,6 +25,8 @@ Vector class with ability to not initialize or do initialize in parallel
  - std::vector (when resizing) will always initialize, and does it serially
  - When pvector is resized, new elements are uninitialized
  - Resizing is not thread-safe
+ - With PICKLE_TRACE_ACCESSES=1, operator[] reports each access to the
+   AccessRecorder (access_recorder.h)
 */
 
 
@@ -136,10 +142,16 @@ class pvector {
   }
 
   T_& operator[](size_t n) {
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().Load(array_descriptor.get(), n, start_ + n);
+#endif
     return start_[n];
   }
 
   const T_& operator[](size_t n) const {
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().Load(array_descriptor.get(), n, start_ + n);
+#endif
     return start_[n];
   }
 
@@ -0,0 +1,269 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef READER_H_
+#define READER_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "pvector.h"
+#include "compressed_graph.h"
+#include "graph.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  Reader
+Author: Scott Beamer
+
+Given filename, returns an edgelist or the entire graph (if serialized)
+ - Edge lists (.el, .wel) are read into memory in one pass and parsed in
+   parallel: the buffer is split into chunks aligned to line boundaries, each
+   chunk counts its edges, a prefix sum gives every chunk its output offset,
+   and the chunks are then parsed straight into the EdgeList
+ - Lines starting with '#' or '%' are treated as comments
+ - Compressed graphs (.csg) are decoded into a regular CSRGraph on load
+   (CompressedGraph::Decode)
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          typename WeightT_ = NodeID_, bool invert = true>
+class Reader {
+  typedef EdgePair<NodeID_, DestID_> Edge;
+  typedef pvector<Edge> EdgeList;
+  std::string filename_;
+
+  static const size_t kChunkBytes = 1 << 22;
+
+  static bool IsDigit(char c) {
+    return (c >= '0') && (c <= '9');
+  }
+
+  static const char* SkipBlanks(const char *p) {
+    while ((*p == ' ') || (*p == '\t') || (*p == '\r'))
+      p++;
+    return p;
+  }
+
+  static const char* NextLine(const char *p, const char *end) {
+    while ((p < end) && (*p != '\n'))
+      p++;
+    return (p < end) ? p + 1 : end;
+  }
+
+  static const char* ParseNodeID(const char *p, NodeID_ &val) {
+    int64_t v = 0;
+    p = SkipBlanks(p);
+    while (IsDigit(*p))
+      v = v * 10 + (*(p++) - '0');
+    val = static_cast<NodeID_>(v);
+    return p;
+  }
+
+  static const char* ParseWeight(const char *p, WeightT_ &val) {
+    p = SkipBlanks(p);
+    char *parse_end;
+    if (std::is_floating_point<WeightT_>::value)
+      val = static_cast<WeightT_>(std::strtod(p, &parse_end));
+    else
+      val = static_cast<WeightT_>(std::strtoll(p, &parse_end, 10));
+    return parse_end;
+  }
+
+  static bool IsEdgeLine(const char *p) {
+    return IsDigit(*SkipBlanks(p));
+  }
+
+  static Edge MakeEdge(NodeID_ u, NodeID_ v, WeightT_ w) {
+    if constexpr (std::is_same<NodeID_, DestID_>::value)
+      return Edge(u, v);
+    else
+      return Edge(u, DestID_(v, w));
+  }
+
+  // Returns the file contents followed by a terminating '\0' sentinel
+  pvector<char> ReadWholeFile(std::ifstream &in) {
+    in.seekg(0, std::ios::end);
+    size_t num_bytes = in.tellg();
+    in.seekg(0, std::ios::beg);
+    pvector<char> buffer(num_bytes + 1);
+    in.read(buffer.data(), num_bytes);
+    buffer[num_bytes] = '\0';
+    return buffer;
+  }
+
+  EdgeList ParseEdgeList(std::ifstream &in, bool weighted) {
+    pvector<char> buffer = ReadWholeFile(in);
+    const char *text = buffer.data();
+    const size_t num_bytes = buffer.size() - 1;
+    const size_t num_chunks = std::max<size_t>(1, num_bytes / kChunkBytes);
+    pvector<size_t> bounds(num_chunks + 1);
+    #pragma omp parallel for
+    for (size_t c=0; c <= num_chunks; c++) {
+      if (c == 0) {
+        bounds[c] = 0;
+      } else if (c == num_chunks) {
+        bounds[c] = num_bytes;
+      } else {
+        const char *approx = text + c * (num_bytes / num_chunks);
+        bounds[c] = (approx[-1] == '\n') ? approx - text :
+                    NextLine(approx, text + num_bytes) - text;
+      }
+    }
+    for (size_t c=1; c <= num_chunks; c++)
+      bounds[c] = std::max(bounds[c], bounds[c-1]);
+    pvector<size_t> chunk_offsets(num_chunks + 1, 0);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c=0; c < num_chunks; c++) {
+      size_t count = 0;
+      const char *chunk_end = text + bounds[c+1];
+      for (const char *p = text + bounds[c]; p < chunk_end;
+           p = NextLine(p, chunk_end))
+        count += IsEdgeLine(p);
+      chunk_offsets[c+1] = count;
+    }
+    for (size_t c=0; c < num_chunks; c++)
+      chunk_offsets[c+1] += chunk_offsets[c];
+    EdgeList el(chunk_offsets[num_chunks]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c=0; c < num_chunks; c++) {
+      size_t e = chunk_offsets[c];
+      const char *chunk_end = text + bounds[c+1];
+      for (const char *p = text + bounds[c]; p < chunk_end;
+           p = NextLine(p, chunk_end)) {
+        if (!IsEdgeLine(p))
+          continue;
+        NodeID_ u, v;
+        WeightT_ w = 1;
+        const char *q = ParseNodeID(p, u);
+        q = ParseNodeID(q, v);
+        if (weighted)
+          ParseWeight(q, w);
+        el[e++] = MakeEdge(u, v, w);
+      }
+    }
+    return el;
+  }
+
+ public:
+  explicit Reader(std::string filename) : filename_(filename) {}
+
+  std::string GetSuffix() {
+    std::size_t suff_pos = filename_.rfind('.');
+    if (suff_pos == std::string::npos) {
+      std::cout << "Couldn't find suffix of " << filename_ << std::endl;
+      std::exit(-1);
+    }
+    return filename_.substr(suff_pos);
+  }
+
+  EdgeList ReadInEL(std::ifstream &in) {
+    return ParseEdgeList(in, false);
+  }
+
+  EdgeList ReadInWEL(std::ifstream &in) {
+    return ParseEdgeList(in, true);
+  }
+
+  EdgeList ReadFile(bool &needs_weights) {
+    Timer t;
+    t.Start();
+    EdgeList el;
+    std::string suffix = GetSuffix();
+    std::ifstream file(filename_, std::ios::binary);
+    if (!file.is_open()) {
+      std::cout << "Couldn't open file " << filename_ << std::endl;
+      std::exit(-2);
+    }
+    if (suffix == ".el") {
+      el = ReadInEL(file);
+    } else if (suffix == ".wel") {
+      needs_weights = false;
+      el = ReadInWEL(file);
+    } else {
+      std::cout << "Unrecognized suffix: " << suffix << std::endl;
+      std::exit(-3);
+    }
+    file.close();
+    t.Stop();
+    PrintTime("Read Time", t.Seconds());
+    return el;
+  }
+
+  CSRGraph<NodeID_, DestID_, invert> ReadSerializedGraph() {
+    bool weighted = GetSuffix() == ".wsg";
+    if (!std::is_same<NodeID_, SGID>::value) {
+      std::cout << "serialized graphs only allowed for 32b IDs" << std::endl;
+      std::exit(-4);
+    }
+    if (!std::is_same<DestID_, NodeID_>::value && !weighted) {
+      std::cout << ".sg not allowed for weighted graphs" << std::endl;
+      std::exit(-5);
+    }
+    if (std::is_same<DestID_, NodeID_>::value && weighted) {
+      std::cout << ".wsg only allowed for weighted graphs" << std::endl;
+      std::exit(-5);
+    }
+    if (weighted && !std::is_same<WeightT_, SGID>::value) {
+      std::cout << ".wsg only allowed for int32_t weights" << std::endl;
+      std::exit(-5);
+    }
+    std::ifstream file(filename_);
+    if (!file.is_open()) {
+      std::cout << "Couldn't open file " << filename_ << std::endl;
+      std::exit(-6);
+    }
+    Timer t;
+    t.Start();
+    bool directed;
+    SGOffset num_nodes, num_edges;
+    DestID_ **index = nullptr, **inv_index = nullptr;
+    DestID_ *neighs = nullptr, *inv_neighs = nullptr;
+    file.read(reinterpret_cast<char*>(&directed), sizeof(bool));
+    file.read(reinterpret_cast<char*>(&num_edges), sizeof(SGOffset));
+    file.read(reinterpret_cast<char*>(&num_nodes), sizeof(SGOffset));
+    pvector<SGOffset> offsets(num_nodes+1);
+    neighs = new DestID_[num_edges];
+    std::streamsize num_index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    std::streamsize num_neigh_bytes = num_edges * sizeof(DestID_);
+    file.read(reinterpret_cast<char*>(offsets.data()), num_index_bytes);
+    file.read(reinterpret_cast<char*>(neighs), num_neigh_bytes);
+    index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, neighs);
+    if (directed && invert) {
+      inv_neighs = new DestID_[num_edges];
+      file.read(reinterpret_cast<char*>(offsets.data()), num_index_bytes);
+      file.read(reinterpret_cast<char*>(inv_neighs), num_neigh_bytes);
+      inv_index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, inv_neighs);
+    }
+    file.close();
+    t.Stop();
+    PrintTime("Read Time", t.Seconds());
+    if (directed)
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs,
+                                                inv_index, inv_neighs);
+    else
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs);
+  }
+
+  CSRGraph<NodeID_, DestID_, invert> ReadCompressedGraph() {
+    if constexpr (std::is_same<DestID_, NodeID_>::value &&
+                  std::is_same<NodeID_, SGID>::value) {
+      CompressedGraph<NodeID_> cg(filename_);
+      return cg.template Decode<invert>();
+    } else {
+      std::cout << ".csg only allowed for unweighted 32b IDs" << std::endl;
+      std::exit(-5);
+    }
+  }
+};
+
+#endif  // READER_H_
@@ -0,0 +1,477 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef REORDER_H_
+#define REORDER_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pvector.h"
+#include "graph.h"
+
+
+/*
+GAP Benchmark Suite (Pickle extension)
+Class:  Reorderer
+
+Relabels the vertices of a CSRGraph to improve the locality of the property
+arrays that neighbors index into
+ - DegreeSort: vertices sorted by descending degree
+ - HubCluster: high-degree vertices packed at the front, original order kept
+ - RCM: reverse Cuthill-McKee, bandwidth-reducing BFS order
+ - Gorder: greedy window ordering maximizing shared neighbors (Wei et al.)
+ - Both CSR directions are rebuilt in parallel and the resulting graph gets
+   freshly constructed array descriptors, so jobs must be rebuilt from it
+ - VertexMapping keeps old<->new IDs to translate results back
+*/
+
+
+enum class ReorderMethod { kNone, kDegreeSort, kHubCluster, kRCM, kGorder };
+
+// Returns false (method untouched) if name is not a method
+inline bool ParseReorderMethod(const std::string &name,
+                               ReorderMethod *method) {
+  if (name == "none")
+    *method = ReorderMethod::kNone;
+  else if (name == "degree")
+    *method = ReorderMethod::kDegreeSort;
+  else if (name == "hub")
+    *method = ReorderMethod::kHubCluster;
+  else if (name == "rcm")
+    *method = ReorderMethod::kRCM;
+  else if (name == "gorder")
+    *method = ReorderMethod::kGorder;
+  else
+    return false;
+  return true;
+}
+
+inline std::string ReorderMethodName(ReorderMethod method) {
+  switch (method) {
+    case ReorderMethod::kDegreeSort: return "degree";
+    case ReorderMethod::kHubCluster: return "hub";
+    case ReorderMethod::kRCM:        return "rcm";
+    case ReorderMethod::kGorder:     return "gorder";
+    default:                         return "none";
+  }
+}
+
+
+// Sorts [begin, end) by sorting fixed chunks in parallel then merging pairs
+// of chunks in parallel rounds
+template <typename RandomIt, typename Compare>
+void ParallelSort(RandomIt begin, RandomIt end, Compare comp) {
+  const int64_t length = end - begin;
+  const int64_t kMinChunk = 1 << 16;
+  const int64_t num_chunks = std::max<int64_t>(1,
+      std::min<int64_t>(256, length / kMinChunk));
+  const int64_t chunk_size = (length + num_chunks - 1) / num_chunks;
+  #pragma omp parallel for
+  for (int64_t c=0; c < num_chunks; c++) {
+    int64_t lo = std::min(c * chunk_size, length);
+    int64_t hi = std::min(lo + chunk_size, length);
+    std::sort(begin + lo, begin + hi, comp);
+  }
+  for (int64_t width=chunk_size; width < length; width *= 2) {
+    const int64_t num_merges = (length + 2*width - 1) / (2*width);
+    #pragma omp parallel for
+    for (int64_t m=0; m < num_merges; m++) {
+      int64_t lo = m * 2 * width;
+      int64_t mid = std::min(lo + width, length);
+      int64_t hi = std::min(lo + 2*width, length);
+      std::inplace_merge(begin + lo, begin + mid, begin + hi, comp);
+    }
+  }
+}
+
+
+// Bidirectional vertex ID mapping produced by a reordering
+template <typename NodeID_>
+struct VertexMapping {
+  pvector<NodeID_> new_ids;  // indexed by original ID
+  pvector<NodeID_> old_ids;  // indexed by reordered ID
+
+  VertexMapping() {}
+
+  explicit VertexMapping(pvector<NodeID_> &&to_new)
+      : new_ids(std::move(to_new)), old_ids(new_ids.size()) {
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < (NodeID_) new_ids.size(); n++)
+      old_ids[new_ids[n]] = n;
+  }
+
+  NodeID_ ToNew(NodeID_ old_id) const { return new_ids[old_id]; }
+  NodeID_ ToOld(NodeID_ new_id) const { return old_ids[new_id]; }
+
+  // Translates a per-vertex result computed on the reordered graph back to
+  // original IDs (e.g. PageRank scores, BFS parents need values mapped too)
+  template <typename T_>
+  pvector<T_> ToOriginal(const pvector<T_> &by_new_id) const {
+    pvector<T_> by_old_id(by_new_id.size());
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < (NodeID_) by_new_id.size(); n++)
+      by_old_id[n] = by_new_id[new_ids[n]];
+    return by_old_id;
+  }
+
+  // Permutes a per-vertex input indexed by original ID into reordered IDs
+  template <typename T_>
+  pvector<T_> ToReordered(const pvector<T_> &by_old_id) const {
+    pvector<T_> by_new_id(by_old_id.size());
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < (NodeID_) by_old_id.size(); n++)
+      by_new_id[new_ids[n]] = by_old_id[n];
+    return by_new_id;
+  }
+};
+
+
+template <typename NodeID_, typename DestID_ = NodeID_,
+          bool MakeInverse = true>
+class Reorderer {
+  typedef CSRGraph<NodeID_, DestID_, MakeInverse> CSRGraphT;
+  typedef std::pair<int64_t, NodeID_> DegreeNodePair;
+
+  const CSRGraphT &g_;
+  const NodeID_ num_nodes_;
+
+ public:
+  explicit Reorderer(const CSRGraphT &g)
+      : g_(g), num_nodes_(g.num_nodes()) {}
+
+  // Returns the graph relabeled with method and fills mapping if given
+  CSRGraphT Reorder(ReorderMethod method,
+                    VertexMapping<NodeID_> *mapping = nullptr) const {
+    pvector<NodeID_> new_ids = ComputeNewIDs(method);
+    CSRGraphT reordered = Relabel(new_ids);
+    if (mapping != nullptr)
+      *mapping = VertexMapping<NodeID_>(std::move(new_ids));
+    return reordered;
+  }
+
+  // Returns new_ids where new_ids[old] is the label of old after reordering
+  pvector<NodeID_> ComputeNewIDs(ReorderMethod method) const {
+    switch (method) {
+      case ReorderMethod::kDegreeSort: return DegreeSortIDs();
+      case ReorderMethod::kHubCluster: return HubClusterIDs();
+      case ReorderMethod::kRCM:        return RCMIDs();
+      case ReorderMethod::kGorder:     return GorderIDs();
+      default:                         return IdentityIDs();
+    }
+  }
+
+  // Rebuilds both CSR directions under new_ids, neighborhoods kept sorted
+  CSRGraphT Relabel(const pvector<NodeID_> &new_ids) const {
+    DestID_ *out_neighs = nullptr;
+    DestID_ **out_index = RelabelDirection(new_ids, false, &out_neighs);
+    if constexpr (MakeInverse) {
+      if (g_.directed()) {
+        DestID_ *in_neighs = nullptr;
+        DestID_ **in_index = RelabelDirection(new_ids, true, &in_neighs);
+        return CSRGraphT(num_nodes_, out_index, out_neighs, in_index,
+                         in_neighs);
+      }
+    }
+    return CSRGraphT(num_nodes_, out_index, out_neighs);
+  }
+
+  static pvector<SGOffset> ParallelPrefixSum(const pvector<SGOffset> &degrees) {
+    const size_t block_size = 1<<20;
+    const size_t num_blocks = (degrees.size() + block_size - 1) / block_size;
+    pvector<SGOffset> local_sums(num_blocks);
+    #pragma omp parallel for
+    for (size_t block=0; block < num_blocks; block++) {
+      SGOffset lsum = 0;
+      size_t block_end = std::min((block + 1) * block_size, degrees.size());
+      for (size_t i=block * block_size; i < block_end; i++)
+        lsum += degrees[i];
+      local_sums[block] = lsum;
+    }
+    pvector<SGOffset> bulk_prefix(num_blocks+1);
+    SGOffset total = 0;
+    for (size_t block=0; block < num_blocks; block++) {
+      bulk_prefix[block] = total;
+      total += local_sums[block];
+    }
+    bulk_prefix[num_blocks] = total;
+    pvector<SGOffset> prefix(degrees.size() + 1);
+    #pragma omp parallel for
+    for (size_t block=0; block < num_blocks; block++) {
+      SGOffset local_total = bulk_prefix[block];
+      size_t block_end = std::min((block + 1) * block_size, degrees.size());
+      for (size_t i=block * block_size; i < block_end; i++) {
+        prefix[i] = local_total;
+        local_total += degrees[i];
+      }
+    }
+    prefix[degrees.size()] = bulk_prefix[num_blocks];
+    return prefix;
+  }
+
+ private:
+  static NodeID_ DestToID(NodeID_ d) { return d; }
+
+  template <typename WeightT_>
+  static NodeID_ DestToID(const NodeWeight<NodeID_, WeightT_> &d) {
+    return d.v;
+  }
+
+  static NodeID_ RelabelDest(NodeID_ d, const pvector<NodeID_> &new_ids) {
+    return new_ids[d];
+  }
+
+  template <typename WeightT_>
+  static NodeWeight<NodeID_, WeightT_> RelabelDest(
+      const NodeWeight<NodeID_, WeightT_> &d, const pvector<NodeID_> &new_ids) {
+    return NodeWeight<NodeID_, WeightT_>(new_ids[d.v], d.w);
+  }
+
+  int64_t Degree(NodeID_ n) const {
+    if constexpr (MakeInverse) {
+      if (g_.directed())
+        return g_.out_degree(n) + g_.in_degree(n);
+    }
+    return g_.out_degree(n);
+  }
+
+  // Calls visit on every neighbor of n ignoring edge direction
+  template <typename VisitFunc>
+  void ForEachNeighbor(NodeID_ n, VisitFunc visit) const {
+    for (DestID_ d : g_.out_neigh(n))
+      visit(DestToID(d));
+    if constexpr (MakeInverse) {
+      if (g_.directed()) {
+        for (DestID_ d : g_.in_neigh(n))
+          visit(DestToID(d));
+      }
+    }
+  }
+
+  DestID_** RelabelDirection(const pvector<NodeID_> &new_ids, bool transpose,
+                             DestID_** neighs) const {
+    pvector<SGOffset> degrees(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      if constexpr (MakeInverse) {
+        if (transpose) {
+          degrees[new_ids[n]] = g_.in_degree(n);
+          continue;
+        }
+      }
+      degrees[new_ids[n]] = g_.out_degree(n);
+    }
+    pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
+    *neighs = new DestID_[offsets[num_nodes_]];
+    DestID_** index = CSRGraphT::GenIndex(offsets, *neighs);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      NodeID_ new_n = new_ids[n];
+      DestID_ *dst = index[new_n];
+      if constexpr (MakeInverse) {
+        if (transpose) {
+          for (DestID_ d : g_.in_neigh(n))
+            *(dst++) = RelabelDest(d, new_ids);
+          std::sort(index[new_n], index[new_n+1]);
+          continue;
+        }
+      }
+      for (DestID_ d : g_.out_neigh(n))
+        *(dst++) = RelabelDest(d, new_ids);
+      std::sort(index[new_n], index[new_n+1]);
+    }
+    return index;
+  }
+
+  pvector<NodeID_> IdentityIDs() const {
+    pvector<NodeID_> new_ids(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < num_nodes_; n++)
+      new_ids[n] = n;
+    return new_ids;
+  }
+
+  // Converts a visiting order (order[i] = old ID placed at i) into new_ids
+  pvector<NodeID_> OrderToNewIDs(const pvector<NodeID_> &order) const {
+    pvector<NodeID_> new_ids(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ i=0; i < num_nodes_; i++)
+      new_ids[order[i]] = i;
+    return new_ids;
+  }
+
+  pvector<NodeID_> DegreeSortIDs() const {
+    pvector<DegreeNodePair> degree_id_pairs(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < num_nodes_; n++)
+      degree_id_pairs[n] = std::make_pair(-Degree(n), n);
+    ParallelSort(degree_id_pairs.begin(), degree_id_pairs.end(),
+                 std::less<DegreeNodePair>());
+    pvector<NodeID_> order(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ i=0; i < num_nodes_; i++)
+      order[i] = degree_id_pairs[i].second;
+    return OrderToNewIDs(order);
+  }
+
+  // Stable partition of vertices into hubs (degree above average) and the
+  // rest, done with per-block counts so both passes run in parallel
+  pvector<NodeID_> HubClusterIDs() const {
+    const int64_t avg_degree = g_.num_edges_directed() /
+                               std::max<int64_t>(1, num_nodes_);
+    const NodeID_ block_size = 1<<16;
+    const NodeID_ num_blocks = (num_nodes_ + block_size - 1) / block_size;
+    pvector<SGOffset> block_hubs(num_blocks);
+    #pragma omp parallel for
+    for (NodeID_ b=0; b < num_blocks; b++) {
+      SGOffset count = 0;
+      NodeID_ block_end = std::min(num_nodes_, (b + 1) * block_size);
+      for (NodeID_ n=b * block_size; n < block_end; n++)
+        count += (Degree(n) > avg_degree);
+      block_hubs[b] = count;
+    }
+    pvector<SGOffset> hub_offsets = ParallelPrefixSum(block_hubs);
+    const SGOffset total_hubs = hub_offsets[num_blocks];
+    pvector<NodeID_> new_ids(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ b=0; b < num_blocks; b++) {
+      SGOffset hub_pos = hub_offsets[b];
+      SGOffset cold_pos = total_hubs + (SGOffset) b * block_size - hub_pos;
+      NodeID_ block_end = std::min(num_nodes_, (b + 1) * block_size);
+      for (NodeID_ n=b * block_size; n < block_end; n++) {
+        if (Degree(n) > avg_degree)
+          new_ids[n] = hub_pos++;
+        else
+          new_ids[n] = cold_pos++;
+      }
+    }
+    return new_ids;
+  }
+
+  // Reverse Cuthill-McKee: BFS from a minimum-degree vertex of each component,
+  // enqueueing neighbors by ascending degree, then reversing the order
+  pvector<NodeID_> RCMIDs() const {
+    pvector<DegreeNodePair> by_degree(num_nodes_);
+    #pragma omp parallel for
+    for (NodeID_ n=0; n < num_nodes_; n++)
+      by_degree[n] = std::make_pair(Degree(n), n);
+    ParallelSort(by_degree.begin(), by_degree.end(),
+                 std::less<DegreeNodePair>());
+    pvector<bool> visited(num_nodes_, false);
+    pvector<NodeID_> order(num_nodes_);
+    std::vector<DegreeNodePair> frontier_neighs;
+    NodeID_ tail = 0;
+    for (const DegreeNodePair &start : by_degree) {
+      if (visited[start.second])
+        continue;
+      NodeID_ head = tail;
+      visited[start.second] = true;
+      order[tail++] = start.second;
+      while (head < tail) {
+        NodeID_ u = order[head++];
+        frontier_neighs.clear();
+        ForEachNeighbor(u, [&](NodeID_ v) {
+          if (!visited[v]) {
+            visited[v] = true;
+            frontier_neighs.push_back(std::make_pair(Degree(v), v));
+          }
+        });
+        std::sort(frontier_neighs.begin(), frontier_neighs.end());
+        for (const DegreeNodePair &dv : frontier_neighs)
+          order[tail++] = dv.second;
+      }
+    }
+    std::reverse(order.begin(), order.end());
+    return OrderToNewIDs(order);
+  }
+
+  // Gorder greedy placement: the next vertex is the unplaced one with the
+  // highest score against the last kWindow placed vertices, where the score
+  // counts direct edges plus shared in-neighbors. Scores are maintained
+  // incrementally as vertices enter and leave the window and the max is found
+  // with a lazily invalidated heap. In-neighbors above a degree threshold are
+  // skipped for sibling scoring, as in the original algorithm.
+  pvector<NodeID_> GorderIDs(const int kWindow = 5) const {
+    const int64_t hub_threshold =
+        std::max<int64_t>(8, (int64_t) std::sqrt((double) num_nodes_));
+    pvector<int64_t> score(num_nodes_, 0);
+    pvector<bool> placed(num_nodes_, false);
+    pvector<NodeID_> order(num_nodes_);
+    std::priority_queue<DegreeNodePair> heap;
+
+    auto update_scores = [&](NodeID_ u, int64_t delta) {
+      auto bump = [&](NodeID_ v) {
+        if (placed[v])
+          return;
+        score[v] += delta;
+        if (score[v] > 0)
+          heap.push(std::make_pair(score[v], v));
+      };
+      ForEachNeighbor(u, bump);
+      auto siblings = [&](NodeID_ x) {
+        if (Degree(x) > hub_threshold)
+          return;
+        ForEachNeighbor(x, [&](NodeID_ v) {
+          if (v != u)
+            bump(v);
+        });
+      };
+      ForEachNeighbor(u, siblings);
+    };
+
+    // Vertices with no positive score are seeded in descending degree order
+    pvector<NodeID_> seeds(num_nodes_);
+    {
+      pvector<DegreeNodePair> by_degree(num_nodes_);
+      #pragma omp parallel for
+      for (NodeID_ n=0; n < num_nodes_; n++)
+        by_degree[n] = std::make_pair(-Degree(n), n);
+      ParallelSort(by_degree.begin(), by_degree.end(),
+                   std::less<DegreeNodePair>());
+      #pragma omp parallel for
+      for (NodeID_ i=0; i < num_nodes_; i++)
+        seeds[i] = by_degree[i].second;
+    }
+    NodeID_ next_seed = 0;
+    for (NodeID_ i=0; i < num_nodes_; i++) {
+      NodeID_ chosen = -1;
+      while (!heap.empty()) {
+        DegreeNodePair top = heap.top();
+        heap.pop();
+        if (!placed[top.second] && score[top.second] == top.first) {
+          chosen = top.second;
+          break;
+        }
+      }
+      if (chosen == -1) {
+        while (placed[seeds[next_seed]])
+          next_seed++;
+        chosen = seeds[next_seed];
+      }
+      placed[chosen] = true;
+      order[i] = chosen;
+      update_scores(chosen, 1);
+      if (i >= kWindow)
+        update_scores(order[i - kWindow], -1);
+    }
+    return OrderToNewIDs(order);
+  }
+};
+
+
+// Convenience wrapper deducing the graph type
+template <typename NodeID_, typename DestID_, bool MakeInverse>
+CSRGraph<NodeID_, DestID_, MakeInverse> ReorderGraph(
+    const CSRGraph<NodeID_, DestID_, MakeInverse> &g, ReorderMethod method,
+    VertexMapping<NodeID_> *mapping = nullptr) {
+  return Reorderer<NodeID_, DestID_, MakeInverse>(g).Reorder(method, mapping);
+}
+
+#endif  // REORDER_H_
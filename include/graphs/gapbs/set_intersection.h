@@ -0,0 +1,170 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SET_INTERSECTION_H_
+#define SET_INTERSECTION_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+
+/*
+GAP Benchmark Suite
+Class:  SetIntersection
+
+Sizes of intersections of sorted neighbor lists, e.g. two Neighborhoods (TC,
+Jaccard-style similarity)
+ - Lists must be strictly increasing (SquishCSR removes duplicates and
+   sorts), and are given as iterator ranges
+ - SortedIntersectionSize() picks the kernel by the lengths of the lists:
+   galloping when one is more than kGallopRatio times longer than the other,
+   a block merge otherwise
+ - GallopingIntersectionSize() looks every element of the short list up in
+   the long one with an exponential search from the previous match, so it
+   reads O(short * log(long / short)) elements instead of both lists
+ - MergeIntersectionSize() merges the lists a block of 4 elements at a time
+   for 32-bit IDs given as pointers (the Neighborhood iterator outside of
+   trace builds): each element of one block is compared to the 4 rotations
+   of the other block at once, the equal lanes are counted and the block
+   with the smaller last element moves on. SSE2 on x86-64 and NEON on
+   AArch64; other element types, other iterators (TracedIterator records
+   every element read) and the tails of the lists use a plain merge
+*/
+
+
+namespace intersection {
+
+// Above this ratio of list lengths galloping beats the block merge
+const size_t kGallopRatio = 32;
+
+template <typename IterA, typename IterB>
+size_t ScalarMerge(IterA a, IterA a_end, IterB b, IterB b_end) {
+  size_t count = 0;
+  while (a != a_end && b != b_end) {
+    if (*a < *b) {
+      ++a;
+    } else if (*b < *a) {
+      ++b;
+    } else {
+      count++;
+      ++a;
+      ++b;
+    }
+  }
+  return count;
+}
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+// Intersection size of strictly increasing 32-bit lists, 4 elements at a
+// time until either has fewer than 4 left
+template <typename T>
+size_t BlockMerge(const T *&a, const T *a_end, const T *&b, const T *b_end) {
+  size_t count = 0;
+  while (a_end - a >= 4 && b_end - b >= 4) {
+#if defined(__SSE2__)
+    const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    __m128i eq = _mm_cmpeq_epi32(va, vb);
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4e)));
+    eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93)));
+    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+#else
+    const uint32x4_t va = vld1q_u32(reinterpret_cast<const uint32_t*>(a));
+    const uint32x4_t vb = vld1q_u32(reinterpret_cast<const uint32_t*>(b));
+    uint32x4_t eq = vceqq_u32(va, vb);
+    eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 1)));
+    eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 2)));
+    eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 3)));
+    const uint32x4_t ones = vshrq_n_u32(eq, 31);
+    count += vgetq_lane_u32(ones, 0) + vgetq_lane_u32(ones, 1) +
+             vgetq_lane_u32(ones, 2) + vgetq_lane_u32(ones, 3);
+#endif
+    // a common element is counted when the blocks holding it meet; they do
+    // since neither moves past an element the other could still match
+    const T a_last = a[3];
+    const T b_last = b[3];
+    if (a_last <= b_last)
+      a += 4;
+    if (b_last <= a_last)
+      b += 4;
+  }
+  return count;
+}
+#endif
+
+template <typename IterA, typename IterB>
+size_t MergeIntersectionSize(IterA a, IterA a_end, IterB b, IterB b_end) {
+#if defined(__SSE2__) || defined(__ARM_NEON)
+  if constexpr (std::is_pointer<IterA>::value &&
+                std::is_same<IterA, IterB>::value) {
+    typedef typename std::remove_cv<
+        typename std::remove_pointer<IterA>::type>::type T;
+    if constexpr (std::is_integral<T>::value && sizeof(T) == 4) {
+      const T *pa = a;
+      const T *pb = b;
+      size_t count = BlockMerge(pa, static_cast<const T*>(a_end),
+                                pb, static_cast<const T*>(b_end));
+      return count + ScalarMerge(pa, static_cast<const T*>(a_end),
+                                 pb, static_cast<const T*>(b_end));
+    }
+  }
+#endif
+  return ScalarMerge(a, a_end, b, b_end);
+}
+
+// small is the shorter list
+template <typename IterS, typename IterL>
+size_t GallopingIntersectionSize(IterS small, IterS small_end,
+                                 IterL large, IterL large_end) {
+  size_t count = 0;
+  for (; small != small_end && large != large_end; ++small) {
+    const auto target = *small;
+    // grow the step until large[step] >= target, then search the last step
+    typename std::iterator_traits<IterL>::difference_type step = 1;
+    while (step < large_end - large && large[step] < target)
+      step *= 2;
+    IterL last = large + std::min(step + 1, large_end - large);
+    large = std::lower_bound(large + step / 2, last, target);
+    if (large != large_end && !(target < *large)) {
+      count++;
+      ++large;
+    }
+  }
+  return count;
+}
+
+}  // namespace intersection
+
+
+template <typename IterA, typename IterB>
+size_t SortedIntersectionSize(IterA a, IterA a_end, IterB b, IterB b_end) {
+  using namespace intersection;
+  const size_t a_size = std::distance(a, a_end);
+  const size_t b_size = std::distance(b, b_end);
+  if (a_size == 0 || b_size == 0)
+    return 0;
+  if (a_size * kGallopRatio < b_size)
+    return GallopingIntersectionSize(a, a_end, b, b_end);
+  if (b_size * kGallopRatio < a_size)
+    return GallopingIntersectionSize(b, b_end, a, a_end);
+  return MergeIntersectionSize(a, a_end, b, b_end);
+}
+
+// Over two ranges with begin() and end(), e.g. g.out_neigh(u), g.out_neigh(v)
+template <typename RangeA, typename RangeB>
+size_t SortedIntersectionSize(RangeA &&a, RangeB &&b) {
+  return SortedIntersectionSize(a.begin(), a.end(), b.begin(), b.end());
+}
+
+#endif  // SET_INTERSECTION_H_
@@ -0,0 +1,378 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef SHARED_GRAPH_H_
+#define SHARED_GRAPH_H_
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "graph.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  SharedGraphSegment, OpenSharedGraph
+
+Read-only CSRGraph shared by several processes through a named POSIX
+shared-memory object (shm_open, so it shows up as /dev/shm/<name>)
+ - OpenSharedGraph(name, key, build) returns the graph of segment name. The
+   first process to open the name runs build() and copies the graph into the
+   segment; the others wait for it and map the segment without copying, so
+   the graph is in memory once however many workers run over it (plus the
+   builder's private copy while it is being copied)
+ - Every process maps the segment at the address its builder chose
+   (MAP_FIXED_NOREPLACE in an otherwise unused region), so the index arrays'
+   pointers hold in all of them and the graph's array descriptors, hence the
+   job descriptors built from them, are the same bytes in every process
+ - key describes the input (BuilderBase::SharedGraphKey); a process whose
+   key differs from the segment's refuses to attach rather than run on
+   another graph
+ - The arrays are mapped read-only, so a kernel writing to the graph faults
+ - The last process to drop the graph removes the name. A builder that died
+   before finishing is detected (and its name removed) by the waiting
+   processes; a segment left by a process killed after that stays until
+   rm /dev/shm/<name>, and a later run with the same key reuses it
+*/
+
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+
+struct SharedGraphHeader {
+  // kEmpty until the builder has filled in builder_pid and key
+  enum State : uint64_t { kEmpty, kBuilding, kReady };
+
+  std::atomic<uint64_t> state;
+  std::atomic<uint64_t> attached;
+  int64_t builder_pid;
+  char key[256];
+  uint64_t base;
+  uint64_t size;
+  uint64_t directed;
+  int64_t num_nodes;
+  // Byte offsets from base, in_* are 0 without an inverse
+  uint64_t out_index;
+  uint64_t out_neighbors;
+  uint64_t in_index;
+  uint64_t in_neighbors;
+};
+
+
+class SharedGraphSegment {
+ public:
+  static const uint64_t kPageBytes = 4096;
+  static const uint64_t kHeaderBytes = kPageBytes;
+
+  static_assert(sizeof(SharedGraphHeader) <= kHeaderBytes,
+                "header does not fit its page");
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "the header's counters must be lock-free to be shared");
+
+  // Opens name, creating it if no process has; created() tells which
+  SharedGraphSegment(const std::string &name, const std::string &key) :
+      name_(name[0] == '/' ? name : "/" + name), key_(key.substr(0, 255)),
+      created_(false), fd_(-1), header_(nullptr), size_(0) {
+    fd_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ != -1) {
+      created_ = true;
+      if (ftruncate(fd_, kHeaderBytes) != 0)
+        Fail("couldn't size");
+      header_ = new (MapHeader()) SharedGraphHeader();
+      header_->builder_pid = getpid();
+      std::strncpy(header_->key, key_.c_str(), sizeof(header_->key) - 1);
+      header_->attached.store(1);
+      header_->state.store(SharedGraphHeader::kBuilding,
+                           std::memory_order_release);
+    } else if (errno == EEXIST) {
+      fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+    }
+    if (fd_ == -1)
+      Fail("couldn't open");
+  }
+
+  ~SharedGraphSegment() {
+    if (header_ != nullptr) {
+      if (header_->attached.fetch_sub(1) == 1)
+        shm_unlink(name_.c_str());
+      munmap(header_, size_ != 0 ? size_ : kHeaderBytes);
+    }
+    if (fd_ != -1)
+      close(fd_);
+  }
+
+  SharedGraphSegment(const SharedGraphSegment&) = delete;
+  SharedGraphSegment& operator=(const SharedGraphSegment&) = delete;
+
+  bool created() const { return created_; }
+  const std::string& name() const { return name_; }
+  SharedGraphHeader* header() const { return header_; }
+
+  uint8_t* base() const { return reinterpret_cast<uint8_t*>(header_); }
+
+  // Builder: grows the segment by array_bytes after the header and maps it,
+  // writable, at an address free for every process that may attach
+  uint8_t* Allocate(uint64_t array_bytes) {
+    uint64_t size = kHeaderBytes + RoundUp(array_bytes, kPageBytes);
+    if (ftruncate(fd_, size) != 0)
+      Fail("couldn't size");
+    munmap(header_, kHeaderBytes);
+    uint64_t step = RoundUp(size, kRegionSlotBytes);
+    uint64_t hint = kRegionStart +
+        (std::hash<std::string>()(name_) % kRegionSlots) * kRegionSlotBytes;
+    void *mapped = MAP_FAILED;
+    for (int attempt = 0; attempt < 64 && mapped == MAP_FAILED; attempt++) {
+      mapped = MapAt(hint + attempt * step, size, PROT_READ | PROT_WRITE);
+    }
+    if (mapped == MAP_FAILED)
+      Fail("found no free address range for");
+    header_ = static_cast<SharedGraphHeader*>(mapped);
+    size_ = size;
+    header_->base = reinterpret_cast<uint64_t>(mapped);
+    header_->size = size;
+    return base();
+  }
+
+  // Builder: makes the arrays read-only and lets the waiting processes in
+  void Publish() {
+    mprotect(base() + kHeaderBytes, size_ - kHeaderBytes, PROT_READ);
+    header_->state.store(SharedGraphHeader::kReady,
+                         std::memory_order_release);
+  }
+
+  // Others: waits for the builder and maps the segment at its address
+  void Attach() {
+    SharedGraphHeader *header = WaitUntilReady();
+    header->attached.fetch_add(1);
+    uint64_t base = header->base;
+    uint64_t size = header->size;
+    void *mapped = MapAt(base, size, PROT_READ);
+    if (mapped == MAP_FAILED) {
+      if (header->attached.fetch_sub(1) == 1)
+        shm_unlink(name_.c_str());
+      munmap(header, kHeaderBytes);
+      std::cout << "Shared graph " << name_ << " is mapped at 0x" << std::hex
+                << base << std::dec << ", which is taken in this process"
+                << std::endl;
+      std::exit(-42);
+    }
+    munmap(header, kHeaderBytes);
+    header_ = static_cast<SharedGraphHeader*>(mapped);
+    size_ = size;
+    mprotect(header_, kHeaderBytes, PROT_READ | PROT_WRITE);
+  }
+
+ private:
+  // Segments are placed from 16 TiB up, far above the heap and below the
+  // shared libraries and stacks, in slots chosen by a hash of the name
+  static const uint64_t kRegionStart = 1ULL << 44;
+  static const uint64_t kRegionSlotBytes = 1ULL << 30;
+  static const uint64_t kRegionSlots = 1024;
+
+  std::string name_;
+  std::string key_;
+  bool created_;
+  int fd_;
+  SharedGraphHeader *header_;
+  uint64_t size_;
+
+  static uint64_t RoundUp(uint64_t x, uint64_t to) {
+    return (x + to - 1) / to * to;
+  }
+
+  void* MapHeader() {
+    void *mapped = mmap(nullptr, kHeaderBytes, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd_, 0);
+    if (mapped == MAP_FAILED)
+      Fail("couldn't map");
+    return mapped;
+  }
+
+  // Kernels older than 4.17 take MAP_FIXED_NOREPLACE as a hint only
+  void* MapAt(uint64_t addr, uint64_t size, int prot) {
+    void *mapped = mmap(reinterpret_cast<void*>(addr), size, prot,
+                        MAP_SHARED | MAP_FIXED_NOREPLACE, fd_, 0);
+    if (mapped != MAP_FAILED && reinterpret_cast<uint64_t>(mapped) != addr) {
+      munmap(mapped, size);
+      return MAP_FAILED;
+    }
+    return mapped;
+  }
+
+  SharedGraphHeader* WaitUntilReady() {
+    // The builder sizes the object and fills in the header right after
+    // creating it, so an empty one for long is someone else's
+    const int kEmptyPolls = 10000;
+    const useconds_t kPollMicros = 1000;
+    struct stat st;
+    int polls = 0;
+    for (; fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) <
+             kHeaderBytes; polls++) {
+      if (polls == kEmptyPolls)
+        Fail("was never set up in");
+      usleep(kPollMicros);
+    }
+    SharedGraphHeader *header = static_cast<SharedGraphHeader*>(MapHeader());
+    bool reported = false;
+    while (true) {
+      uint64_t state = header->state.load(std::memory_order_acquire);
+      if (state == SharedGraphHeader::kEmpty) {
+        if (++polls == kEmptyPolls)
+          Fail("was never set up in");
+      } else {
+        if (std::strncmp(header->key, key_.c_str(), sizeof(header->key)) != 0) {
+          std::cout << "Shared graph " << name_ << " holds \"" << header->key
+                    << "\", not \"" << key_ << "\"" << std::endl;
+          std::exit(-41);
+        }
+        if (state == SharedGraphHeader::kReady)
+          return header;
+        if (kill(header->builder_pid, 0) != 0 && errno == ESRCH) {
+          shm_unlink(name_.c_str());
+          std::cout << "Process " << header->builder_pid << " building shared"
+                    << " graph " << name_ << " exited before finishing; "
+                    << "removed it, run again" << std::endl;
+          std::exit(-43);
+        }
+        if (!reported) {
+          std::cout << "Waiting for process " << header->builder_pid
+                    << " to build shared graph " << name_ << std::endl;
+          reported = true;
+        }
+      }
+      usleep(kPollMicros);
+    }
+  }
+
+  void Fail(const std::string &what) {
+    std::cout << "Shared graph: " << what << " " << name_ << ": "
+              << std::strerror(errno) << std::endl;
+    std::exit(-40);
+  }
+};
+
+
+// The graph whose arrays the segment holds; the graph keeps the segment
+// mapped for as long as it (or a graph moved from it) lives
+template <typename NodeID_, typename DestID_, bool invert>
+CSRGraph<NodeID_, DestID_, invert> SharedGraphOf(
+    std::shared_ptr<SharedGraphSegment> segment) {
+  const SharedGraphHeader *h = segment->header();
+  uint8_t *base = segment->base();
+  DestID_ **out_index = reinterpret_cast<DestID_**>(base + h->out_index);
+  DestID_ *out_neighs = reinterpret_cast<DestID_*>(base + h->out_neighbors);
+  if (!h->directed)
+    return CSRGraph<NodeID_, DestID_, invert>(h->num_nodes, out_index,
+                                              out_neighs, segment);
+  DestID_ **in_index = nullptr;
+  DestID_ *in_neighs = nullptr;
+  if (h->in_index != 0) {
+    in_index = reinterpret_cast<DestID_**>(base + h->in_index);
+    in_neighs = reinterpret_cast<DestID_*>(base + h->in_neighbors);
+  }
+  return CSRGraph<NodeID_, DestID_, invert>(h->num_nodes, out_index,
+                                            out_neighs, in_index, in_neighs,
+                                            segment);
+}
+
+
+// Copies g's arrays into a segment the calling process created, rebasing
+// the index pointers onto the copies, and publishes it
+template <typename NodeID_, typename DestID_, bool invert>
+CSRGraph<NodeID_, DestID_, invert> PublishSharedGraph(
+    std::shared_ptr<SharedGraphSegment> segment,
+    const CSRGraph<NodeID_, DestID_, invert> &g) {
+  const uint64_t kAlign = SharedGraphSegment::kPageBytes;
+  int64_t n = g.num_nodes();
+  uint64_t m = g.num_edges_directed();
+  bool inverse = g.directed() && invert;
+  uint64_t index_bytes = (n + 1) * sizeof(DestID_*);
+  uint64_t neigh_bytes = m * sizeof(DestID_);
+  auto padded = [kAlign](uint64_t bytes) {
+    return (bytes + kAlign - 1) / kAlign * kAlign;
+  };
+  uint64_t array_bytes = padded(index_bytes) + padded(neigh_bytes);
+  if (inverse)
+    array_bytes *= 2;
+  uint8_t *base = segment->Allocate(array_bytes);
+  SharedGraphHeader *h = segment->header();
+  h->directed = g.directed();
+  h->num_nodes = n;
+  h->out_index = SharedGraphSegment::kHeaderBytes;
+  h->out_neighbors = h->out_index + padded(index_bytes);
+  h->in_index = inverse ? h->out_neighbors + padded(neigh_bytes) : 0;
+  h->in_neighbors = inverse ? h->in_index + padded(index_bytes) : 0;
+
+  DestID_ **out_index = reinterpret_cast<DestID_**>(base + h->out_index);
+  DestID_ *out_neighs = reinterpret_cast<DestID_*>(base + h->out_neighbors);
+  const DestID_ *g_out_neighs = reinterpret_cast<const DestID_*>(
+      g.getOutNeighborsAddressRange().start);
+  #pragma omp parallel for
+  for (int64_t v = 0; v <= n; v++)
+    out_index[v] = out_neighs + g.out_offset(v);
+  #pragma omp parallel for
+  for (uint64_t e = 0; e < m; e++)
+    out_neighs[e] = g_out_neighs[e];
+  if constexpr (invert) {
+    if (inverse) {
+      DestID_ **in_index = reinterpret_cast<DestID_**>(base + h->in_index);
+      DestID_ *in_neighs = reinterpret_cast<DestID_*>(base + h->in_neighbors);
+      const DestID_ *g_in_neighs = reinterpret_cast<const DestID_*>(
+          g.getInNeighborsAddressRange().start);
+      #pragma omp parallel for
+      for (int64_t v = 0; v <= n; v++)
+        in_index[v] = in_neighs + g.in_offset(v);
+      #pragma omp parallel for
+      for (uint64_t e = 0; e < m; e++)
+        in_neighs[e] = g_in_neighs[e];
+    }
+  }
+  segment->Publish();
+  return SharedGraphOf<NodeID_, DestID_, invert>(segment);
+}
+
+
+// The graph of segment name: built with build() and published by the first
+// process to get here, mapped by the others
+template <typename NodeID_, typename DestID_, bool invert, typename BuildFunc>
+CSRGraph<NodeID_, DestID_, invert> OpenSharedGraph(const std::string &name,
+                                                   const std::string &key,
+                                                   BuildFunc build) {
+  auto segment = std::make_shared<SharedGraphSegment>(name, key);
+  Timer t;
+  if (segment->created()) {
+    CSRGraph<NodeID_, DestID_, invert> g = build();
+    t.Start();
+    CSRGraph<NodeID_, DestID_, invert> shared =
+        PublishSharedGraph(segment, g);
+    t.Stop();
+    PrintTime("Share Time", t.Seconds());
+    return shared;
+  }
+  t.Start();
+  segment->Attach();
+  t.Stop();
+  PrintTime("Attach Time", t.Seconds());
+  return SharedGraphOf<NodeID_, DestID_, invert>(segment);
+}
+
+#endif  // SHARED_GRAPH_H_
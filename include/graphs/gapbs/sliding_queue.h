@@ -12,6 +12,10 @@
 #include "platform_atomics.h"
 #include "pickle_job.h"
 
+#if PICKLE_TRACE_ACCESSES==1
+#include "access_recorder.h"
+#endif
+
 /*
 GAP Benchmark Suite
 Class:  SlidingQueue
@@ -20,6 +24,8 @@ Author: Scott Beamer
 Double-buffered queue so appends aren't seen until SlideWindow() called
  - Use QueueBuffer when used in parallel to avoid false sharing by doing
    bulk appends from thread-local storage
+ - With PICKLE_TRACE_ACCESSES=1, iterators report the elements they read to
+   the AccessRecorder (access_recorder.h)
 */
 
 
@@ -75,6 +81,17 @@ class SlidingQueue {
     shared_out_end = shared_in;
   }
 
+#if PICKLE_TRACE_ACCESSES==1
+  typedef TracedIterator<T> iterator;
+
+  iterator begin() const {
+    return iterator(shared + shared_out_start, shared, array_descriptor.get());
+  }
+
+  iterator end() const {
+    return iterator(shared + shared_out_end, shared, array_descriptor.get());
+  }
+#else
   typedef T* iterator;
 
   iterator begin() const {
@@ -84,6 +101,7 @@ class SlidingQueue {
   iterator end() const {
     return shared + shared_out_end;
   }
+#endif
 
   size_t size() const {
     return end() - begin();
@@ -110,7 +128,7 @@ class SlidingQueue {
   }
 
   void indexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) {
-    descriptor->dst_indexing_array_id = this->getArrayId();
+    descriptor->dst_indexing_array_id = this->array_descriptor->getArrayId();
   }
   // -------------------------- Interface END ---------------------------
 
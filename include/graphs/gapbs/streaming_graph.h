@@ -0,0 +1,283 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef STREAMING_GRAPH_H_
+#define STREAMING_GRAPH_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "graph.h"
+#include "pickle_job.h"
+#include "pvector.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  StreamingGraph
+
+Graph whose neighbor array stays on disk and is streamed shard by shard,
+for graphs larger than memory
+ - Reads a partitioned serialized graph (.sgs, WriterBase::
+   WriteShardedGraph): the in-neighbor lists (the neighbor lists of an
+   undirected graph) cut into edge-balanced shards of consecutive vertices.
+   Only the CSR offsets are resident, O(vertices); the neighbors, O(edges),
+   are mapped one shard at a time
+ - ForEachShard(f) runs f on every shard in order as a pipeline: while f
+   works on shard s, shard s+1 is already mapped and its pages are being
+   read in by the kernel (madvise WILLNEED), and shard s-1 is unmapped.
+   f sends the device the shard's job (its index and neighbor descriptors,
+   retargeted per shard) before computing, so disk reads, device prefetch
+   and compute overlap
+ - A Shard's index holds pointers into its own mapping, like a CSRGraph's,
+   so jobs over a shard have the shape of the in-memory jobs (Pointer mode)
+ - Shards are read-only; the page cache keeps whatever fits, so a graph that
+   does fit is read from disk once
+*/
+
+
+// Layout of a .sgs file: this header, out-offsets and in-offsets
+// (num_nodes+1 SGOffsets each), the shard bounds (num_shards+1 int64_t
+// vertex ids), then, from neighbors_offset (page aligned), the in-neighbor
+// array
+struct ShardedGraphHeader {
+  static constexpr const char* kMagic = "PKSGS001";
+  static const uint64_t kPageBytes = 4096;
+
+  char magic[8];
+  uint64_t directed;
+  int64_t num_nodes;
+  int64_t num_edges_directed;
+  uint64_t element_size;
+  uint64_t num_shards;
+  uint64_t neighbors_offset;
+};
+
+
+template <typename NodeID_, typename DestID_ = NodeID_>
+class StreamingGraph {
+ public:
+  static bool IsShardedGraphFile(const std::string &filename) {
+    const std::string suffix = ".sgs";
+    return filename.size() > suffix.size() &&
+        filename.compare(filename.size() - suffix.size(), suffix.size(),
+                         suffix) == 0;
+  }
+
+  struct Neighborhood {
+    DestID_ *first, *last;
+    DestID_* begin() const { return first; }
+    DestID_* end() const { return last; }
+  };
+
+  class Shard {
+   public:
+    // Maps shard s and starts reading it in
+    Shard(const StreamingGraph &g, int s) :
+        begin_(g.shard_bounds_[s]), end_(g.shard_bounds_[s+1]),
+        index_(end_ - begin_ + 1) {
+      const SGOffset first = g.in_offsets_[begin_];
+      const SGOffset last = g.in_offsets_[end_];
+      const uint64_t start = g.header_.neighbors_offset +
+                             first * sizeof(DestID_);
+      const uint64_t map_start = start / ShardedGraphHeader::kPageBytes *
+                                 ShardedGraphHeader::kPageBytes;
+      map_bytes_ = start - map_start + (last - first) * sizeof(DestID_);
+      map_ = nullptr;
+      DestID_ *neighs = nullptr;
+      if (map_bytes_ != 0) {
+        map_ = mmap(nullptr, map_bytes_, PROT_READ, MAP_SHARED, g.fd_,
+                    map_start);
+        if (map_ == MAP_FAILED) {
+          std::cout << "Couldn't map shard " << s << ": "
+                    << std::strerror(errno) << std::endl;
+          std::exit(-6);
+        }
+        madvise(map_, map_bytes_, MADV_WILLNEED);
+        neighs = reinterpret_cast<DestID_*>(
+            static_cast<char*>(map_) + (start - map_start));
+      }
+      #pragma omp parallel for
+      for (NodeID_ v = begin_; v <= end_; v++)
+        index_[v - begin_] = neighs + (g.in_offsets_[v] - first);
+      neighbors_ = neighs;
+      num_neighbors_ = last - first;
+      ConstructArrayDescriptors();
+    }
+
+    ~Shard() {
+      if (map_ != nullptr)
+        munmap(map_, map_bytes_);
+    }
+
+    Shard(const Shard&) = delete;
+    Shard& operator=(const Shard&) = delete;
+
+    NodeID_ begin() const { return begin_; }
+    NodeID_ end() const { return end_; }
+    int64_t num_nodes() const { return end_ - begin_; }
+
+    // In-neighbors of v, which must be in [begin(), end())
+    Neighborhood in_neigh(NodeID_ v) const {
+      return Neighborhood{index_[v - begin_], index_[v - begin_ + 1]};
+    }
+
+    std::shared_ptr<PickleArrayDescriptor> getIndexArrayDescriptor() const {
+      return index_.getArrayDescriptor();
+    }
+    std::shared_ptr<PickleArrayDescriptor> getNeighborsArrayDescriptor()
+        const {
+      return neighbors_array_descriptor_;
+    }
+
+   private:
+    NodeID_ begin_, end_;
+    void *map_;
+    uint64_t map_bytes_;
+    pvector<DestID_*> index_;
+    DestID_ *neighbors_;
+    int64_t num_neighbors_;
+    std::shared_ptr<PickleArrayDescriptor> neighbors_array_descriptor_;
+
+    // The index (pvector's own descriptor) points into the neighbors
+    void ConstructArrayDescriptors() {
+      neighbors_array_descriptor_ = std::make_shared<PickleArrayDescriptor>();
+      neighbors_array_descriptor_->vaddr_start = (uint64_t)neighbors_;
+      neighbors_array_descriptor_->vaddr_end =
+          (uint64_t)(neighbors_ + num_neighbors_);
+      neighbors_array_descriptor_->element_size = sizeof(DestID_);
+      index_.indexedBy(neighbors_array_descriptor_);
+    }
+  };
+
+  explicit StreamingGraph(const std::string &filename) : fd_(-1) {
+    fd_ = open(filename.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-6);
+    }
+    Timer t;
+    t.Start();
+    if (!ReadAt(&header_, sizeof(header_), 0) ||
+        std::memcmp(header_.magic, ShardedGraphHeader::kMagic, 8) != 0) {
+      std::cout << filename << " is not a sharded graph (.sgs)" << std::endl;
+      std::exit(-5);
+    }
+    if (header_.element_size != sizeof(DestID_)) {
+      std::cout << filename << " holds " << header_.element_size
+                << "-byte neighbors, not " << sizeof(DestID_) << std::endl;
+      std::exit(-5);
+    }
+    const int64_t n = header_.num_nodes;
+    out_offsets_ = pvector<SGOffset>(n + 1);
+    in_offsets_ = pvector<SGOffset>(n + 1);
+    pvector<int64_t> bounds(header_.num_shards + 1);
+    uint64_t at = sizeof(header_);
+    bool ok = ReadAt(out_offsets_.data(), (n + 1) * sizeof(SGOffset), at);
+    at += (n + 1) * sizeof(SGOffset);
+    ok = ok && ReadAt(in_offsets_.data(), (n + 1) * sizeof(SGOffset), at);
+    at += (n + 1) * sizeof(SGOffset);
+    ok = ok && ReadAt(bounds.data(), bounds.size() * sizeof(int64_t), at);
+    if (!ok) {
+      std::cout << "Sharded graph " << filename << " is truncated"
+                << std::endl;
+      std::exit(-5);
+    }
+    shard_bounds_ = pvector<NodeID_>(bounds.size());
+    for (size_t s=0; s < bounds.size(); s++)
+      shard_bounds_[s] = bounds[s];
+    t.Stop();
+    PrintTime("Read Time", t.Seconds());
+  }
+
+  ~StreamingGraph() {
+    if (fd_ != -1)
+      close(fd_);
+  }
+
+  StreamingGraph(const StreamingGraph&) = delete;
+  StreamingGraph& operator=(const StreamingGraph&) = delete;
+
+  bool directed() const { return header_.directed; }
+  int64_t num_nodes() const { return header_.num_nodes; }
+  int64_t num_edges() const {
+    return directed() ? header_.num_edges_directed
+                      : header_.num_edges_directed / 2;
+  }
+  int64_t num_edges_directed() const { return header_.num_edges_directed; }
+
+  int64_t out_degree(NodeID_ v) const {
+    return out_offsets_[v+1] - out_offsets_[v];
+  }
+  int64_t in_degree(NodeID_ v) const {
+    return in_offsets_[v+1] - in_offsets_[v];
+  }
+
+  int num_shards() const { return header_.num_shards; }
+  NodeID_ shard_begin(int s) const { return shard_bounds_[s]; }
+  NodeID_ shard_end(int s) const { return shard_bounds_[s+1]; }
+
+  Range<NodeID_> vertices() const {
+    return Range<NodeID_>(num_nodes());
+  }
+
+  // Runs f(const Shard&) on every shard in order, mapping the next shard
+  // (and so starting its reads) before f runs on the current one
+  template <typename ShardFunc>
+  void ForEachShard(ShardFunc f) const {
+    std::unique_ptr<Shard> current(new Shard(*this, 0));
+    for (int s=0; s < num_shards(); s++) {
+      std::unique_ptr<Shard> next;
+      if (s + 1 < num_shards())
+        next.reset(new Shard(*this, s + 1));
+      f(static_cast<const Shard&>(*current));
+      current = std::move(next);
+    }
+  }
+
+  void PrintStats() const {
+    std::cout << "Graph has " << num_nodes() << " nodes and "
+              << num_edges() << " ";
+    if (!directed())
+      std::cout << "un";
+    std::cout << "directed edges for degree: ";
+    std::cout << num_edges()/num_nodes() << std::endl;
+    std::cout << "Streaming " << num_shards() << " shards of "
+              << num_edges_directed() * sizeof(DestID_) / num_shards()
+              << " bytes on average" << std::endl;
+  }
+
+ private:
+  int fd_;
+  ShardedGraphHeader header_;
+  pvector<SGOffset> out_offsets_;
+  pvector<SGOffset> in_offsets_;
+  pvector<NodeID_> shard_bounds_;
+
+  bool ReadAt(void *dst, uint64_t bytes, uint64_t offset) const {
+    char *p = static_cast<char*>(dst);
+    while (bytes != 0) {
+      ssize_t got = pread(fd_, p, bytes, offset);
+      if (got <= 0)
+        return false;
+      p += got;
+      bytes -= got;
+      offset += got;
+    }
+    return true;
+  }
+};
+
+#endif  // STREAMING_GRAPH_H_
@@ -0,0 +1,302 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef WEIGHTED_GRAPH_H_
+#define WEIGHTED_GRAPH_H_
+
+#include <cinttypes>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <memory>
+
+#include "graph.h"
+#include "pickle_job.h"
+#include "pvector.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  WeightedCSRGraph
+
+Weighted graph in CSR format with neighbor IDs and weights in separate
+arrays (structure of arrays) instead of interleaved NodeWeight elements
+ - Built from a CSRGraph<NodeID_, NodeWeight<NodeID_, WeightT_>>, so the
+   usual Builder, reordering and generators produce its input
+ - out_neigh(n) / in_neigh(n) yield NodeWeight values, so kernels written
+   for CSRGraph with NodeWeight compile unchanged; out_neigh_ids(n) /
+   in_neigh_ids(n) walk the IDs only and never touch the weights
+ - The index holds offsets (AddressingMode::Index) rather than pointers, so
+   the same offsets locate a vertex's IDs and its weights
+ - Each direction has two chains of descriptors: index -> neighbors, which
+   createGraphJobUsing*Edges (wrapper.h) describes, and a second descriptor
+   over the same index memory -> weights, which only
+   createWeightedGraphJobUsing*Edges adds. A weight-agnostic job so pulls
+   sizeof(NodeID_) bytes per edge instead of sizeof(NodeWeight).
+*/
+
+
+template <class NodeID_, class WeightT_, bool MakeInverse = true>
+class WeightedCSRGraph {
+  typedef NodeWeight<NodeID_, WeightT_> WNode_;
+  typedef CSRGraph<NodeID_, WNode_, MakeInverse> AoSGraph;
+
+  // Zips a vertex's IDs and weights into NodeWeight values
+  class WeightedNeighborhood {
+    const NodeID_ *ids_;
+    const WeightT_ *weights_;
+    SGOffset start_, end_;
+   public:
+    class iterator {
+      const NodeID_ *ids_;
+      const WeightT_ *weights_;
+      SGOffset i_;
+     public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef WNode_ value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const WNode_* pointer;
+      typedef WNode_ reference;
+
+      iterator(const NodeID_ *ids, const WeightT_ *weights, SGOffset i) :
+          ids_(ids), weights_(weights), i_(i) {}
+      WNode_ operator*() const { return WNode_(ids_[i_], weights_[i_]); }
+      iterator& operator++() { i_++; return *this; }
+      bool operator==(const iterator &rhs) const { return i_ == rhs.i_; }
+      bool operator!=(const iterator &rhs) const { return i_ != rhs.i_; }
+    };
+
+    WeightedNeighborhood(const NodeID_ *ids, const WeightT_ *weights,
+                         SGOffset start, SGOffset end) :
+        ids_(ids), weights_(weights), start_(start), end_(end) {}
+    iterator begin() const { return iterator(ids_, weights_, start_); }
+    iterator end() const { return iterator(ids_, weights_, end_); }
+  };
+
+  // IDs only
+  class IDNeighborhood {
+    const NodeID_ *begin_, *end_;
+   public:
+    IDNeighborhood(const NodeID_ *begin, const NodeID_ *end) :
+        begin_(begin), end_(end) {}
+    typedef const NodeID_* iterator;
+    iterator begin() const { return begin_; }
+    iterator end() const { return end_; }
+  };
+
+  struct Direction {
+    SGOffset *index = nullptr;
+    NodeID_ *neighbors = nullptr;
+    WeightT_ *weights = nullptr;
+    std::shared_ptr<PickleArrayDescriptor> index_descriptor;
+    std::shared_ptr<PickleArrayDescriptor> weight_index_descriptor;
+    std::shared_ptr<PickleArrayDescriptor> neighbors_descriptor;
+    std::shared_ptr<PickleArrayDescriptor> weights_descriptor;
+  };
+
+  static std::shared_ptr<PickleArrayDescriptor> MakeDescriptor(
+      const void *start, int64_t num_elements, uint64_t element_size) {
+    std::shared_ptr<PickleArrayDescriptor> descriptor(
+        new PickleArrayDescriptor());
+    descriptor->vaddr_start = (uint64_t)start;
+    descriptor->vaddr_end = (uint64_t)start + num_elements * element_size;
+    descriptor->element_size = element_size;
+    return descriptor;
+  }
+
+  void CopyDirection(const AoSGraph &g, bool in_graph, Direction *d) {
+    pvector<SGOffset> offsets = g.VertexOffsets(in_graph);
+    SGOffset num_entries = offsets[num_nodes_];
+    d->index = new SGOffset[num_nodes_ + 1];
+    d->neighbors = new NodeID_[num_entries];
+    d->weights = new WeightT_[num_entries];
+    std::copy(offsets.begin(), offsets.end(), d->index);
+    auto CopyNeighbors = [d] (SGOffset e, auto neighborhood) {
+      for (WNode_ wn : neighborhood) {
+        d->neighbors[e] = wn.v;
+        d->weights[e] = wn.w;
+        e++;
+      }
+    };
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      if constexpr (MakeInverse) {
+        if (in_graph) {
+          CopyNeighbors(d->index[n], g.in_neigh(n));
+          continue;
+        }
+      }
+      CopyNeighbors(d->index[n], g.out_neigh(n));
+    }
+    d->index_descriptor = MakeDescriptor(d->index, num_nodes_ + 1,
+                                         sizeof(SGOffset));
+    d->weight_index_descriptor = MakeDescriptor(d->index, num_nodes_ + 1,
+                                                sizeof(SGOffset));
+    d->neighbors_descriptor = MakeDescriptor(d->neighbors, num_entries,
+                                             sizeof(NodeID_));
+    d->weights_descriptor = MakeDescriptor(d->weights, num_entries,
+                                           sizeof(WeightT_));
+    d->index_descriptor->setAddressingMode(AddressingMode::Index);
+    d->weight_index_descriptor->setAddressingMode(AddressingMode::Index);
+    d->index_descriptor->dst_indexing_array_id =
+        d->neighbors_descriptor->getArrayId();
+    d->weight_index_descriptor->dst_indexing_array_id =
+        d->weights_descriptor->getArrayId();
+  }
+
+  void ReleaseResources() {
+    delete[] out_.index;
+    delete[] out_.neighbors;
+    delete[] out_.weights;
+    if (directed_) {
+      delete[] in_.index;
+      delete[] in_.neighbors;
+      delete[] in_.weights;
+    }
+    out_ = Direction();
+    in_ = Direction();
+  }
+
+ public:
+  explicit WeightedCSRGraph(const AoSGraph &g) :
+      directed_(g.directed()), num_nodes_(g.num_nodes()),
+      num_edges_(g.num_edges()) {
+    CopyDirection(g, false, &out_);
+    if (!directed_)
+      in_ = out_;
+    else if (MakeInverse)
+      CopyDirection(g, true, &in_);
+  }
+
+  WeightedCSRGraph(WeightedCSRGraph&& other) :
+      directed_(other.directed_), num_nodes_(other.num_nodes_),
+      num_edges_(other.num_edges_), out_(other.out_), in_(other.in_) {
+    other.num_nodes_ = -1;
+    other.num_edges_ = -1;
+    other.out_ = Direction();
+    other.in_ = Direction();
+  }
+
+  WeightedCSRGraph(const WeightedCSRGraph&) = delete;
+  WeightedCSRGraph& operator=(const WeightedCSRGraph&) = delete;
+
+  ~WeightedCSRGraph() {
+    ReleaseResources();
+  }
+
+  bool directed() const { return directed_; }
+  int64_t num_nodes() const { return num_nodes_; }
+  int64_t num_edges() const { return num_edges_; }
+
+  int64_t num_edges_directed() const {
+    return directed_ ? num_edges_ : 2*num_edges_;
+  }
+
+  int64_t out_degree(NodeID_ v) const {
+    return out_.index[v+1] - out_.index[v];
+  }
+
+  int64_t in_degree(NodeID_ v) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return in_.index[v+1] - in_.index[v];
+  }
+
+  SGOffset out_offset(NodeID_ v) const {
+    return out_.index[v];
+  }
+
+  SGOffset in_offset(NodeID_ v) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return in_.index[v];
+  }
+
+  WeightedNeighborhood out_neigh(NodeID_ n) const {
+    return WeightedNeighborhood(out_.neighbors, out_.weights, out_.index[n],
+                                out_.index[n+1]);
+  }
+
+  WeightedNeighborhood in_neigh(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return WeightedNeighborhood(in_.neighbors, in_.weights, in_.index[n],
+                                in_.index[n+1]);
+  }
+
+  IDNeighborhood out_neigh_ids(NodeID_ n) const {
+    return IDNeighborhood(out_.neighbors + out_.index[n],
+                          out_.neighbors + out_.index[n+1]);
+  }
+
+  IDNeighborhood in_neigh_ids(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return IDNeighborhood(in_.neighbors + in_.index[n],
+                          in_.neighbors + in_.index[n+1]);
+  }
+
+  void PrintStats() const {
+    std::cout << "Graph has " << num_nodes_ << " nodes and "
+              << num_edges_ << " ";
+    if (!directed_)
+      std::cout << "un";
+    std::cout << "directed edges for degree: ";
+    std::cout << num_edges_/num_nodes_ << std::endl;
+  }
+
+  Range<NodeID_> vertices() const {
+    return Range<NodeID_>(num_nodes());
+  }
+
+  // -------------------- Array descriptor interface --------------------
+  // Same names as CSRGraph, so wrapper.h builds ID-only jobs for either
+  std::shared_ptr<PickleArrayDescriptor> getOutIndexArrayDescriptor() const {
+    return out_.index_descriptor;
+  }
+  void outIndexIndexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) const {
+    descriptor->dst_indexing_array_id = out_.index_descriptor->getArrayId();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getOutNeighborsArrayDescriptor() const {
+    return out_.neighbors_descriptor;
+  }
+
+  std::shared_ptr<PickleArrayDescriptor> getInIndexArrayDescriptor() const {
+    return in_.index_descriptor;
+  }
+  void inIndexIndexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) const {
+    descriptor->dst_indexing_array_id = in_.index_descriptor->getArrayId();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInNeighborsArrayDescriptor() const {
+    return in_.neighbors_descriptor;
+  }
+
+  // The weight chains: index (same memory, own descriptor) -> weights
+  std::shared_ptr<PickleArrayDescriptor> getOutWeightIndexArrayDescriptor() const {
+    return out_.weight_index_descriptor;
+  }
+  void outWeightIndexIndexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) const {
+    descriptor->dst_indexing_array_id = out_.weight_index_descriptor->getArrayId();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getOutWeightsArrayDescriptor() const {
+    return out_.weights_descriptor;
+  }
+
+  std::shared_ptr<PickleArrayDescriptor> getInWeightIndexArrayDescriptor() const {
+    return in_.weight_index_descriptor;
+  }
+  void inWeightIndexIndexedBy(const std::shared_ptr<PickleArrayDescriptor>& descriptor) const {
+    descriptor->dst_indexing_array_id = in_.weight_index_descriptor->getArrayId();
+  }
+  std::shared_ptr<PickleArrayDescriptor> getInWeightsArrayDescriptor() const {
+    return in_.weights_descriptor;
+  }
+  // -------------------------- Interface END ---------------------------
+
+ private:
+  bool directed_;
+  int64_t num_nodes_;
+  int64_t num_edges_;
+  Direction out_;
+  Direction in_;
+};
+
+#endif  // WEIGHTED_GRAPH_H_
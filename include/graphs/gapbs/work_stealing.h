@@ -0,0 +1,230 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef WORK_STEALING_H_
+#define WORK_STEALING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/*
+GAP Benchmark Suite
+Class:  ChaseLevDeque, WorkStealingScheduler
+
+Work-stealing loop scheduler for frontier windows and vertex ranges
+ - Every worker (OpenMP thread) owns a ChaseLevDeque [1] of index ranges: the
+   owner pushes and pops at the bottom without locks, idle workers steal from
+   the top of a random victim's deque with a single CAS
+ - WorkStealingScheduler::For() starts each worker on its static share of
+   [begin, end), then splits lazily: a range larger than the grain is halved,
+   the upper half is pushed for thieves and the worker keeps the lower half,
+   so skewed windows rebalance without a shared counter per chunk
+ - Each time a worker starts on a range it calls publish(worker, begin, end)
+   before the body, which lets kernels announce the range on the worker's
+   progress channel so the device follows stolen work too
+ - For() is a worksharing construct like "omp for": call it from inside a
+   parallel region, with every thread of the team; it ends with a barrier
+
+[1] Nhat Minh Lê, Antoniu Pop, Albert Cohen, and Francesco Zappa Nardelli.
+    "Correct and Efficient Work-Stealing for Weak Memory Models." PPoPP, 2013.
+*/
+
+
+struct IndexRange {
+  int64_t begin;
+  int64_t end;
+
+  int64_t size() const { return end - begin; }
+};
+
+
+class alignas(64) ChaseLevDeque {
+ public:
+  // Lazy halving leaves at most one pending range per level of splitting,
+  // so 64-bit index spaces cannot overflow this
+  static const int64_t kCapacity = 128;
+
+  ChaseLevDeque() : top_(0), bottom_(0) {}
+
+  // Owner only; false if full (the caller then keeps the range)
+  bool Push(IndexRange r) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t >= kCapacity)
+      return false;
+    Store(b, r);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only
+  bool Pop(IndexRange *r) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    *r = Load(b);
+    if (t == b) {
+      // last range, race thieves for it
+      bool won = top_.compare_exchange_strong(t, t + 1,
+                                              std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // Any thread
+  bool Steal(IndexRange *r) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+    *r = Load(t);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<int64_t> begins_[kCapacity];
+  std::atomic<int64_t> ends_[kCapacity];
+
+  void Store(int64_t i, IndexRange r) {
+    begins_[i & (kCapacity - 1)].store(r.begin, std::memory_order_relaxed);
+    ends_[i & (kCapacity - 1)].store(r.end, std::memory_order_relaxed);
+  }
+
+  IndexRange Load(int64_t i) const {
+    return IndexRange{
+        begins_[i & (kCapacity - 1)].load(std::memory_order_relaxed),
+        ends_[i & (kCapacity - 1)].load(std::memory_order_relaxed)};
+  }
+};
+
+
+class WorkStealingScheduler {
+ public:
+  WorkStealingScheduler() : remaining_(0) {
+    deques_.reserve(MaxWorkers());
+    for (int w=0; w < MaxWorkers(); w++)
+      deques_.emplace_back(new ChaseLevDeque());
+  }
+
+  template <typename BodyFunc, typename PublishFunc>
+  void For(int64_t begin, int64_t end, int64_t grain, BodyFunc body,
+           PublishFunc publish) {
+    const int worker = WorkerNum();
+    const int num_workers = NumWorkers();
+    if (num_workers > static_cast<int>(deques_.size())) {
+      std::cout << "WorkStealingScheduler: team of " << num_workers
+                << " exceeds " << deques_.size() << " workers" << std::endl;
+      std::exit(-31);
+    }
+    grain = std::max<int64_t>(grain, 1);
+    #pragma omp single
+    remaining_.store(end - begin, std::memory_order_relaxed);
+    // implicit barrier of single: remaining_ is set before any work starts
+    ChaseLevDeque &own = *deques_[worker];
+    int64_t length = end - begin;
+    IndexRange r{begin + length * worker / num_workers,
+                 begin + length * (worker + 1) / num_workers};
+    bool have_range = r.size() > 0;
+    uint64_t victim_state = 0x9E3779B97F4A7C15ULL * (worker + 1);
+    while (true) {
+      if (!have_range)
+        have_range = own.Pop(&r) ||
+                     StealOnce(worker, num_workers, &victim_state, &r);
+      if (have_range) {
+        while (r.size() > grain) {
+          int64_t mid = r.begin + r.size() / 2;
+          if (!own.Push(IndexRange{mid, r.end}))
+            break;
+          r.end = mid;
+        }
+        publish(worker, r.begin, r.end);
+        for (int64_t i = r.begin; i < r.end; i++)
+          body(i);
+        remaining_.fetch_sub(r.size(), std::memory_order_acq_rel);
+        have_range = false;
+      } else if (remaining_.load(std::memory_order_acquire) == 0) {
+        break;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    #pragma omp barrier
+  }
+
+  template <typename BodyFunc>
+  void For(int64_t begin, int64_t end, int64_t grain, BodyFunc body) {
+    For(begin, end, grain, body, [](int, int64_t, int64_t) {});
+  }
+
+  static int WorkerNum() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+ private:
+  std::vector<std::unique_ptr<ChaseLevDeque>> deques_;
+  std::atomic<int64_t> remaining_;
+
+  static int NumWorkers() {
+#ifdef _OPENMP
+    return omp_get_num_threads();
+#else
+    return 1;
+#endif
+  }
+
+  static int MaxWorkers() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  // Tries each other worker once, starting from a random one
+  bool StealOnce(int worker, int num_workers, uint64_t *state,
+                 IndexRange *r) {
+    if (num_workers == 1)
+      return false;
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    int start = *state % num_workers;
+    for (int i=0; i < num_workers; i++) {
+      int victim = (start + i) % num_workers;
+      if (victim != worker && deques_[victim]->Steal(r))
+        return true;
+    }
+    return false;
+  }
+};
+
+#endif  // WORK_STEALING_H_
@@ -8,7 +8,9 @@
 #ifndef WRAPPER_H
 #define WRAPPER_H
 
+#include <memory>
 #include <string>
+#include <vector>
 
 template <typename Graph, typename TIncomingEdgeSelector, typename TIncomingEdgeConsumer>
 PickleJob createGraphJobUsingIncomingEdges(
@@ -74,4 +76,169 @@ PickleJob createGraphJobUsingOutgoingEdges(
     return job;
 }
 
+// A new descriptor over the same memory as descriptor, with its own id and no
+// target, so one array can start a second chain in the same job
+inline std::shared_ptr<PickleArrayDescriptor> aliasArrayDescriptor(
+    const std::shared_ptr<PickleArrayDescriptor>& descriptor
+)
+{
+    std::shared_ptr<PickleArrayDescriptor> alias(new PickleArrayDescriptor());
+    alias->setName(descriptor->name);
+    alias->vaddr_start = descriptor->vaddr_start;
+    alias->vaddr_end = descriptor->vaddr_end;
+    alias->element_size = descriptor->element_size;
+    alias->setAccessType(descriptor->access_type);
+    alias->setAddressingMode(descriptor->addressing_mode);
+    return alias;
+}
+
+// A new descriptor over elements [first, last) of descriptor's array, with
+// its own id and no target
+inline std::shared_ptr<PickleArrayDescriptor> sliceArrayDescriptor(
+    const std::shared_ptr<PickleArrayDescriptor>& descriptor,
+    uint64_t first, uint64_t last
+)
+{
+    std::shared_ptr<PickleArrayDescriptor> slice = aliasArrayDescriptor(descriptor);
+    slice->vaddr_start = descriptor->vaddr_start + first * descriptor->element_size;
+    slice->vaddr_end = descriptor->vaddr_start + last * descriptor->element_size;
+    return slice;
+}
+
+// The job of createGraphJobUsing*Edges restricted to vertices
+// [begin, end): index entries begin..end (end is the bound of the last
+// list) -> the neighbor lists of those vertices -> consumer. There is no
+// selector since the vertex range itself drives the job.
+template <typename TEdgeConsumer>
+PickleJob createGraphSubJob(
+    const std::string kernel_name,
+    const std::shared_ptr<PickleArrayDescriptor>& index,
+    const std::shared_ptr<PickleArrayDescriptor>& neighbors,
+    int64_t begin, int64_t end, int64_t first_edge, int64_t last_edge,
+    TEdgeConsumer edgeConsumer
+)
+{
+    PickleJob job(kernel_name);
+
+    std::shared_ptr<PickleArrayDescriptor> index_slice =
+        sliceArrayDescriptor(index, begin, end + 1);
+    std::shared_ptr<PickleArrayDescriptor> neighbors_slice =
+        sliceArrayDescriptor(neighbors, first_edge, last_edge);
+    index_slice->dst_indexing_array_id = neighbors_slice->getArrayId();
+    job.addArrayDescriptor(index_slice);
+    job.addArrayDescriptor(neighbors_slice);
+
+    if constexpr (!std::is_same<TEdgeConsumer, std::nullptr_t>::value)
+    {
+        if (edgeConsumer != nullptr)
+        {
+            job.addArrayDescriptor(edgeConsumer->getArrayDescriptor());
+            edgeConsumer->indexedBy(neighbors_slice);
+        }
+    }
+
+    return job;
+}
+
+// One sub-job per part of partition (partition.h), in part order, for
+// loops where thread p walks part p
+template <typename Graph, typename Partition, typename TIncomingEdgeConsumer>
+std::vector<PickleJob> createGraphSubJobsUsingIncomingEdges(
+    const Graph* g,
+    const std::string kernel_name,
+    const Partition& partition,
+    TIncomingEdgeConsumer incomingEdgeConsumer
+)
+{
+    std::vector<PickleJob> jobs;
+    for (int p = 0; p < partition.num_parts(); p++)
+    {
+        jobs.push_back(createGraphSubJob(
+            kernel_name, g->getInIndexArrayDescriptor(),
+            g->getInNeighborsArrayDescriptor(),
+            partition.begin(p), partition.end(p),
+            g->in_offset(partition.begin(p)), g->in_offset(partition.end(p)),
+            incomingEdgeConsumer));
+    }
+    return jobs;
+}
+
+template <typename Graph, typename Partition, typename TOutgoingEdgeConsumer>
+std::vector<PickleJob> createGraphSubJobsUsingOutgoingEdges(
+    const Graph* g,
+    const std::string kernel_name,
+    const Partition& partition,
+    TOutgoingEdgeConsumer outgoingEdgeConsumer
+)
+{
+    std::vector<PickleJob> jobs;
+    for (int p = 0; p < partition.num_parts(); p++)
+    {
+        jobs.push_back(createGraphSubJob(
+            kernel_name, g->getOutIndexArrayDescriptor(),
+            g->getOutNeighborsArrayDescriptor(),
+            partition.begin(p), partition.end(p),
+            g->out_offset(partition.begin(p)), g->out_offset(partition.end(p)),
+            outgoingEdgeConsumer));
+    }
+    return jobs;
+}
+
+// For graphs that keep weights apart from neighbor IDs (WeightedCSRGraph):
+// the job of createGraphJobUsingIncomingEdges plus the chain
+// selector -> weight index -> weights, which needs its own descriptor for
+// the selector since a descriptor has a single target
+template <typename Graph, typename TIncomingEdgeSelector, typename TIncomingEdgeConsumer>
+PickleJob createWeightedGraphJobUsingIncomingEdges(
+    const Graph* g,
+    const std::string kernel_name,
+    TIncomingEdgeSelector incomingEdgeSelector, TIncomingEdgeConsumer incomingEdgeConsumer
+)
+{
+    PickleJob job = createGraphJobUsingIncomingEdges(
+        g, kernel_name, incomingEdgeSelector, incomingEdgeConsumer);
+
+    if constexpr (!std::is_same<TIncomingEdgeSelector, std::nullptr_t>::value)
+    {
+        if (incomingEdgeSelector != nullptr)
+        {
+            std::shared_ptr<PickleArrayDescriptor> selector =
+                aliasArrayDescriptor(incomingEdgeSelector->getArrayDescriptor());
+            job.addArrayDescriptor(selector);
+            g->inWeightIndexIndexedBy(selector);
+        }
+    }
+    job.addArrayDescriptor(g->getInWeightIndexArrayDescriptor());
+    job.addArrayDescriptor(g->getInWeightsArrayDescriptor());
+
+    return job;
+}
+
+// Outgoing-edge counterpart of createWeightedGraphJobUsingIncomingEdges
+template <typename Graph, typename TOutgoingEdgeSelector, typename TOutgoingEdgeConsumer>
+PickleJob createWeightedGraphJobUsingOutgoingEdges(
+    const Graph* g,
+    const std::string kernel_name,
+    TOutgoingEdgeSelector outgoingEdgeSelector, TOutgoingEdgeConsumer outgoingEdgeConsumer
+)
+{
+    PickleJob job = createGraphJobUsingOutgoingEdges(
+        g, kernel_name, outgoingEdgeSelector, outgoingEdgeConsumer);
+
+    if constexpr (!std::is_same<TOutgoingEdgeSelector, std::nullptr_t>::value)
+    {
+        if (outgoingEdgeSelector != nullptr)
+        {
+            std::shared_ptr<PickleArrayDescriptor> selector =
+                aliasArrayDescriptor(outgoingEdgeSelector->getArrayDescriptor());
+            job.addArrayDescriptor(selector);
+            g->outWeightIndexIndexedBy(selector);
+        }
+    }
+    job.addArrayDescriptor(g->getOutWeightIndexArrayDescriptor());
+    job.addArrayDescriptor(g->getOutWeightsArrayDescriptor());
+
+    return job;
+}
+
 #endif // WRAPPER_H
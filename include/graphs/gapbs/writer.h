@@ -0,0 +1,186 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#ifndef WRITER_H_
+#define WRITER_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+
+#include "pvector.h"
+#include "compressed_graph.h"
+#include "graph.h"
+#include "partition.h"
+#include "streaming_graph.h"
+#include "timer.h"
+#include "util.h"
+
+
+/*
+GAP Benchmark Suite
+Class:  Writer
+Author: Scott Beamer
+
+Given filename and graph, writes out the graph to storage
+ - Should helpful for graph conversion
+ - Can also write graph as serialized (binary) format
+ - or as a partitioned serialized graph (.sgs) for StreamingGraph
+   (streaming_graph.h), its in-neighbor lists cut into edge-balanced shards
+ - or as a compressed serialized graph (.csg, compressed_graph.h), its
+   neighbor lists delta encoded and bit packed
+*/
+
+
+template <typename NodeID_, typename DestID_ = NodeID_>
+class WriterBase {
+ public:
+  explicit WriterBase(const CSRGraph<NodeID_, DestID_> &g) : g_(g) {}
+
+  void WriteEL(std::fstream &out) {
+    for (NodeID_ u=0; u < g_.num_nodes(); u++) {
+      for (DestID_ v : g_.out_neigh(u))
+        out << u << " " << v << "\n";
+    }
+  }
+
+  void WriteSerializedGraph(std::fstream &out) {
+    if (!std::is_same<NodeID_, SGID>::value) {
+      std::cout << "serialized graphs only allowed for 32bit" << std::endl;
+      std::exit(-5);
+    }
+    if (!std::is_same<DestID_, NodeID_>::value &&
+        !std::is_same<DestID_, NodeWeight<NodeID_, SGID>>::value) {
+      std::cout << ".wsg only allowed for int32_t weights" << std::endl;
+      std::exit(-8);
+    }
+    bool directed = g_.directed();
+    SGOffset num_nodes = g_.num_nodes();
+    SGOffset edges_to_write = g_.num_edges_directed();
+    std::streamsize index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    std::streamsize neigh_bytes;
+    if (std::is_same<DestID_, NodeID_>::value)
+      neigh_bytes = edges_to_write * sizeof(SGID);
+    else
+      neigh_bytes = edges_to_write * sizeof(NodeWeight<NodeID_, SGID>);
+    out.write(reinterpret_cast<char*>(&directed), sizeof(bool));
+    out.write(reinterpret_cast<char*>(&edges_to_write), sizeof(SGOffset));
+    out.write(reinterpret_cast<char*>(&num_nodes), sizeof(SGOffset));
+    pvector<SGOffset> offsets = g_.VertexOffsets(false);
+    out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    out.write(reinterpret_cast<char*>(g_.out_neigh(0).begin()), neigh_bytes);
+    if (directed) {
+      offsets = g_.VertexOffsets(true);
+      out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+      out.write(reinterpret_cast<char*>(g_.in_neigh(0).begin()), neigh_bytes);
+    }
+  }
+
+  void WriteShardedGraph(std::fstream &out, int num_shards) {
+    ShardedGraphHeader h = {};
+    std::memcpy(h.magic, ShardedGraphHeader::kMagic, sizeof(h.magic));
+    VertexPartition<NodeID_> part =
+        VertexPartition<NodeID_>::EdgeBalancedIncoming(g_, num_shards);
+    SGOffset num_nodes = g_.num_nodes();
+    h.directed = g_.directed();
+    h.num_nodes = num_nodes;
+    h.num_edges_directed = g_.num_edges_directed();
+    h.element_size = sizeof(DestID_);
+    h.num_shards = part.num_parts();
+    std::streamsize index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    std::streamsize bounds_bytes = (h.num_shards+1) * sizeof(int64_t);
+    const uint64_t kPage = ShardedGraphHeader::kPageBytes;
+    h.neighbors_offset = (sizeof(h) + 2*index_bytes + bounds_bytes + kPage-1)
+                         / kPage * kPage;
+    out.write(reinterpret_cast<char*>(&h), sizeof(h));
+    pvector<SGOffset> offsets = g_.VertexOffsets(false);
+    out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    offsets = g_.VertexOffsets(true);
+    out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    pvector<int64_t> bounds(h.num_shards+1);
+    for (uint64_t p=0; p < h.num_shards; p++)
+      bounds[p] = part.begin(p);
+    bounds[h.num_shards] = num_nodes;
+    out.write(reinterpret_cast<char*>(bounds.data()), bounds_bytes);
+    std::string padding(h.neighbors_offset - out.tellp(), '\0');
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(
+                  g_.getInNeighborsAddressRange().start),
+              h.num_edges_directed * sizeof(DestID_));
+  }
+
+  void WriteCompressedGraph(std::fstream &out) {
+    if constexpr (std::is_same<DestID_, NodeID_>::value &&
+                  std::is_same<NodeID_, SGID>::value) {
+      CompressedGraph<NodeID_> cg(g_);
+      cg.PrintStats();
+      cg.Write(out);
+    } else {
+      std::cout << ".csg only allowed for unweighted 32bit graphs"
+                << std::endl;
+      std::exit(-5);
+    }
+  }
+
+  void WriteGraph(std::string filename, bool serialized = false) {
+    if (filename == "") {
+      std::cout << "No output filename given (Use -h for help)" << std::endl;
+      std::exit(-8);
+    }
+    Timer t;
+    t.Start();
+    std::fstream file(filename, std::ios::out | std::ios::binary);
+    if (!file) {
+      std::cout << "Couldn't write to file " << filename << std::endl;
+      std::exit(-5);
+    }
+    if (serialized)
+      WriteSerializedGraph(file);
+    else
+      WriteEL(file);
+    file.close();
+    t.Stop();
+    PrintTime("Write Time", t.Seconds());
+    std::cout << "Wrote graph to file: " << filename << std::endl;
+  }
+
+  void WriteShardedGraph(std::string filename, int num_shards) {
+    Timer t;
+    t.Start();
+    std::fstream file(filename, std::ios::out | std::ios::binary);
+    if (!file) {
+      std::cout << "Couldn't write to file " << filename << std::endl;
+      std::exit(-5);
+    }
+    WriteShardedGraph(file, num_shards);
+    file.close();
+    t.Stop();
+    PrintTime("Write Time", t.Seconds());
+    std::cout << "Wrote " << num_shards << " shards to file: " << filename
+              << std::endl;
+  }
+
+  void WriteCompressedGraph(std::string filename) {
+    Timer t;
+    t.Start();
+    std::fstream file(filename, std::ios::out | std::ios::binary);
+    if (!file) {
+      std::cout << "Couldn't write to file " << filename << std::endl;
+      std::exit(-5);
+    }
+    WriteCompressedGraph(file);
+    file.close();
+    t.Stop();
+    PrintTime("Write Time", t.Seconds());
+    std::cout << "Wrote compressed graph to file: " << filename << std::endl;
+  }
+
+ private:
+  const CSRGraph<NodeID_, DestID_> &g_;
+};
+
+#endif  // WRITER_H_
@@ -16,17 +16,27 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "pickle_generator_registry.h"
 #include "pickle_job.h"
 #include "pickle_utils.h"
 
-enum PickleDeviceCommand { ADD_WATCH_RANGE = 1, SEND_JOB_DESCRIPTOR = 2 };
+// SUBMIT_JOB, RELEASE_JOB and SET_JOB_PRIORITY need protocol version 2
+enum PickleDeviceCommand {
+  ADD_WATCH_RANGE = 1,
+  SEND_JOB_DESCRIPTOR = 2,
+  SUBMIT_JOB = 3,
+  RELEASE_JOB = 4,
+  SET_JOB_PRIORITY = 5
+};
 enum PrefetchMode { UNKNOWN = 0, SINGLE_PREFETCH = 1, BULK_PREFETCH = 2 };
 struct PickleDevicePrefetcherSpecs {
   uint64_t availability;
@@ -35,23 +45,92 @@ struct PickleDevicePrefetcherSpecs {
   uint64_t bulk_mode_chunk_size;
 };
 
+// How a submitted job shares the device with the other active jobs.
+// Priorities are relative weights: a job gets priority / (sum over active
+// jobs) of the prefetch bandwidth. Progress channels are the mmap_ids of the
+// uncacheable pages whose progress drives the job (see
+// allocateProgressChannels); an empty set means every channel.
+struct PickleJobOptions {
+  uint64_t priority = 1;
+  std::vector<uint64_t> progress_channels;
+};
+
+// One manager drives one device node. Systems with a device per socket
+// expose /dev/hey_pickle0, /dev/hey_pickle1, ...; single-device systems the
+// plain /dev/hey_pickle. PICKLE_DEVICE_PATH replaces the /dev/hey_pickle
+// base, e.g. to point tests at stand-in nodes.
 class PickleDeviceManager {
  public:
+  // The first device of enumerateDevices()
   PickleDeviceManager();
+  explicit PickleDeviceManager(const std::string& device_path);
+  // Releases the active jobs and unmaps every page the manager mapped
   ~PickleDeviceManager();
+  // $PICKLE_DEVICE_PATH, else /dev/hey_pickle
+  static std::string getDevicePathBase();
+  // <base>0, <base>1, ... up to the first missing number; else <base> alone,
+  // which is also returned when no node exists so that opening it reports
+  // the missing device
+  static std::vector<std::string> enumerateDevices();
+  const std::string& getDevicePath() const;
+  // Resolves the job against the generator registry and the device
+  // capabilities first; returns false without sending if it is rejected.
+  // Every job call also takes a ready descriptor (getJobDescriptor layout),
+  // e.g. from a PickleStaticJob (pickle_job_shape.h); the PickleJob
+  // overloads build theirs and go the same way.
   bool sendJob(const PickleJob& job);
+  bool sendJob(const std::vector<uint8_t>& job_descriptor);
+  PickleJobResolution resolveJob(const PickleJob& job);
+  PickleJobResolution resolveJob(const std::vector<uint8_t>& job_descriptor);
+  // Concurrent jobs: submitJob returns the new job's id (0 if rejected) and
+  // the job stays active until released. Devices before protocol version 2
+  // run one job at a time; the manager then keeps the highest-priority
+  // active job (the latest among equals) loaded. Thread-safe.
+  uint64_t submitJob(const PickleJob& job, const PickleJobOptions& options);
+  uint64_t submitJob(const std::vector<uint8_t>& job_descriptor,
+                     const PickleJobOptions& options);
+  bool setJobPriority(const uint64_t job_id, const uint64_t priority);
+  bool releaseJob(const uint64_t job_id);
+  std::vector<uint64_t> getActiveJobIds();
+  // Maps count fresh progress pages, so several users of one manager never
+  // share a channel; returns their mmap_ids
+  std::vector<uint64_t> allocateProgressChannels(const uint64_t count);
   uint8_t* getUCPagePtr(const uint64_t mmap_id);
   uint8_t* getPerfPagePtr();
   PickleDevicePrefetcherSpecs getDevicePrefetcherSpecs();
+  // Queried once; drivers without the query report protocol version 0
+  const PickleDeviceCapabilities& getDeviceCapabilities();
+  PickleGeneratorRegistry& getGeneratorRegistry();
 
  private:
+  std::string device_path;
   std::unordered_map<uint64_t, uint8_t*> mmap_id_to_uc_ptr_map;
   std::unordered_map<uint64_t, uint64_t> mmap_id_to_uc_paddr_map;
   uint8_t* perf_page_ptr;
+  bool capabilities_queried;
+  PickleDeviceCapabilities capabilities;
+  PickleGeneratorRegistry generator_registry;
+  struct ActiveJob {
+    std::vector<uint8_t> job_descriptor;  // resolved
+    PickleJobOptions options;
+    uint64_t sequence;
+  };
+  std::map<uint64_t, ActiveJob> active_jobs;
+  uint64_t next_job_id;
+  uint64_t next_job_sequence;
+  uint64_t loaded_job_id;  // single-job devices: the job the device runs
+  uint64_t next_channel_id;
+  // Serializes device commands (each is two writes) and guards the state
+  // above; recursive since getUCPagePtr is also called internally
+  std::recursive_mutex manager_mutex;
+  bool runsConcurrentJobs();
+  bool loadHighestPriorityJob();
   void registerUncacheablePage(const uint64_t mmap_id, uint8_t* ptr,
                                uint64_t paddr);
   void deallocateUncacheablePage(const uint64_t mmap_id);
   bool writeUncacheablePagePaddr(const uint64_t mmap_id);
   bool writeJobToPickleDevice(const std::vector<uint8_t>& job_descriptor);
+  bool writeSubmitJobToPickleDevice(const uint64_t job_id,
+                                    const ActiveJob& active_job);
 };
 #endif  // PICKLE_LIBRARY_H
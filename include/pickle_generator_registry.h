@@ -0,0 +1,196 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PICKLE_GENERATOR_REGISTRY_H
+#define PICKLE_GENERATOR_REGISTRY_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pickle_job.h"
+
+// What the device reported about itself. Protocol version 0 is a driver
+// without the capability query: nothing beyond the prefetcher specs is known,
+// so generators_known is false and every generator is assumed present.
+struct PickleGeneratorInfo {
+  uint64_t id;
+  std::string name;
+};
+
+struct PickleDeviceCapabilities {
+  uint64_t protocol_version = 0;
+  uint64_t max_arrays_per_job = 255;  // the descriptor counts arrays in 8 bits
+  uint64_t max_watch_ranges = 0;       // 0 = not reported
+  uint64_t max_watch_range_bytes = 0;  // 0 = not reported
+  uint64_t max_concurrent_jobs = 1;    // reported from protocol version 2
+  bool generators_known = false;
+  std::vector<PickleGeneratorInfo> generators;
+
+  bool supportsGenerator(uint64_t id) const {
+    if (!generators_known)
+      return true;
+    for (const PickleGeneratorInfo& g : generators) {
+      if (g.id == id)
+        return true;
+    }
+    return false;
+  }
+
+  bool supportsGeneratorName(const std::string& name) const {
+    if (!generators_known)
+      return true;
+    for (const PickleGeneratorInfo& g : generators) {
+      if (g.name == name)
+        return true;
+    }
+    return false;
+  }
+};
+
+// Per-kernel overrides of the device specs for the library side, e.g. how far
+// ahead a kernel publishes progress; 0 keeps the device's own value
+struct PickleGeneratorTunables {
+  uint64_t prefetch_distance = 0;
+  uint64_t bulk_mode_chunk_size = 0;
+};
+
+struct PickleGeneratorEntry {
+  uint64_t generator_id;
+  // kernel to use instead when the device lacks this generator, "" for none
+  std::string fallback;
+  PickleGeneratorTunables tunables;
+};
+
+enum PickleJobVerdict { JOB_ACCEPTED = 0, JOB_DOWNGRADED = 1, JOB_REJECTED = 2 };
+
+struct PickleJobResolution {
+  PickleJobVerdict verdict;
+  std::string kernel_name;  // the name to send, after any downgrade
+  uint64_t generator_id;    // 0 if the kernel is not registered
+  PickleGeneratorTunables tunables;
+  std::string reason;       // why it was downgraded or rejected
+};
+
+// Maps the kernel names jobs carry to device generator ids and tunables and
+// checks a job against the device's capabilities before it is sent
+class PickleGeneratorRegistry {
+ public:
+  // Generator ids of the kernels shipped in kernels/
+  enum DefaultGenerator : uint64_t {
+    BFS_GENERATOR = 1,
+    BFS_BOTTOM_UP_GENERATOR = 2,
+    PAGERANK_GENERATOR = 3,
+    SSSP_GENERATOR = 4,
+    CC_GENERATOR = 5,
+    BC_GENERATOR = 6,
+    TC_GENERATOR = 7,
+    MSBFS_GENERATOR = 8
+  };
+
+  PickleGeneratorRegistry() { registerDefaults(); }
+
+  void registerKernel(const std::string& kernel_name,
+                      const PickleGeneratorEntry& entry) {
+    entries[kernel_name] = entry;
+  }
+
+  bool isRegistered(const std::string& kernel_name) const {
+    return entries.find(kernel_name) != entries.end();
+  }
+
+  const PickleGeneratorEntry& getEntry(const std::string& kernel_name) const {
+    return entries.at(kernel_name);
+  }
+
+  // Follows fallbacks until a kernel the device can run is found.
+  // Unregistered kernels are sent as named if the device has a generator by
+  // that name (or does not list its generators).
+  PickleJobResolution resolve(const PickleJob& job,
+                              const PickleDeviceCapabilities& caps) const {
+    return resolve(job.getKernelName(), job.getNumArrays(),
+                   job.usesAccessType(AccessType::SetBits), caps);
+  }
+
+  PickleJobResolution resolve(const std::vector<uint8_t>& job_descriptor,
+                              const PickleDeviceCapabilities& caps) const {
+    return resolve(pickleJobDescriptorKernelName(job_descriptor),
+                   pickleJobDescriptorNumArrays(job_descriptor),
+                   pickleJobDescriptorUsesAccessType(job_descriptor,
+                                                     AccessType::SetBits),
+                   caps);
+  }
+
+  PickleJobResolution resolve(const std::string& kernel_name,
+                              size_t num_arrays, bool uses_set_bits,
+                              const PickleDeviceCapabilities& caps) const {
+    PickleJobResolution res;
+    res.verdict = JOB_ACCEPTED;
+    res.kernel_name = kernel_name;
+    res.generator_id = 0;
+    if (num_arrays > caps.max_arrays_per_job) {
+      res.verdict = JOB_REJECTED;
+      res.reason = std::to_string(num_arrays) +
+                   " arrays exceed the device limit of " +
+                   std::to_string(caps.max_arrays_per_job);
+      return res;
+    }
+    if (caps.protocol_version < 1 && uses_set_bits) {
+      res.verdict = JOB_REJECTED;
+      res.reason = "SetBits arrays need protocol version 1, device has " +
+                   std::to_string(caps.protocol_version);
+      return res;
+    }
+    std::unordered_set<std::string> visited;
+    while (true) {
+      auto it = entries.find(res.kernel_name);
+      if (it == entries.end()) {
+        if (!caps.supportsGeneratorName(res.kernel_name)) {
+          res.verdict = JOB_REJECTED;
+          res.reason = "no generator for unregistered kernel " +
+                       res.kernel_name;
+        }
+        return res;
+      }
+      const PickleGeneratorEntry& entry = it->second;
+      res.generator_id = entry.generator_id;
+      res.tunables = entry.tunables;
+      if (caps.supportsGenerator(entry.generator_id))
+        return res;
+      visited.insert(res.kernel_name);
+      if (entry.fallback.empty() || visited.count(entry.fallback) != 0) {
+        res.verdict = JOB_REJECTED;
+        res.reason = "device lacks generator " +
+                     std::to_string(entry.generator_id) + " for " +
+                     res.kernel_name + " and it has no usable fallback";
+        return res;
+      }
+      res.reason = "device lacks generator " +
+                   std::to_string(entry.generator_id) + " for " +
+                   res.kernel_name + ", using " + entry.fallback;
+      res.verdict = JOB_DOWNGRADED;
+      res.kernel_name = entry.fallback;
+    }
+  }
+
+ private:
+  std::unordered_map<std::string, PickleGeneratorEntry> entries;
+
+  void registerDefaults() {
+    // sssp, bc and msbfs jobs start with the same out-edge chain as bfs, so a
+    // bfs generator still prefetches their neighbor lists
+    registerKernel("bfs", {BFS_GENERATOR, "", {}});
+    registerKernel("bfs-bu", {BFS_BOTTOM_UP_GENERATOR, "", {}});
+    registerKernel("pr", {PAGERANK_GENERATOR, "", {}});
+    registerKernel("sssp", {SSSP_GENERATOR, "bfs", {}});
+    registerKernel("cc", {CC_GENERATOR, "", {}});
+    registerKernel("bc", {BC_GENERATOR, "bfs", {}});
+    registerKernel("tc", {TC_GENERATOR, "", {}});
+    registerKernel("msbfs", {MSBFS_GENERATOR, "bfs", {}});
+  }
+};
+
+#endif  // PICKLE_GENERATOR_REGISTRY_H
@@ -6,8 +6,6 @@
 #ifndef PICKLE_JOB_LIBRARY_H
 #define PICKLE_JOB_LIBRARY_H
 
-#include "pickle_driver.h"
-
 #include <array>
 #include <chrono>
 #include <cstdint>
@@ -23,20 +21,22 @@
 #include "pickle_utils.h"
 
 // public API
-enum AccessType { SingleElement = 0, Ranged = 1 };
+// SetBits: the array is a bitmap; each set bit is one element whose position
+// is the index it contributes (as a selector) or is looked up by (as a target)
+enum AccessType { SingleElement = 0, Ranged = 1, SetBits = 2 };
 enum AddressingMode { Pointer = 0, Index = 1 };
 
 class PickleArrayDescriptor
 {
     private:
-        const static uint64_t unassignedID; // a value indicating the ID has not been assigned yet
+        inline const static uint64_t unassignedID = 0; // a value indicating the ID has not been assigned yet
         static uint64_t assignNextId()
         {
             uint64_t id = PickleArrayDescriptor::nextID;
             PickleArrayDescriptor::nextID += 1;
             return id;
         }
-        static uint64_t nextID;
+        inline static uint64_t nextID = 1;
         uint64_t array_id;
     public:
         std::string name;
@@ -100,7 +100,8 @@ class PickleArrayDescriptor
         void print() const
         {
             std::string am = (addressing_mode == AddressingMode::Index) ? "Index" : "Pointer";
-            std::string at = (access_type == AccessType::Ranged) ? "Ranged" : "Single";
+            std::string at = (access_type == AccessType::Ranged) ? "Ranged" :
+                             (access_type == AccessType::SetBits) ? "SetBits" : "Single";
             std::cout << "array_id: " << array_id << std::endl \
                       << "- name: " << name << std::endl \
                       << "- dst_array: " << dst_indexing_array_id << std::endl \
@@ -113,7 +114,8 @@ class PickleArrayDescriptor
         void print(const std::unordered_map<uint64_t, uint64_t>& rename_map) const
         {
             std::string am = (addressing_mode == AddressingMode::Index) ? "Index" : "Pointer";
-            std::string at = (access_type == AccessType::Ranged) ? "Ranged" : "Single";
+            std::string at = (access_type == AccessType::Ranged) ? "Ranged" :
+                             (access_type == AccessType::SetBits) ? "SetBits" : "Single";
             std::cout << "array_id: " << rename_map.at(array_id) << std::endl \
                       << "- name: " << name << std::endl \
                       << "- dst_array: " << rename_map.at(dst_indexing_array_id) << std::endl \
@@ -197,6 +199,27 @@ class PickleJob
             renameCount++;
             arrays.push_back(array);
         }
+        const std::string& getKernelName() const
+        {
+            return kernel_name;
+        }
+        void setKernelName(const std::string& _kernel_name)
+        {
+            kernel_name = _kernel_name;
+        }
+        size_t getNumArrays() const
+        {
+            return arrays.size();
+        }
+        bool usesAccessType(const AccessType& accessType) const
+        {
+            for (const auto& array: arrays)
+            {
+                if (array->access_type == accessType)
+                    return true;
+            }
+            return false;
+        }
         std::vector<uint8_t> getJobDescriptor() const
         {
             // layout: 8 bits for the number of arrays + number_of_arrays * (7 * 64 bits) for the array description
@@ -232,7 +255,40 @@ class PickleJob
         }
 };
 
-uint64_t PickleArrayDescriptor::nextID = 1;
-const uint64_t PickleArrayDescriptor::unassignedID = 0;
+// Reading back a descriptor laid out as in PickleJob::getJobDescriptor, for
+// jobs that only exist as descriptors (PickleStaticJob, pickle_job_shape.h)
+const size_t pickleJobDescriptorArrayBytes = 7 * 8;
+
+inline size_t pickleJobDescriptorNumArrays(const std::vector<uint8_t>& job_descriptor)
+{
+    return job_descriptor.empty() ? 0 : job_descriptor[0];
+}
+
+inline std::string pickleJobDescriptorKernelName(const std::vector<uint8_t>& job_descriptor)
+{
+    const size_t name_offset = 1 + pickleJobDescriptorNumArrays(job_descriptor) * pickleJobDescriptorArrayBytes;
+    if (job_descriptor.size() <= name_offset)
+        return "";
+    return std::string(job_descriptor.begin() + name_offset, job_descriptor.end());
+}
+
+inline void pickleJobDescriptorSetKernelName(std::vector<uint8_t>& job_descriptor, const std::string& kernel_name)
+{
+    job_descriptor.resize(1 + pickleJobDescriptorNumArrays(job_descriptor) * pickleJobDescriptorArrayBytes);
+    job_descriptor.insert(job_descriptor.end(), kernel_name.begin(), kernel_name.end());
+}
+
+inline bool pickleJobDescriptorUsesAccessType(const std::vector<uint8_t>& job_descriptor, const AccessType& accessType)
+{
+    const size_t n_arrays = pickleJobDescriptorNumArrays(job_descriptor);
+    for (size_t i = 0; i < n_arrays; i++)
+    {
+        // the access type is the sixth field of an array, little-endian
+        const size_t offset = 1 + i * pickleJobDescriptorArrayBytes + 5 * 8;
+        if (offset < job_descriptor.size() && job_descriptor[offset] == accessType)
+            return true;
+    }
+    return false;
+}
 
 #endif // PICKLE_JOB_LIBRARY_H
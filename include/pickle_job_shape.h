@@ -0,0 +1,330 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PICKLE_JOB_SHAPE_H
+#define PICKLE_JOB_SHAPE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "pickle_job.h"
+
+// Jobs whose chain of arrays is fixed at compile time.
+//
+// A kernel names each array of its job with an empty tag type and links the
+// tags into a shape:
+//
+//   struct Contributions : PickleShapeArray<> {};
+//   typedef PickleChain<PickleInIndex, PickleInNeighbors, Contributions> Shape;
+//
+// PickleChain<A, B, C> is A -> B -> C. PickleJobShape<PickleLink<A, B>, ...>
+// lists arrays in descriptor order, each with the tag it indexes (none when
+// left out), for shapes that are not a plain chain. The shape is checked at
+// compile time (no tag twice, every target in the shape, no cycle, at most
+// 255 arrays), array ids are the positions in the list, and the tags carry
+// the addressing mode of their values and their access type.
+//
+// PickleStaticJob<Shape> lays out the whole descriptor (getJobDescriptor
+// layout) once, at construction; set<Tag>() then only writes the array's
+// address range and element size in place, so a job resent every step costs
+// no allocation, no shared_ptr and no rename map. The device manager takes
+// the descriptor directly (sendJob / submitJob overloads).
+
+template <AddressingMode Mode = AddressingMode::Pointer,
+          AccessType Access = AccessType::SingleElement>
+struct PickleShapeArray {
+  static constexpr AddressingMode addressing_mode = Mode;
+  static constexpr AccessType access_type = Access;
+};
+
+// The CSR arrays, with the modes and access types of the graphs' own
+// descriptors, so a shape over them describes the same job as the
+// createGraphJobUsing*Edges builders (wrapper.h)
+struct PickleOutIndex : PickleShapeArray<> {};
+struct PickleOutNeighbors : PickleShapeArray<> {};
+struct PickleInIndex : PickleShapeArray<> {};
+struct PickleInNeighbors : PickleShapeArray<> {};
+
+// The delta CSR arrays of a DynamicGraph (dynamic_graph.h)
+struct PickleOutDeltaIndex : PickleShapeArray<> {};
+struct PickleOutDeltaNeighbors : PickleShapeArray<> {};
+struct PickleInDeltaIndex : PickleShapeArray<> {};
+struct PickleInDeltaNeighbors : PickleShapeArray<> {};
+
+template <typename Source, typename Target = void>
+struct PickleLink {
+  typedef Source source;
+  typedef Target target;
+};
+
+const uint64_t kPickleShapeNoTarget = -1ULL;
+
+// Position of T in Ts, or sizeof...(Ts) if it is not there
+template <typename T, typename... Ts>
+constexpr size_t PickleShapeIndexOf() {
+  constexpr bool same[] = {std::is_same<T, Ts>::value..., false};
+  for (size_t i = 0; i < sizeof...(Ts); i++) {
+    if (same[i])
+      return i;
+  }
+  return sizeof...(Ts);
+}
+
+template <typename Link, typename... Links>
+constexpr uint64_t PickleShapeTargetOf() {
+  if constexpr (std::is_void<typename Link::target>::value)
+    return kPickleShapeNoTarget;
+  else
+    return PickleShapeIndexOf<typename Link::target,
+                              typename Links::source...>();
+}
+
+template <typename... Ts>
+constexpr bool PickleShapeUnique() {
+  constexpr size_t first[] = {PickleShapeIndexOf<Ts, Ts...>()..., 0};
+  for (size_t i = 0; i < sizeof...(Ts); i++) {
+    if (first[i] != i)
+      return false;
+  }
+  return true;
+}
+
+constexpr bool PickleShapeTargetsKnown(const uint64_t* targets, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (targets[i] != kPickleShapeNoTarget && targets[i] >= n)
+      return false;
+  }
+  return true;
+}
+
+// Every walk along the targets ends within n steps (unknown targets are
+// reported by PickleShapeTargetsKnown)
+constexpr bool PickleShapeAcyclic(const uint64_t* targets, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t at = i;
+    for (size_t steps = 0; at < n; steps++) {
+      if (steps == n)
+        return false;
+      at = targets[at];
+    }
+  }
+  return true;
+}
+
+template <typename... Links>
+struct PickleJobShape {
+  static constexpr size_t kNumArrays = sizeof...(Links);
+  static constexpr uint64_t kTargets[] = {
+      PickleShapeTargetOf<Links, Links...>()...};
+  static constexpr AddressingMode kAddressingModes[] = {
+      Links::source::addressing_mode...};
+  static constexpr AccessType kAccessTypes[] = {
+      Links::source::access_type...};
+
+  static_assert(kNumArrays >= 1 && kNumArrays <= 255,
+                "a job has 1 to 255 arrays (the descriptor counts in 8 bits)");
+  static_assert(PickleShapeUnique<typename Links::source...>(),
+                "an array appears twice; give the second use a tag of its own");
+  static_assert(PickleShapeTargetsKnown(kTargets, kNumArrays),
+                "a link targets a tag that is not an array of the shape");
+  static_assert(PickleShapeAcyclic(kTargets, kNumArrays),
+                "the links of a job shape must not form a cycle");
+
+  template <typename Tag>
+  static constexpr size_t IndexOf() {
+    return PickleShapeIndexOf<Tag, typename Links::source...>();
+  }
+
+  template <typename Tag>
+  static constexpr bool Contains() {
+    return IndexOf<Tag>() < kNumArrays;
+  }
+
+  static constexpr bool UsesAccessType(AccessType access_type) {
+    for (size_t i = 0; i < kNumArrays; i++) {
+      if (kAccessTypes[i] == access_type)
+        return true;
+    }
+    return false;
+  }
+};
+
+template <typename... Tags>
+struct PickleChainLinks;
+
+template <typename Last>
+struct PickleChainLinks<Last> {
+  template <typename... Done>
+  using shape = PickleJobShape<Done..., PickleLink<Last>>;
+};
+
+template <typename First, typename Second, typename... Rest>
+struct PickleChainLinks<First, Second, Rest...> {
+  template <typename... Done>
+  using shape = typename PickleChainLinks<Second, Rest...>::template shape<
+      Done..., PickleLink<First, Second>>;
+};
+
+template <typename... Tags>
+using PickleChain = typename PickleChainLinks<Tags...>::template shape<>;
+
+// A DynamicGraph's edges of one direction feeding Consumer: the base CSR
+// chain, then the delta CSR chain, both neighbor arrays indexing Consumer
+template <typename Consumer>
+using PickleOutDeltaChain =
+    PickleJobShape<PickleLink<PickleOutIndex, PickleOutNeighbors>,
+                   PickleLink<PickleOutNeighbors, Consumer>,
+                   PickleLink<PickleOutDeltaIndex, PickleOutDeltaNeighbors>,
+                   PickleLink<PickleOutDeltaNeighbors, Consumer>,
+                   PickleLink<Consumer>>;
+
+template <typename Consumer>
+using PickleInDeltaChain =
+    PickleJobShape<PickleLink<PickleInIndex, PickleInNeighbors>,
+                   PickleLink<PickleInNeighbors, Consumer>,
+                   PickleLink<PickleInDeltaIndex, PickleInDeltaNeighbors>,
+                   PickleLink<PickleInDeltaNeighbors, Consumer>,
+                   PickleLink<Consumer>>;
+
+
+template <typename Shape>
+class PickleStaticJob {
+ public:
+  explicit PickleStaticJob(const std::string& kernel_name)
+      : kernel_name(kernel_name),
+        job_descriptor(1 + Shape::kNumArrays * pickleJobDescriptorArrayBytes +
+                       kernel_name.size()),
+        filled{} {
+    job_descriptor[0] = Shape::kNumArrays;
+    for (size_t i = 0; i < Shape::kNumArrays; i++) {
+      put(i, 0, i);
+      put(i, 1, Shape::kTargets[i]);
+      put(i, 5, Shape::kAccessTypes[i]);
+      put(i, 6, Shape::kAddressingModes[i]);
+    }
+    std::memcpy(job_descriptor.data() + 1 +
+                    Shape::kNumArrays * pickleJobDescriptorArrayBytes,
+                kernel_name.data(), kernel_name.size());
+  }
+
+  template <typename Tag>
+  void set(uint64_t vaddr_start, uint64_t vaddr_end, uint64_t element_size) {
+    constexpr size_t i = Shape::template IndexOf<Tag>();
+    static_assert(i < Shape::kNumArrays, "the job shape has no such array");
+    put(i, 2, vaddr_start);
+    put(i, 3, vaddr_end);
+    put(i, 4, element_size);
+    filled[i] = true;
+  }
+
+  // Takes the address range and element size of a container's descriptor;
+  // the target, mode and access type stay those of the shape
+  template <typename Tag>
+  void set(const PickleArrayDescriptor& descriptor) {
+    set<Tag>(descriptor.vaddr_start, descriptor.vaddr_end,
+             descriptor.element_size);
+  }
+
+  template <typename Tag>
+  void set(const std::shared_ptr<PickleArrayDescriptor>& descriptor) {
+    set<Tag>(*descriptor);
+  }
+
+  // Fills whichever of the CSR (and delta CSR) tags the shape uses from a
+  // graph
+  template <typename Graph>
+  void setGraph(const Graph& g) {
+    if constexpr (Shape::template Contains<PickleOutIndex>())
+      set<PickleOutIndex>(g.getOutIndexArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleOutNeighbors>())
+      set<PickleOutNeighbors>(g.getOutNeighborsArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleInIndex>())
+      set<PickleInIndex>(g.getInIndexArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleInNeighbors>())
+      set<PickleInNeighbors>(g.getInNeighborsArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleOutDeltaIndex>())
+      set<PickleOutDeltaIndex>(g.getOutDeltaIndexArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleOutDeltaNeighbors>())
+      set<PickleOutDeltaNeighbors>(g.getOutDeltaNeighborsArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleInDeltaIndex>())
+      set<PickleInDeltaIndex>(g.getInDeltaIndexArrayDescriptor());
+    if constexpr (Shape::template Contains<PickleInDeltaNeighbors>())
+      set<PickleInDeltaNeighbors>(g.getInDeltaNeighborsArrayDescriptor());
+  }
+
+  // Whether every array has been given its addresses
+  bool complete() const {
+    for (bool f : filled) {
+      if (!f)
+        return false;
+    }
+    return true;
+  }
+
+  const std::vector<uint8_t>& getJobDescriptor() const {
+    return job_descriptor;
+  }
+  const std::string& getKernelName() const { return kernel_name; }
+  static constexpr size_t getNumArrays() { return Shape::kNumArrays; }
+  static constexpr bool usesAccessType(AccessType access_type) {
+    return Shape::UsesAccessType(access_type);
+  }
+
+  void print() const {
+    std::cout << "-----" << std::endl
+              << "kernel_name: " << kernel_name << " (static shape)"
+              << std::endl;
+    for (size_t i = 0; i < Shape::kNumArrays; i++) {
+      std::cout << "array_id: " << i << std::endl << "- dst_array: ";
+      if (Shape::kTargets[i] == kPickleShapeNoTarget)
+        std::cout << "none";
+      else
+        std::cout << Shape::kTargets[i];
+      std::cout << std::endl
+                << "- addressing_mode: "
+                << (Shape::kAddressingModes[i] == AddressingMode::Index
+                        ? "Index"
+                        : "Pointer")
+                << std::endl
+                << "- access_type: "
+                << (Shape::kAccessTypes[i] == AccessType::Ranged    ? "Ranged"
+                    : Shape::kAccessTypes[i] == AccessType::SetBits ? "SetBits"
+                                                                    : "Single")
+                << std::endl
+                << "- vaddr: 0x" << std::hex << get(i, 2) << std::dec
+                << std::endl
+                << "- element_size: " << get(i, 4) << std::endl;
+    }
+    std::cout << "-----" << std::endl;
+  }
+
+ private:
+  std::string kernel_name;
+  std::vector<uint8_t> job_descriptor;
+  std::array<bool, Shape::kNumArrays> filled;
+
+  // field f of array i, little-endian like PickleJob::addToJobDescriptor
+  void put(size_t i, size_t f, uint64_t value) {
+    std::memcpy(job_descriptor.data() + 1 +
+                    i * pickleJobDescriptorArrayBytes + f * 8,
+                &value, sizeof(value));
+  }
+
+  uint64_t get(size_t i, size_t f) const {
+    uint64_t value;
+    std::memcpy(&value, job_descriptor.data() + 1 +
+                            i * pickleJobDescriptorArrayBytes + f * 8,
+                sizeof(value));
+    return value;
+  }
+};
+
+#endif  // PICKLE_JOB_SHAPE_H
@@ -14,6 +14,12 @@ sudo chmod a+rwX /usr/local/lib/libpickledevice.so
 sudo cp include/pickle_job.h /usr/include/
 sudo chmod a+rwX /usr/include/pickle_job.h
 
+sudo cp include/pickle_job_shape.h /usr/include/
+sudo chmod a+rwX /usr/include/pickle_job_shape.h
+
+sudo cp include/pickle_generator_registry.h /usr/include/
+sudo chmod a+rwX /usr/include/pickle_generator_registry.h
+
 sudo cp include/pickle_device_manager.h /usr/include/
 sudo chmod a+rwX /usr/include/pickle_device_manager.h
 
@@ -0,0 +1,265 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/platform_atomics.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/sliding_queue.h"
+#include "graphs/gapbs/timer.h"
+#include "graphs/gapbs/util.h"
+#include "pickle_kernel.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Betweenness Centrality (BC)
+Author: Scott Beamer
+
+Will return array of approx betweenness centrality scores for each vertex
+
+This BC implementation makes use of the Brandes [1] algorithm with
+implementation optimizations from Madduri et al. [2]. It is only approximate
+because it does not compute the paths from every start vertex, but only a small
+subset of them. Additionally, the scores are normalized to the range [0,1].
+
+As an optimization to save memory, this implementation uses the BFS depths to
+recognize successors during back-propagation: v is a successor of u exactly
+when depth[v] = depth[u] + 1 and (u,v) is an edge.
+
+The job handed to the device follows the BFS queue into the out-index, the
+neighbor lists and the depth array the neighbors index into, which serves
+both the forward search and the back-propagation.
+
+[1] Ulrik Brandes. "A faster algorithm for betweenness centrality." Journal of
+    Mathematical Sociology, 25(2):163–177, 2001.
+
+[2] Kamesh Madduri, David Ediger, Karl Jiang, David A Bader, and Daniel
+    Chavarria-Miranda. "A faster parallel algorithm and efficient multithreaded
+    implementations for evaluating betweenness centrality on massive datasets."
+    International Symposium on Parallel & Distributed Processing (IPDPS), 2009.
+*/
+
+
+using namespace std;
+typedef float ScoreT;
+typedef double CountT;
+const ScoreT kRelativeError = 1e-5;
+
+
+void PBFS(const Graph &g, NodeID source, pvector<CountT> &path_counts,
+    pvector<NodeID> &depths, SlidingQueue<NodeID> &queue,
+    vector<SlidingQueue<NodeID>::iterator> &depth_index,
+    PickleKernelContext &ctx) {
+  depths.fill(-1);
+  depths[source] = 0;
+  path_counts[source] = 1;
+  queue.push_back(source);
+  depth_index.push_back(queue.begin());
+  queue.slide_window();
+  #pragma omp parallel
+  {
+    NodeID depth = 0;
+    QueueBuffer<NodeID> lqueue(queue);
+    while (!queue.empty()) {
+      depth++;
+      auto frontier = WithProgress(ctx, queue);
+      #pragma omp for schedule(dynamic, 64) nowait
+      for (auto q_iter = frontier.begin(); q_iter < frontier.end(); q_iter++) {
+        NodeID u = *q_iter;
+        for (NodeID v : g.out_neigh(u)) {
+          if ((depths[v] == -1) &&
+              (compare_and_swap(depths[v], static_cast<NodeID>(-1), depth))) {
+            lqueue.push_back(v);
+          }
+          if (depths[v] == depth) {
+            fetch_and_add(path_counts[v], path_counts[u],
+                          memory_order_relaxed);
+          }
+        }
+      }
+      lqueue.flush();
+      #pragma omp barrier
+      #pragma omp single
+      {
+        depth_index.push_back(queue.begin());
+        queue.slide_window();
+      }
+    }
+  }
+  depth_index.push_back(queue.begin());
+}
+
+
+pvector<ScoreT> Brandes(const Graph &g, SourcePicker<Graph> &sp,
+                        NodeID num_iters, PickleKernelContext &ctx,
+                        bool logging_enabled = false) {
+  Timer t;
+  t.Start();
+  pvector<ScoreT> scores(g.num_nodes(), 0);
+  pvector<CountT> path_counts(g.num_nodes());
+  pvector<NodeID> depths(g.num_nodes());
+  vector<SlidingQueue<NodeID>::iterator> depth_index;
+  SlidingQueue<NodeID> queue(g.num_nodes());
+  t.Stop();
+  if (logging_enabled)
+    PrintStep("a", t.Seconds());
+  ctx.SendJob(createGraphJobUsingOutgoingEdges(&g, "bc", &queue, &depths));
+  NodeID *queue_base = reinterpret_cast<NodeID*>(
+      queue.getArrayDescriptor()->vaddr_start);
+  for (NodeID iter=0; iter < num_iters; iter++) {
+    NodeID source = sp.PickNext();
+    if (logging_enabled)
+      PrintStep("Source", static_cast<int64_t>(source));
+    t.Start();
+    path_counts.fill(0);
+    depth_index.resize(0);
+    queue.reset();
+    PBFS(g, source, path_counts, depths, queue, depth_index, ctx);
+    t.Stop();
+    if (logging_enabled)
+      PrintStep("b", t.Seconds());
+    pvector<ScoreT> deltas(g.num_nodes(), 0);
+    t.Start();
+    for (int d=depth_index.size()-2; d >= 0; d--) {
+      auto level = WithProgress(ctx, depth_index[d], depth_index[d+1],
+                                queue_base);
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (auto it = level.begin(); it < level.end(); it++) {
+        NodeID u = *it;
+        ScoreT delta_u = 0;
+        for (NodeID v : g.out_neigh(u)) {
+          if (depths[v] == depths[u] + 1) {
+            delta_u += (path_counts[u] / path_counts[v]) * (1 + deltas[v]);
+          }
+        }
+        deltas[u] = delta_u;
+        scores[u] += delta_u;
+      }
+    }
+    t.Stop();
+    if (logging_enabled)
+      PrintStep("p", t.Seconds());
+  }
+  // normalize scores
+  ScoreT biggest_score = 0;
+  #pragma omp parallel for reduction(max : biggest_score)
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    biggest_score = max(biggest_score, scores[n]);
+  #pragma omp parallel for
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    scores[n] = scores[n] / biggest_score;
+  return scores;
+}
+
+
+void PrintTopScores(const Graph &g, const pvector<ScoreT> &scores) {
+  int k = 5;
+  vector<pair<ScoreT, NodeID>> top_k = TopK(scores, k);
+  for (auto kvp : top_k)
+    cout << kvp.second << ":" << kvp.first << endl;
+}
+
+
+// Still uses Brandes algorithm, but has the following differences:
+// - serial (no need for atomics or dynamic scheduling)
+// - uses vector for BFS queue
+// - regenerates farthest to closest traversal order from depths
+// - regenerates successors from depths
+// Scores must match to a relative error: both sum the same dependencies, but
+// in an order that depends on the vertex order (-o) and the thread schedule
+bool BCVerifier(const Graph &g, SourcePicker<Graph> &sp, NodeID num_iters,
+                const pvector<ScoreT> &scores_to_test) {
+  pvector<ScoreT> scores(g.num_nodes(), 0);
+  for (int iter=0; iter < num_iters; iter++) {
+    NodeID source = sp.PickNext();
+    // BFS phase, only records depth & path_counts
+    pvector<int> depths(g.num_nodes(), -1);
+    depths[source] = 0;
+    vector<CountT> path_counts(g.num_nodes(), 0);
+    path_counts[source] = 1;
+    vector<NodeID> to_visit;
+    to_visit.reserve(g.num_nodes());
+    to_visit.push_back(source);
+    for (auto it = to_visit.begin(); it != to_visit.end(); it++) {
+      NodeID u = *it;
+      for (NodeID v : g.out_neigh(u)) {
+        if (depths[v] == -1) {
+          depths[v] = depths[u] + 1;
+          to_visit.push_back(v);
+        }
+        if (depths[v] == depths[u] + 1)
+          path_counts[v] += path_counts[u];
+      }
+    }
+    // Get lists of vertices at each depth
+    vector<vector<NodeID>> verts_at_depth;
+    for (NodeID n : g.vertices()) {
+      if (depths[n] != -1) {
+        if (depths[n] >= static_cast<int>(verts_at_depth.size()))
+          verts_at_depth.resize(depths[n] + 1);
+        verts_at_depth[depths[n]].push_back(n);
+      }
+    }
+    // Going from farthest to closest, compute "dependencies" (deltas)
+    pvector<ScoreT> deltas(g.num_nodes(), 0);
+    for (int depth=verts_at_depth.size()-1; depth >= 0; depth--) {
+      for (NodeID u : verts_at_depth[depth]) {
+        for (NodeID v : g.out_neigh(u)) {
+          if (depths[v] == depths[u] + 1) {
+            deltas[u] += (path_counts[u] / path_counts[v]) * (1 + deltas[v]);
+          }
+        }
+        scores[u] += deltas[u];
+      }
+    }
+  }
+  // Normalize scores
+  ScoreT biggest_score = *max_element(scores.begin(), scores.end());
+  for (NodeID n : g.vertices())
+    scores[n] = scores[n] / biggest_score;
+  // Compare scores
+  bool all_ok = true;
+  for (NodeID n : g.vertices()) {
+    ScoreT delta = abs(scores_to_test[n] - scores[n]);
+    if (delta > max(std::numeric_limits<ScoreT>::epsilon(),
+                    kRelativeError * scores[n])) {
+      cout << n << ": " << scores[n] << " != " << scores_to_test[n];
+      cout << "(" << delta << ")" << endl;
+      all_ok = false;
+    }
+  }
+  return all_ok;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLIterApp cli(argc, argv, "betweenness-centrality", 1);
+  if (!cli.ParseArgs())
+    return -1;
+  if (cli.num_iters() > 1 && cli.start_vertex() != -1)
+    cout << "Warning: iterating from same source (-r & -i)" << endl;
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  Reordering<Graph> reordering(cli, g, Reordering<Graph>::kPerVertex);
+  PickleKernelContext ctx;
+  SourcePicker<Graph> sp(g, cli.start_vertex(), reordering.mapping());
+  auto BCBound = [&sp, &cli, &ctx] (const Graph &g) {
+    return Brandes(g, sp, cli.num_iters(), ctx, cli.logging_en());
+  };
+  SourcePicker<Graph> vsp(g, cli.start_vertex());
+  vsp.Skip(cli.num_warmups() * cli.num_iters());
+  auto VerifierBound = [&vsp, &cli] (const Graph &g,
+                                     const pvector<ScoreT> &scores) {
+    return BCVerifier(g, vsp, cli.num_iters(), scores);
+  };
+  bool all_ok = BenchmarkKernel(cli, reordering, BCBound, PrintTopScores,
+                                VerifierBound, ctx.device_info());
+  return all_ok ? 0 : -3;
+}
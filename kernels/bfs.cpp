@@ -0,0 +1,308 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#include <iostream>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/bitmap.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/platform_atomics.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/sliding_queue.h"
+#include "graphs/gapbs/timer.h"
+#include "graphs/gapbs/work_stealing.h"
+#include "pickle_kernel.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Breadth-First Search (BFS)
+Author: Scott Beamer
+
+Will return parent array for a BFS traversal from a source vertex
+
+This BFS implementation makes use of the Direction-Optimizing approach [1].
+It uses the alpha and beta parameters to determine whether to switch search
+directions. For representing the frontier, it uses a SlidingQueue for the
+top-down approach and a Bitmap for the bottom-up approach. To reduce
+false-sharing for the top-down approach, thread-local QueueBuffer's are used.
+
+To save time computing the number of edges exiting the frontier, this
+implementation precomputes the degrees in bulk at the beginning by storing
+them in parent array as negative numbers. Thus the encoding of parent is:
+  parent[x] < 0 implies x is unvisited and parent[x] = -out_degree(x)
+  parent[x] >= 0 implies x been visited
+
+The device gets a job per direction. Top-down steps follow the frontier
+queue into the out-index, the neighbor lists and the parent array the
+neighbors index into. Bottom-up steps walk the in-index and in-neighbor lists
+and look the neighbors up in the frontier bitmap (AccessType::SetBits); that
+job is re-sent every step since the frontier bitmaps are swapped. Both jobs
+have fixed shapes (pickle_job_shape.h), so they are laid out once per search
+and only the frontier bitmap's address changes between sends.
+
+Both steps are scheduled by a WorkStealingScheduler, so a few high-degree
+vertices in one part of the frontier do not leave the other threads idle.
+Whenever a thread starts on a range (its own or a stolen one) it announces
+it with ProgressRange, so the device prefetches for the range actually being
+worked on.
+
+[1] Scott Beamer, Krste Asanović, and David Patterson. "Direction-Optimizing
+    Breadth-First Search." International Conference on High Performance
+    Computing, Networking, Storage and Analysis (SC), Salt Lake City, Utah,
+    November 2012.
+*/
+
+
+using namespace std;
+
+struct FrontierQueue : PickleShapeArray<> {};
+struct Parents : PickleShapeArray<> {};
+struct FrontierBitmap :
+    PickleShapeArray<AddressingMode::Pointer, AccessType::SetBits> {};
+
+// Same arrays and order as createGraphJobUsingOutgoingEdges(&g, "bfs", &queue,
+// &parent) and createGraphJobUsingIncomingEdges(&g, "bfs-bu", nullptr, &front)
+typedef PickleJobShape<PickleLink<PickleOutIndex, PickleOutNeighbors>,
+                       PickleLink<PickleOutNeighbors, Parents>,
+                       PickleLink<FrontierQueue, PickleOutIndex>,
+                       PickleLink<Parents>> TopDownShape;
+typedef PickleChain<PickleInIndex, PickleInNeighbors, FrontierBitmap>
+    BottomUpShape;
+
+// Steals whole bitmap words (64 vertices) so threads never share a word of
+// next and plain set_bit is safe
+int64_t BUStep(const Graph &g, pvector<NodeID> &parent, Bitmap &front,
+               Bitmap &next, WorkStealingScheduler &ws,
+               PickleKernelContext &ctx) {
+  int64_t awake_count = 0;
+  const int64_t kWordBits = Bitmap::kBitsPerWord;
+  next.reset();
+  #pragma omp parallel reduction(+ : awake_count)
+  ws.For(0, next.num_words(), 1024 / kWordBits, [&] (int64_t w) {
+    NodeID word_end = min(g.num_nodes(), (w + 1) * kWordBits);
+    for (NodeID u = w * kWordBits; u < word_end; u++) {
+      if (parent[u] < 0) {
+        ctx.Tick(u);
+        for (NodeID v : g.in_neigh(u)) {
+          if (front.get_bit(v)) {
+            parent[u] = v;
+            awake_count++;
+            next.set_bit(u);
+            break;
+          }
+        }
+      }
+    }
+  }, [&ctx, kWordBits] (int, int64_t begin, int64_t end) {
+    ctx.ProgressRange(begin * kWordBits, end * kWordBits);
+  });
+  return awake_count;
+}
+
+
+int64_t TDStep(const Graph &g, pvector<NodeID> &parent,
+               SlidingQueue<NodeID> &queue, WorkStealingScheduler &ws,
+               PickleKernelContext &ctx) {
+  int64_t scout_count = 0;
+  NodeID *queue_base = reinterpret_cast<NodeID*>(
+      queue.getArrayDescriptor()->vaddr_start);
+  const int64_t window_begin = queue.begin() - queue_base;
+  const int64_t window_end = queue.end() - queue_base;
+  #pragma omp parallel reduction(+ : scout_count)
+  {
+    QueueBuffer<NodeID> lqueue(queue);
+    ws.For(window_begin, window_end, 64, [&] (int64_t i) {
+      NodeID u = queue_base[i];
+      ctx.Tick(i);
+      for (NodeID v : g.out_neigh(u)) {
+        NodeID curr_val = parent[v];
+        if (curr_val < 0) {
+          if (compare_and_swap(parent[v], curr_val, u)) {
+            lqueue.push_back(v);
+            scout_count += -curr_val;
+          }
+        }
+      }
+    }, [&ctx] (int, int64_t begin, int64_t end) {
+      ctx.ProgressRange(begin, end);
+    });
+    lqueue.flush();
+  }
+  return scout_count;
+}
+
+
+pvector<NodeID> InitParent(const Graph &g) {
+  pvector<NodeID> parent(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    parent[n] = g.out_degree(n) != 0 ? -g.out_degree(n) : -1;
+  return parent;
+}
+
+
+pvector<NodeID> DOBFS(const Graph &g, NodeID source, PickleKernelContext &ctx,
+                      bool logging_enabled = false, int alpha = 15,
+                      int beta = 18) {
+  if (logging_enabled)
+    PrintStep("Source", static_cast<int64_t>(source));
+  Timer t;
+  t.Start();
+  pvector<NodeID> parent = InitParent(g);
+  t.Stop();
+  if (logging_enabled)
+    PrintStep("i", t.Seconds());
+  parent[source] = source;
+  SlidingQueue<NodeID> queue(g.num_nodes());
+  queue.push_back(source);
+  queue.slide_window();
+  Bitmap curr(g.num_nodes());
+  curr.reset();
+  Bitmap front(g.num_nodes());
+  front.reset();
+  WorkStealingScheduler ws;
+  PickleStaticJob<TopDownShape> td_job("bfs");
+  td_job.setGraph(g);
+  td_job.set<FrontierQueue>(queue.getArrayDescriptor());
+  td_job.set<Parents>(parent.getArrayDescriptor());
+  PickleStaticJob<BottomUpShape> bu_job("bfs-bu");
+  bu_job.setGraph(g);
+  ctx.SendJob(td_job);
+  int64_t edges_to_check = g.num_edges_directed();
+  int64_t scout_count = g.out_degree(source);
+  while (!queue.empty()) {
+    if (scout_count > edges_to_check / alpha) {
+      int64_t awake_count, old_awake_count;
+      TIME_OP(t, QueueToBitmap(queue, front));
+      if (logging_enabled)
+        PrintStep("e", t.Seconds());
+      awake_count = queue.size();
+      queue.slide_window();
+      do {
+        t.Start();
+        old_awake_count = awake_count;
+        bu_job.set<FrontierBitmap>(front.getArrayDescriptor());
+        ctx.SendJob(bu_job);
+        awake_count = BUStep(g, parent, front, curr, ws, ctx);
+        front.swap(curr);
+        t.Stop();
+        if (logging_enabled)
+          PrintStep("bu", t.Seconds(), awake_count);
+      } while ((awake_count >= old_awake_count) ||
+               (awake_count > g.num_nodes() / beta));
+      TIME_OP(t, BitmapToQueue(front, queue));
+      if (logging_enabled)
+        PrintStep("c", t.Seconds());
+      ctx.SendJob(td_job);
+      scout_count = 1;
+    } else {
+      t.Start();
+      edges_to_check -= scout_count;
+      scout_count = TDStep(g, parent, queue, ws, ctx);
+      queue.slide_window();
+      t.Stop();
+      if (logging_enabled)
+        PrintStep("td", t.Seconds(), queue.size());
+    }
+  }
+  #pragma omp parallel for
+  for (NodeID n = 0; n < g.num_nodes(); n++)
+    if (parent[n] < -1)
+      parent[n] = -1;
+  return parent;
+}
+
+
+void PrintBFSStats(const Graph &g, const pvector<NodeID> &bfs_tree) {
+  int64_t tree_size = 0;
+  int64_t n_edges = 0;
+  for (NodeID n : g.vertices()) {
+    if (bfs_tree[n] >= 0) {
+      n_edges += g.out_degree(n);
+      tree_size++;
+    }
+  }
+  cout << "BFS Tree has " << tree_size << " nodes and ";
+  cout << n_edges << " edges" << endl;
+}
+
+
+// BFS verifier does a serial BFS from same source and asserts:
+// - parent[source] = source
+// - parent[v] = u  =>  depth[v] = depth[u] + 1 (except for source)
+// - parent[v] = u  => there is edge from u to v
+// - all vertices reachable from source have a parent
+bool BFSVerifier(const Graph &g, NodeID source,
+                 const pvector<NodeID> &parent) {
+  pvector<int> depth(g.num_nodes(), -1);
+  depth[source] = 0;
+  vector<NodeID> to_visit;
+  to_visit.reserve(g.num_nodes());
+  to_visit.push_back(source);
+  for (auto it = to_visit.begin(); it != to_visit.end(); it++) {
+    NodeID u = *it;
+    for (NodeID v : g.out_neigh(u)) {
+      if (depth[v] == -1) {
+        depth[v] = depth[u] + 1;
+        to_visit.push_back(v);
+      }
+    }
+  }
+  for (NodeID u : g.vertices()) {
+    if ((depth[u] != -1) && (parent[u] != -1)) {
+      if (u == source) {
+        if (!((parent[u] == u) && (depth[u] == 0))) {
+          cout << "Source wrong" << endl;
+          return false;
+        }
+        continue;
+      }
+      bool parent_found = false;
+      for (NodeID v : g.in_neigh(u)) {
+        if (v == parent[u]) {
+          if (depth[v] != depth[u] - 1) {
+            cout << "Wrong depths for " << u << " & " << v << endl;
+            return false;
+          }
+          parent_found = true;
+          break;
+        }
+      }
+      if (!parent_found) {
+        cout << "Couldn't find edge from " << parent[u] << " to " << u << endl;
+        return false;
+      }
+    } else if (depth[u] != parent[u]) {
+      cout << "Reachability mismatch" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLApp cli(argc, argv, "breadth-first search");
+  if (!cli.ParseArgs())
+    return -1;
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  Reordering<Graph> reordering(cli, g, Reordering<Graph>::kPerVertexIDs);
+  PickleKernelContext ctx;
+  SourcePicker<Graph> sp(g, cli.start_vertex(), reordering.mapping());
+  auto BFSBound = [&sp, &cli, &ctx] (const Graph &g) {
+    return DOBFS(g, sp.PickNext(), ctx, cli.logging_en());
+  };
+  SourcePicker<Graph> vsp(g, cli.start_vertex());
+  vsp.Skip(cli.num_warmups());
+  auto VerifierBound = [&vsp] (const Graph &g, const pvector<NodeID> &parent) {
+    return BFSVerifier(g, vsp.PickNext(), parent);
+  };
+  bool all_ok = BenchmarkKernel(cli, reordering, BFSBound, PrintBFSStats,
+                                VerifierBound, ctx.device_info());
+  return all_ok ? 0 : -3;
+}
@@ -0,0 +1,138 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <cinttypes>
+#include <iostream>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/ms_bfs.h"
+#include "graphs/gapbs/platform_atomics.h"
+#include "graphs/gapbs/pvector.h"
+#include "pickle_kernel.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Multi-Source BFS (MS-BFS)
+
+Will return, for each source of a batch, how many vertices it reaches and the
+sum of their distances (enough for closeness centrality)
+
+The whole batch (-i sources, 64 by default) is searched by one bit-parallel
+MultiSourceBFS, so each neighbor list is read once per level instead of once
+per source and level. The job handed to the device walks the out-index and
+neighbor lists and prefetches the seen/next bitset rows the neighbors index
+into.
+*/
+
+
+using namespace std;
+
+struct SourceStats {
+  int64_t reached;
+  int64_t distance_sum;
+};
+
+
+pvector<SourceStats> BatchClosenessStats(const Graph &g,
+                                         const vector<NodeID> &sources,
+                                         PickleKernelContext &ctx,
+                                         bool logging_enabled = false) {
+  pvector<SourceStats> stats(sources.size(), SourceStats{0, 0});
+  MultiSourceBFS<NodeID> msbfs(g, sources.size());
+  ctx.SendJob(msbfs.CreateJob("msbfs"));
+  auto CountReached = [&stats, &msbfs] (NodeID v, int depth,
+                                        const uint64_t *reached) {
+    for (size_t w=0; w < msbfs.words(); w++) {
+      uint64_t bits = reached[w];
+      while (bits != 0) {
+        size_t i = w * 64 + __builtin_ctzll(bits);
+        bits &= bits - 1;
+        fetch_and_add(stats[i].reached, 1, memory_order_relaxed);
+        fetch_and_add(stats[i].distance_sum, depth, memory_order_relaxed);
+      }
+    }
+  };
+  int depth = msbfs.Run(sources, CountReached,
+                        [&ctx] (NodeID u) { ctx.Tick(u); });
+  if (logging_enabled)
+    PrintStep("Levels", static_cast<int64_t>(depth));
+  return stats;
+}
+
+
+void PrintClosenessStats(const Graph &g, const pvector<SourceStats> &stats) {
+  int64_t total_reached = 0;
+  for (const SourceStats &s : stats)
+    total_reached += s.reached;
+  cout << stats.size() << " sources reach " << total_reached
+       << " vertices in total" << endl;
+}
+
+
+// Compares against one serial BFS per source
+bool MSBFSVerifier(const Graph &g, const vector<NodeID> &sources,
+                   const pvector<SourceStats> &stats_to_test) {
+  bool all_ok = true;
+  pvector<int> depth(g.num_nodes());
+  vector<NodeID> to_visit;
+  to_visit.reserve(g.num_nodes());
+  for (size_t i=0; i < sources.size(); i++) {
+    depth.fill(-1);
+    depth[sources[i]] = 0;
+    to_visit.clear();
+    to_visit.push_back(sources[i]);
+    int64_t distance_sum = 0;
+    for (auto it = to_visit.begin(); it != to_visit.end(); it++) {
+      NodeID u = *it;
+      distance_sum += depth[u];
+      for (NodeID v : g.out_neigh(u)) {
+        if (depth[v] == -1) {
+          depth[v] = depth[u] + 1;
+          to_visit.push_back(v);
+        }
+      }
+    }
+    int64_t reached = to_visit.size();
+    if (stats_to_test[i].reached != reached ||
+        stats_to_test[i].distance_sum != distance_sum) {
+      cout << "Source " << sources[i] << ": " << stats_to_test[i].reached
+           << "/" << stats_to_test[i].distance_sum << " != " << reached
+           << "/" << distance_sum << endl;
+      all_ok = false;
+    }
+  }
+  return all_ok;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLIterApp cli(argc, argv, "multi-source breadth-first search", 64);
+  if (!cli.ParseArgs())
+    return -1;
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  Reordering<Graph> reordering(cli, g, Reordering<Graph>::kUnchanged);
+  PickleKernelContext ctx;
+  SourcePicker<Graph> sp(g, cli.start_vertex());
+  vector<NodeID> sources;
+  auto MSBFSBound = [&sp, &cli, &ctx, &sources, &reordering]
+                    (const Graph &g) {
+    sources = sp.PickBatch(cli.num_iters());
+    return BatchClosenessStats(g, reordering.ToNew(sources), ctx,
+                               cli.logging_en());
+  };
+  auto VerifierBound = [&sources] (const Graph &g,
+                                   const pvector<SourceStats> &stats) {
+    return MSBFSVerifier(g, sources, stats);
+  };
+  bool all_ok = BenchmarkKernel(cli, reordering, MSBFSBound,
+                                PrintClosenessStats, VerifierBound,
+                                ctx.device_info());
+  return all_ok ? 0 : -3;
+}
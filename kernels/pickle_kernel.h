@@ -0,0 +1,362 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PICKLE_KERNEL_H_
+#define PICKLE_KERNEL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/numa_partition.h"
+#include "graphs/gapbs/wrapper.h"
+#include "pickle_job_shape.h"
+#include "pickle_progress.h"
+
+/*
+Device plumbing shared by the reference kernels
+ - PickleKernelContext holds a device manager per device, which several
+   contexts may share to run kernels side by side, and one progress channel
+   (uncacheable page) per OpenMP thread allocated from the manager of the
+   thread's device. By default it drives every device node found
+   (PickleDeviceManager::enumerateDevices, one per socket); thread t works
+   with device DomainOfPart(t), the domain NumaPartition places thread t's
+   part in, so threads, pages and jobs of a socket stay together
+ - SendJob() submits the context's job under its own job id, bound to its
+   channels and with its priority (SetPriority), replacing the context's
+   previous jobs; other contexts' jobs stay active. Kernels call it with a
+   job built by createGraphJobUsing*Edges once their property arrays exist,
+   or with a PickleStaticJob (pickle_job_shape.h) when the chain is fixed:
+   it is laid out once and only its addresses are set before each send.
+   The manager checks it against the device capabilities first and may
+   downgrade it to a fallback generator or reject it, in which case the
+   kernel runs without prefetching. A job is printed on the first send of
+   its kernel name only, so later sends within timed trials do no output
+ - SendPartitionedJobs() submits one sub-job per VertexPartition part
+   (createGraphSubJobsUsing*Edges), sub-job p to thread p's device and bound
+   to thread p's channel only, so each thread's progress drives the
+   prefetches of its own slice and each device only sees its own domain.
+   Devices that cannot run that many jobs at once get the whole-graph job
+   (every device, driven by its own threads). It returns which was sent, as
+   a sub-job's positions count from the start of its slice
+ - Progress() publishes the position the calling thread reached in the array
+   driving the job (the selector array, or the vertex range without one)
+ - Tick() is the throttled Progress() behind WithProgress (pickle_progress.h):
+   it publishes every publish_period() calls per thread. The period is a
+   quarter of the prefetch distance (the registry's tunable for the job's
+   kernel if set, else the device's), so the device hears about a position
+   well before the thread runs out of prefetched elements. Progress() and
+   ProgressRange() restart the count
+ - ProgressRange() announces the range a thread is about to work through,
+   e.g. one taken by WorkStealingScheduler; page words 1 and 2 hold the
+   range and word 0 (the position) is set to its start last
+ - device_info() hands the device specs to BenchmarkKernel for its reports
+ - With ENABLE_PICKLE=0 the context is empty and every call compiles away,
+   which gives the software baseline of each kernel
+*/
+
+
+inline int PickleThreadNum() {
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+inline int PickleMaxThreads() {
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+
+#if ENABLE_PICKLE==1
+
+class PickleKernelContext {
+  // one per device; job_options.progress_channels holds the channels of
+  // the device's threads
+  struct Device {
+    std::shared_ptr<PickleDeviceManager> pdev;
+    PickleJobOptions job_options;
+  };
+  std::vector<Device> devices_;
+  PickleDevicePrefetcherSpecs specs_;
+  uint64_t priority_;
+  struct SubmittedJob {
+    int device;
+    uint64_t job_id;
+  };
+  std::vector<SubmittedJob> job_ids_;
+  // one per thread, on separate cache lines since Tick() counts in them
+  struct alignas(64) ProgressChannel {
+    volatile uint64_t *page;
+    uint64_t countdown;
+    int device;
+    uint64_t mmap_id;
+  };
+  std::vector<ProgressChannel> channels_;
+  uint64_t publish_period_;
+  // kernel names whose job has been printed; jobs are resent within timed
+  // trials (every step or shard), so each is printed on its first send only
+  std::set<std::string> printed_jobs_;
+
+  static const uint64_t kPublishesPerDistance = 4;
+
+ public:
+  // Drives every device of the system (PickleDeviceManager::
+  // enumerateDevices), one manager each
+  PickleKernelContext() : PickleKernelContext(AllDevices()) {}
+
+  explicit PickleKernelContext(std::shared_ptr<PickleDeviceManager> pdev,
+                               uint64_t priority = 1)
+      : PickleKernelContext(
+            std::vector<std::shared_ptr<PickleDeviceManager>>{pdev},
+            priority) {}
+
+  // Thread t works with device DomainOfPart(t) (numa_partition.h); the
+  // devices are assumed alike, specs and tunables come from the first
+  explicit PickleKernelContext(
+      const std::vector<std::shared_ptr<PickleDeviceManager>> &pdevs,
+      uint64_t priority = 1) : priority_(priority) {
+    for (const std::shared_ptr<PickleDeviceManager> &pdev : pdevs)
+      devices_.push_back(Device{pdev, PickleJobOptions()});
+    PickleDeviceManager &first = *devices_.front().pdev;
+    specs_ = first.getDevicePrefetcherSpecs();
+    std::cout << "Pickle availability: " << specs_.availability
+              << " prefetch distance: " << specs_.prefetch_distance
+              << " protocol version: "
+              << first.getDeviceCapabilities().protocol_version;
+    if (num_devices() > 1)
+      std::cout << " devices: " << num_devices();
+    std::cout << std::endl;
+    // pages are mapped up front so Progress() never reaches the manager
+    const int num_threads = PickleMaxThreads();
+    for (int t=0; t < num_threads; t++) {
+      const int d = device_of_thread(t);
+      Device &device = devices_[d];
+      const uint64_t mmap_id = device.pdev->allocateProgressChannels(1)[0];
+      device.job_options.priority = priority_;
+      device.job_options.progress_channels.push_back(mmap_id);
+      channels_.push_back(ProgressChannel{
+          reinterpret_cast<volatile uint64_t*>(
+              device.pdev->getUCPagePtr(mmap_id)),
+          1, d, mmap_id});
+    }
+    SetPublishPeriod(specs_.prefetch_distance);
+  }
+
+  ~PickleKernelContext() {
+    ReleaseJobs();
+  }
+
+  PickleKernelContext(const PickleKernelContext&) = delete;
+  PickleKernelContext& operator=(const PickleKernelContext&) = delete;
+
+  // Every device gets the whole job, driven by the progress of its threads
+  void SendJob(const PickleJob &job) {
+    if (FirstSendOf(job.getKernelName()))
+      job.print();
+    SendDescriptor(job.getJobDescriptor());
+  }
+
+  template <typename Shape>
+  void SendJob(const PickleStaticJob<Shape> &job) {
+    if (!job.complete()) {
+      std::cout << "Pickle: " << job.getKernelName()
+                << " job has arrays without addresses, not sent" << std::endl;
+      return;
+    }
+    if (FirstSendOf(job.getKernelName()))
+      job.print();
+    SendDescriptor(job.getJobDescriptor());
+  }
+
+  // part_jobs[p] is bound to the channel of thread p alone, on thread p's
+  // device, so each device only gets the sub-jobs of its threads' parts.
+  // False if whole_job was sent instead: thread p then publishes positions
+  // in the whole index rather than in part p's slice of it
+  bool SendPartitionedJobs(const PickleJob &whole_job,
+                           const std::vector<PickleJob> &part_jobs) {
+    std::vector<uint64_t> jobs_per_device(num_devices(), 0);
+    for (size_t p=0; p < part_jobs.size() && p < channels_.size(); p++)
+      jobs_per_device[channels_[p].device]++;
+    bool fits = channels_.size() >= part_jobs.size();
+    for (int d=0; d < num_devices(); d++) {
+      const PickleDeviceCapabilities &caps =
+          devices_[d].pdev->getDeviceCapabilities();
+      fits = fits && caps.protocol_version >= 2 &&
+             caps.max_concurrent_jobs >= jobs_per_device[d];
+    }
+    if (!fits) {
+      SendJob(whole_job);
+      return false;
+    }
+    ReleaseJobs();
+    UseTunablesOf(whole_job.getJobDescriptor());
+    for (size_t p=0; p < part_jobs.size(); p++) {
+      const ProgressChannel &channel = channels_[p];
+      PickleJobOptions options;
+      options.priority = priority_;
+      options.progress_channels = {channel.mmap_id};
+      uint64_t job_id =
+          devices_[channel.device].pdev->submitJob(part_jobs[p], options);
+      if (job_id == 0) {
+        // other contexts hold some of the device's job slots
+        SendJob(whole_job);
+        return false;
+      }
+      job_ids_.push_back(SubmittedJob{channel.device, job_id});
+    }
+    if (FirstSendOf(whole_job.getKernelName() + " sub-jobs")) {
+      std::cout << "Pickle: " << part_jobs.size() << " sub-jobs of "
+                << whole_job.getKernelName();
+      if (num_devices() > 1)
+        std::cout << " over " << num_devices() << " devices";
+      std::cout << std::endl;
+    }
+    return true;
+  }
+
+  void SetPriority(uint64_t priority) {
+    priority_ = priority;
+    for (Device &device : devices_)
+      device.job_options.priority = priority;
+    for (const SubmittedJob &job : job_ids_)
+      devices_[job.device].pdev->setJobPriority(job.job_id, priority);
+  }
+
+  int num_devices() const { return devices_.size(); }
+
+  int device_of_thread(int t) const {
+    return DomainOfPart(t, PickleMaxThreads(), num_devices());
+  }
+
+  void Progress(uint64_t position) {
+    ProgressChannel &channel = channels_[PickleThreadNum()];
+    channel.page[0] = position;
+    channel.countdown = publish_period_;
+  }
+
+  void ProgressRange(uint64_t begin, uint64_t end) {
+    ProgressChannel &channel = channels_[PickleThreadNum()];
+    channel.page[1] = begin;
+    channel.page[2] = end;
+    channel.page[0] = begin;
+    channel.countdown = publish_period_;
+  }
+
+  void Tick(uint64_t position) {
+    ProgressChannel &channel = channels_[PickleThreadNum()];
+    if (--channel.countdown == 0) {
+      channel.page[0] = position;
+      channel.countdown = publish_period_;
+    }
+  }
+
+  uint64_t publish_period() const { return publish_period_; }
+
+  const PickleDevicePrefetcherSpecs& specs() const { return specs_; }
+
+  BenchmarkDeviceInfo device_info() const {
+    BenchmarkDeviceInfo info;
+    info.enabled = true;
+    info.availability = specs_.availability;
+    info.prefetch_distance = specs_.prefetch_distance;
+    info.prefetch_mode = specs_.prefetch_mode;
+    info.bulk_mode_chunk_size = specs_.bulk_mode_chunk_size;
+    return info;
+  }
+
+ private:
+  static std::vector<std::shared_ptr<PickleDeviceManager>> AllDevices() {
+    std::vector<std::shared_ptr<PickleDeviceManager>> pdevs;
+    for (const std::string &path : PickleDeviceManager::enumerateDevices())
+      pdevs.push_back(std::make_shared<PickleDeviceManager>(path));
+    return pdevs;
+  }
+
+  bool FirstSendOf(const std::string &name) {
+    return printed_jobs_.insert(name).second;
+  }
+
+  void SendDescriptor(const std::vector<uint8_t> &job_descriptor) {
+    ReleaseJobs();
+    UseTunablesOf(job_descriptor);
+    for (int d=0; d < num_devices(); d++) {
+      const Device &device = devices_[d];
+      if (device.job_options.progress_channels.empty())
+        continue;  // more devices than threads
+      uint64_t job_id =
+          device.pdev->submitJob(job_descriptor, device.job_options);
+      if (job_id != 0)
+        job_ids_.push_back(SubmittedJob{d, job_id});
+    }
+  }
+
+  void SetPublishPeriod(uint64_t prefetch_distance) {
+    publish_period_ = std::max<uint64_t>(
+        1, prefetch_distance / kPublishesPerDistance);
+    for (ProgressChannel &channel : channels_)
+      channel.countdown = 1;
+  }
+
+  void UseTunablesOf(const std::vector<uint8_t> &job_descriptor) {
+    uint64_t distance = devices_.front().pdev->resolveJob(job_descriptor)
+                            .tunables.prefetch_distance;
+    SetPublishPeriod(distance != 0 ? distance : specs_.prefetch_distance);
+  }
+
+  void ReleaseJobs() {
+    for (const SubmittedJob &job : job_ids_)
+      devices_[job.device].pdev->releaseJob(job.job_id);
+    job_ids_.clear();
+  }
+};
+
+#else
+
+// In trace builds the jobs still reach the AccessRecorder, which saves them
+// with the trace for the offline analyzer
+class PickleKernelContext {
+ public:
+  void SendJob([[maybe_unused]] const PickleJob &job) {
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().AddJob(job.getJobDescriptor());
+#endif
+  }
+  template <typename Shape>
+  void SendJob([[maybe_unused]] const PickleStaticJob<Shape> &job) {
+#if PICKLE_TRACE_ACCESSES==1
+    AccessRecorder::Get().AddJob(job.getJobDescriptor());
+#endif
+  }
+  bool SendPartitionedJobs(const PickleJob &whole_job,
+                           const std::vector<PickleJob> & /* part_jobs */) {
+    SendJob(whole_job);
+    return false;
+  }
+  void SetPriority(uint64_t /* priority */) {}
+  int num_devices() const { return 1; }
+  int device_of_thread(int /* t */) const { return 0; }
+  void Progress(uint64_t /* position */) {}
+  void ProgressRange(uint64_t /* begin */, uint64_t /* end */) {}
+  void Tick(uint64_t /* position */) {}
+  uint64_t publish_period() const { return 0; }
+  BenchmarkDeviceInfo device_info() const { return BenchmarkDeviceInfo(); }
+};
+
+#endif  // ENABLE_PICKLE
+
+#endif  // PICKLE_KERNEL_H_
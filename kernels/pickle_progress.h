@@ -0,0 +1,158 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PICKLE_PROGRESS_H_
+#define PICKLE_PROGRESS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#include "graphs/gapbs/sliding_queue.h"
+#include "graphs/gapbs/util.h"
+
+/*
+Loops that publish their progress as they go
+ - WithProgress(ctx, ...) wraps a vertex Range (e.g. g.vertices()), the
+   window of a SlidingQueue, a Neighborhood or any [begin, end) of an array
+   in a ProgressView. Dereferencing its iterator hands the element's position
+   in the array that drives the job to ctx.Tick(), which stores it to the
+   thread's progress channel every publish_period() ticks only, so the
+   uncacheable stores stay off the critical path of most iterations
+ - Positions are vertex ids for ranges (relative to the first vertex of
+   the slice for a sub-job's range) and indexes relative to the start of
+   the array (the queue's, or the one given) for pointers and iterators
+ - The iterators are random access, so the views work in range-for loops and
+   in "omp for" loops written as for (auto it = v.begin(); it < v.end(); it++)
+ - With ENABLE_PICKLE=0, Tick() is empty and the loop compiles to the bare
+   loop over the wrapped range
+*/
+
+
+template <typename Publisher, typename T_>
+class ProgressIterator {
+  // T_ is an integer (vertex ids) or a random-access iterator (pointer)
+  // into the driving array
+  static const bool kIsIndex = std::is_integral<T_>::value;
+  typedef typename std::conditional<kIsIndex, const T_*, T_>::type IterT;
+
+ public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef typename std::conditional<kIsIndex, T_,
+      typename std::iterator_traits<IterT>::value_type>::type value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const value_type* pointer;
+  typedef typename std::conditional<kIsIndex, T_,
+      typename std::iterator_traits<IterT>::reference>::type reference;
+
+  ProgressIterator() : it_(), base_(), pub_(nullptr) {}
+  ProgressIterator(T_ it, T_ base, Publisher *pub) :
+      it_(it), base_(base), pub_(pub) {}
+
+  reference operator*() const {
+    pub_->Tick(static_cast<uint64_t>(it_ - base_));
+    if constexpr (kIsIndex)
+      return it_;
+    else
+      return *it_;
+  }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  ProgressIterator& operator++() { ++it_; return *this; }
+  ProgressIterator& operator--() { --it_; return *this; }
+  ProgressIterator operator++(int) { ProgressIterator old = *this; ++it_; return old; }
+  ProgressIterator operator--(int) { ProgressIterator old = *this; --it_; return old; }
+  ProgressIterator& operator+=(difference_type n) { it_ += n; return *this; }
+  ProgressIterator& operator-=(difference_type n) { it_ -= n; return *this; }
+  ProgressIterator operator+(difference_type n) const {
+    return ProgressIterator(it_ + n, base_, pub_);
+  }
+  ProgressIterator operator-(difference_type n) const {
+    return ProgressIterator(it_ - n, base_, pub_);
+  }
+  friend ProgressIterator operator+(difference_type n,
+                                    const ProgressIterator &it) {
+    return it + n;
+  }
+  difference_type operator-(const ProgressIterator &rhs) const {
+    return it_ - rhs.it_;
+  }
+
+  bool operator==(const ProgressIterator &rhs) const { return it_ == rhs.it_; }
+  bool operator!=(const ProgressIterator &rhs) const { return it_ != rhs.it_; }
+  bool operator<(const ProgressIterator &rhs) const { return it_ < rhs.it_; }
+  bool operator>(const ProgressIterator &rhs) const { return it_ > rhs.it_; }
+  bool operator<=(const ProgressIterator &rhs) const { return it_ <= rhs.it_; }
+  bool operator>=(const ProgressIterator &rhs) const { return it_ >= rhs.it_; }
+
+ private:
+  T_ it_;
+  T_ base_;
+  Publisher *pub_;
+};
+
+
+template <typename Publisher, typename T_>
+class ProgressView {
+ public:
+  typedef ProgressIterator<Publisher, T_> iterator;
+
+  ProgressView(T_ begin, T_ end, T_ base, Publisher *pub) :
+      begin_(begin), end_(end), base_(base), pub_(pub) {}
+
+  iterator begin() const { return iterator(begin_, base_, pub_); }
+  iterator end() const { return iterator(end_, base_, pub_); }
+  size_t size() const { return end_ - begin_; }
+
+ private:
+  T_ begin_, end_, base_;
+  Publisher *pub_;
+};
+
+
+template <typename Publisher, typename T_>
+ProgressView<Publisher, T_> WithProgress(Publisher &pub,
+                                         const Range<T_> &range) {
+  return ProgressView<Publisher, T_>(*range.begin(), *range.end(), T_(0),
+                                     &pub);
+}
+
+// A vertex range driving a job over a slice of the index that starts at
+// vertex base (a sub-job), so positions are relative to the slice
+template <typename Publisher, typename T_>
+ProgressView<Publisher, T_> WithProgress(Publisher &pub,
+                                         const Range<T_> &range, T_ base) {
+  return ProgressView<Publisher, T_>(*range.begin(), *range.end(), base,
+                                     &pub);
+}
+
+// Any array slice [begin, end), e.g. a frontier segment, as pointers or the
+// array's own iterators; positions are relative to base
+template <typename Publisher, typename Iter, typename T_>
+ProgressView<Publisher, Iter> WithProgress(Publisher &pub, Iter begin,
+                                           Iter end, const T_ *base) {
+  Iter base_iter = begin;
+  base_iter -= static_cast<const T_*>(begin) - base;
+  return ProgressView<Publisher, Iter>(begin, end, base_iter, &pub);
+}
+
+template <typename Publisher, typename T_>
+ProgressView<Publisher, typename SlidingQueue<T_>::iterator> WithProgress(
+    Publisher &pub, const SlidingQueue<T_> &queue) {
+  return WithProgress(pub, queue.begin(), queue.end(),
+                      reinterpret_cast<const T_*>(
+                          queue.getAddressRange().start));
+}
+
+// A Neighborhood (CSRGraph::out_neigh / in_neigh), positions are edge
+// offsets relative to the neighbor array starting at neighbors_base
+template <typename Publisher, typename NeighborhoodT, typename T_>
+auto WithProgress(Publisher &pub, NeighborhoodT neighborhood,
+                  const T_ *neighbors_base) {
+  return WithProgress(pub, neighborhood.begin(), neighborhood.end(),
+                      neighbors_base);
+}
+
+#endif  // PICKLE_PROGRESS_H_
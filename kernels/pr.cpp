@@ -0,0 +1,340 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/dynamic_graph.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/partition.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/streaming_graph.h"
+#include "graphs/gapbs/timer.h"
+#include "pickle_kernel.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: PageRank (PR)
+Author: Scott Beamer
+
+Will return pagerank scores for all vertices once total change < epsilon
+
+At most 50 iterations are run by default (-i). Since updates are visible
+within an iteration, the vertex order changes how fast the scores converge:
+after a degree or Gorder relabeling (-o) the Kronecker graphs take more
+than 20 iterations to reach the tolerance.
+
+This PR implementation uses the traditional iterative approach. It performs
+updates in the pull direction to remove the need for atomics, and it allows
+new values to be immediately visible (like Gauss-Seidel method).
+
+The vertices are split into edge-balanced ranges, one per thread
+(VertexPartition), and each thread sweeps its own range every iteration. The
+device gets one sub-job per range, walking that range's slice of the
+in-index and in-neighbor lists and prefetching the outgoing contributions
+they index into, driven by the owning thread's progress alone (counted from
+the start of its range, where the sub-job's index slice starts). With
+several devices (one per socket) the ranges are grouped into one domain per
+device (NumaPartition): a domain's slices of the graph and of the score
+arrays are moved to its device's NUMA node, its threads are pinned there,
+and only its sub-jobs go to that device.
+
+Given a sharded graph (.sgs, written by the converter with -x), PR streams
+the in-neighbor lists from disk instead (StreamingGraph): each iteration
+sweeps the shards in order, the next one read ahead while the current one
+is computed, and the device's job is retargeted to every shard's index and
+neighbors before its sweep.
+
+With -d, PR runs on a DynamicGraph instead, after that many batches of
+random edge updates (each inserts and deletes about 1% of the edges), the
+first half compacted into a new base while the second half is applied. The
+device's job chains both the base and the delta in-lists to the outgoing
+contributions (PickleInDeltaChain), so the edges added since the base are
+prefetched too.
+*/
+
+
+using namespace std;
+
+typedef float ScoreT;
+const float kDamp = 0.85;
+
+// Outgoing contributions, indexed by a shard's in-neighbors
+struct Contributions : PickleShapeArray<> {};
+typedef PickleChain<PickleInIndex, PickleInNeighbors, Contributions>
+    ShardShape;
+
+typedef DynamicGraph<NodeID> DynGraph;
+
+
+pvector<ScoreT> PageRankPullGS(const Graph &g, int max_iters,
+                               PickleKernelContext &ctx, double epsilon = 0,
+                               bool logging_enabled = false) {
+  const ScoreT init_score = 1.0f / g.num_nodes();
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  pvector<ScoreT> scores(g.num_nodes(), init_score);
+  pvector<ScoreT> outgoing_contrib(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    outgoing_contrib[n] = init_score / g.out_degree(n);
+  VertexPartition<NodeID> part =
+      VertexPartition<NodeID>::EdgeBalancedIncoming(g, PickleMaxThreads());
+  NumaPartition<NodeID> numa(part, ctx.num_devices());
+  numa.PlaceIncoming(g);
+  numa.Place(scores.data());
+  numa.Place(outgoing_contrib.data());
+  numa.PinThreads();
+  const bool sub_jobs = ctx.SendPartitionedJobs(
+      createGraphJobUsingIncomingEdges(&g, "pr", nullptr, &outgoing_contrib),
+      createGraphSubJobsUsingIncomingEdges(&g, "pr", part, &outgoing_contrib));
+  for (int iter=0; iter < max_iters; iter++) {
+    double error = 0;
+    #pragma omp parallel for reduction(+ : error) schedule(static, 1)
+    for (int p=0; p < part.num_parts(); p++) {
+      Range<NodeID> range(part.begin(p), part.end(p));
+      NodeID slice_begin = sub_jobs ? part.begin(p) : 0;
+      for (NodeID u : WithProgress(ctx, range, slice_begin)) {
+        ScoreT incoming_total = 0;
+        for (NodeID v : g.in_neigh(u))
+          incoming_total += outgoing_contrib[v];
+        ScoreT old_score = scores[u];
+        scores[u] = base_score + kDamp * incoming_total;
+        error += fabs(scores[u] - old_score);
+        outgoing_contrib[u] = scores[u] / g.out_degree(u);
+      }
+    }
+    if (logging_enabled)
+      PrintStep(iter, error);
+    if (error < epsilon)
+      break;
+  }
+  return scores;
+}
+
+
+pvector<ScoreT> PageRankPullStreaming(const StreamGraph &g, int max_iters,
+                                      PickleKernelContext &ctx,
+                                      double epsilon = 0,
+                                      bool logging_enabled = false) {
+  const ScoreT init_score = 1.0f / g.num_nodes();
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  pvector<ScoreT> scores(g.num_nodes(), init_score);
+  pvector<ScoreT> outgoing_contrib(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    outgoing_contrib[n] = init_score / g.out_degree(n);
+  PickleStaticJob<ShardShape> job("pr");
+  job.set<Contributions>(outgoing_contrib.getArrayDescriptor());
+  for (int iter=0; iter < max_iters; iter++) {
+    double error = 0;
+    g.ForEachShard([&] (const StreamGraph::Shard &shard) {
+      job.set<PickleInIndex>(shard.getIndexArrayDescriptor());
+      job.set<PickleInNeighbors>(shard.getNeighborsArrayDescriptor());
+      ctx.SendJob(job);
+      auto local = WithProgress(ctx, Range<NodeID>(shard.num_nodes()));
+      #pragma omp parallel for reduction(+ : error) schedule(dynamic, 64)
+      for (auto it = local.begin(); it < local.end(); it++) {
+        NodeID u = shard.begin() + *it;
+        ScoreT incoming_total = 0;
+        for (NodeID v : shard.in_neigh(u))
+          incoming_total += outgoing_contrib[v];
+        ScoreT old_score = scores[u];
+        scores[u] = base_score + kDamp * incoming_total;
+        error += fabs(scores[u] - old_score);
+        outgoing_contrib[u] = scores[u] / g.out_degree(u);
+      }
+    });
+    if (logging_enabled)
+      PrintStep(iter, error);
+    if (error < epsilon)
+      break;
+  }
+  return scores;
+}
+
+
+pvector<ScoreT> PageRankPullDynamic(const DynGraph &g, int max_iters,
+                                    PickleKernelContext &ctx,
+                                    double epsilon = 0,
+                                    bool logging_enabled = false) {
+  const ScoreT init_score = 1.0f / g.num_nodes();
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  pvector<ScoreT> scores(g.num_nodes(), init_score);
+  pvector<ScoreT> outgoing_contrib(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    outgoing_contrib[n] = init_score / g.out_degree(n);
+  PickleStaticJob<PickleInDeltaChain<Contributions>> job("pr");
+  job.setGraph(g);
+  job.set<Contributions>(outgoing_contrib.getArrayDescriptor());
+  ctx.SendJob(job);
+  for (int iter=0; iter < max_iters; iter++) {
+    double error = 0;
+    auto vertices = WithProgress(ctx, g.vertices());
+    #pragma omp parallel for reduction(+ : error) schedule(dynamic, 64)
+    for (auto it = vertices.begin(); it < vertices.end(); it++) {
+      NodeID u = *it;
+      ScoreT incoming_total = 0;
+      for (NodeID v : g.in_neigh(u))
+        incoming_total += outgoing_contrib[v];
+      ScoreT old_score = scores[u];
+      scores[u] = base_score + kDamp * incoming_total;
+      error += fabs(scores[u] - old_score);
+      outgoing_contrib[u] = scores[u] / g.out_degree(u);
+    }
+    if (logging_enabled)
+      PrintStep(iter, error);
+    if (error < epsilon)
+      break;
+  }
+  return scores;
+}
+
+
+template <typename GraphT_>
+void PrintTopScores(const GraphT_ &g, const pvector<ScoreT> &scores) {
+  int k = 5;
+  vector<pair<ScoreT, NodeID>> top_k = TopK(scores, k);
+  for (auto kvp : top_k)
+    cout << kvp.second << ":" << kvp.first << endl;
+}
+
+
+// Verifies by asserting a single serial iteration in push direction has
+//   error < target_error
+template <typename GraphT_>
+bool PRVerifier(const GraphT_ &g, const pvector<ScoreT> &scores,
+                double target_error) {
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  pvector<ScoreT> incoming_sums(g.num_nodes(), 0);
+  double error = 0;
+  for (NodeID u : g.vertices()) {
+    ScoreT outgoing_contrib = scores[u] / g.out_degree(u);
+    for (NodeID v : g.out_neigh(u))
+      incoming_sums[v] += outgoing_contrib;
+  }
+  for (NodeID n : g.vertices()) {
+    error += fabs(base_score + kDamp * incoming_sums[n] - scores[n]);
+    incoming_sums[n] = 0;
+  }
+  PrintTime("Total Error", error);
+  return error < target_error;
+}
+
+
+// Same check in the pull direction, streaming the shards once more
+bool PRStreamingVerifier(const StreamGraph &g, const pvector<ScoreT> &scores,
+                         double target_error) {
+  const ScoreT base_score = (1.0f - kDamp) / g.num_nodes();
+  double error = 0;
+  g.ForEachShard([&] (const StreamGraph::Shard &shard) {
+    for (NodeID u=shard.begin(); u < shard.end(); u++) {
+      ScoreT incoming_total = 0;
+      for (NodeID v : shard.in_neigh(u))
+        incoming_total += scores[v] / g.out_degree(v);
+      error += fabs(base_score + kDamp * incoming_total - scores[u]);
+    }
+  });
+  PrintTime("Total Error", error);
+  return error < target_error;
+}
+
+
+int StreamingMain(const CLPageRank &cli) {
+  StreamGraph g(cli.filename());
+  PickleKernelContext ctx;
+  auto PRBound = [&cli, &ctx] (const StreamGraph &g) {
+    return PageRankPullStreaming(g, cli.max_iters(), ctx, cli.tolerance(),
+                                 cli.logging_en());
+  };
+  auto VerifierBound = [&cli] (const StreamGraph &g,
+                               const pvector<ScoreT> &scores) {
+    return PRStreamingVerifier(g, scores, cli.tolerance());
+  };
+  bool all_ok = BenchmarkKernel(cli, g, PRBound, PrintTopScores<StreamGraph>,
+                                VerifierBound, ctx.device_info());
+  return all_ok ? 0 : -3;
+}
+
+
+// Inserts between random vertices and deletes of random existing edges,
+// about 1% of the edges each
+void RandomBatch(const DynGraph &g, mt19937 &rng,
+                 DynGraph::EdgeList *inserts, DynGraph::EdgeList *deletes) {
+  const int64_t batch_size = max<int64_t>(1, g.num_edges() / 100);
+  uniform_int_distribution<NodeID> vertex(0, g.num_nodes() - 1);
+  for (int64_t i=0; i < batch_size; i++) {
+    inserts->push_back(DynGraph::Edge(vertex(rng), vertex(rng)));
+    NodeID u = vertex(rng);
+    if (g.out_degree(u) == 0)
+      continue;
+    auto it = g.out_neigh(u).begin();
+    for (int64_t skip = rng() % g.out_degree(u); skip > 0; skip--)
+      ++it;
+    deletes->push_back(DynGraph::Edge(u, *it));
+  }
+}
+
+
+int DynamicMain(const CLPageRank &cli) {
+  Builder b(cli);
+  DynGraph g(b.MakeGraph());
+  mt19937 rng(27491095);
+  Timer t;
+  t.Start();
+  for (int batch=0; batch < cli.num_batches(); batch++) {
+    if (batch == cli.num_batches() / 2)
+      g.StartCompaction();
+    DynGraph::EdgeList inserts, deletes;
+    RandomBatch(g, rng, &inserts, &deletes);
+    g.ApplyBatch(inserts, deletes);
+  }
+  g.FinishCompaction();
+  t.Stop();
+  PrintTime("Update Time", t.Seconds());
+  PickleKernelContext ctx;
+  auto PRBound = [&cli, &ctx] (const DynGraph &g) {
+    return PageRankPullDynamic(g, cli.max_iters(), ctx, cli.tolerance(),
+                               cli.logging_en());
+  };
+  auto VerifierBound = [&cli] (const DynGraph &g,
+                               const pvector<ScoreT> &scores) {
+    return PRVerifier(g, scores, cli.tolerance());
+  };
+  bool all_ok = BenchmarkKernel(cli, g, PRBound, PrintTopScores<DynGraph>,
+                                VerifierBound, ctx.device_info());
+  return all_ok ? 0 : -3;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLPageRank cli(argc, argv, "pagerank", 1e-4, 50);
+  if (!cli.ParseArgs())
+    return -1;
+  if (StreamGraph::IsShardedGraphFile(cli.filename()))
+    return StreamingMain(cli);
+  if (cli.num_batches() > 0)
+    return DynamicMain(cli);
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  Reordering<Graph> reordering(cli, g, Reordering<Graph>::kPerVertex);
+  PickleKernelContext ctx;
+  auto PRBound = [&cli, &ctx] (const Graph &g) {
+    return PageRankPullGS(g, cli.max_iters(), ctx, cli.tolerance(),
+                          cli.logging_en());
+  };
+  auto VerifierBound = [&cli] (const Graph &g, const pvector<ScoreT> &scores) {
+    return PRVerifier(g, scores, cli.tolerance());
+  };
+  bool all_ok = BenchmarkKernel(cli, reordering, PRBound,
+                                PrintTopScores<Graph>, VerifierBound,
+                                ctx.device_info());
+  return all_ok ? 0 : -3;
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2015, The Regents of the University of California (Regents)
+// See LICENSE.txt for license details
+
+// Encourage use of gcc's parallel algorithms (for sort for relabeling)
+#ifdef _OPENMP
+  #define _GLIBCXX_PARALLEL
+#endif
+
+#include <algorithm>
+#include <cinttypes>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/reorder.h"
+#include "graphs/gapbs/set_intersection.h"
+#include "pickle_kernel.h"
+
+
+/*
+GAP Benchmark Suite
+Kernel: Triangle Counting (TC)
+Author: Scott Beamer
+
+Will count the number of triangles (cliques of size 3)
+
+Input graph requirements:
+  - undirected
+  - has no duplicate edges (or else will be counted as multiple triangles)
+  - neighborhoods are sorted by vertex identifiers
+
+Other than symmetrizing, the rest of the requirements are done by SquishCSR
+during graph building.
+
+This implementation reduces the search space by counting each triangle only
+once. A naive implementation will count the same triangle six times because
+each of the three vertices (u, v, w) will count it in both ways. To count
+a triangle only once, this implementation only counts a triangle if u > v > w.
+Once the remaining unexamined neighbors identifiers get too big, it can break
+out of the loop, but this requires that the neighbors are sorted.
+
+This implementation relabels the vertices by degree (Reorderer degree sort).
+This optimization is beneficial if the degree distribution is highly skewed.
+This implementation uses a heuristic to decide whether to relabel by sampling
+the degrees of vertices: if the average degree is sufficiently larger than the
+median degree, it relabels.
+
+For every edge (u, v) with v < u, the neighbors w < v of u that are also
+neighbors of v are counted by intersecting the part of N(u) before v with
+N(v) (SortedIntersectionSize, set_intersection.h). After the degree sort
+the two lists are often of very different lengths, where galloping wins;
+otherwise a SIMD block merge compares 4 neighbors against 4 at a time.
+
+The job handed to the device walks the out-index and neighbor lists of the
+graph actually counted (after relabeling, if any), and from every neighbor v
+of u follows a second copy of the out-index Ranged, so the device prefetches
+all of N(v) (the second endpoint's neighborhood) rather than its first
+element ahead of the intersection.
+*/
+
+
+using namespace std;
+
+// The out-index and neighbors again, reached from a neighbor v of u: the
+// index element of v covers [index(v), index(v+1)), all of N(v)
+struct SecondEndpointIndex :
+    PickleShapeArray<AddressingMode::Pointer, AccessType::Ranged> {};
+struct SecondEndpointNeighbors : PickleShapeArray<> {};
+typedef PickleChain<PickleOutIndex, PickleOutNeighbors, SecondEndpointIndex,
+                    SecondEndpointNeighbors> TCShape;
+
+
+size_t OrderedCount(const Graph &g, PickleKernelContext &ctx) {
+  PickleStaticJob<TCShape> job("tc");
+  job.setGraph(g);
+  job.set<SecondEndpointIndex>(g.getOutIndexArrayDescriptor());
+  job.set<SecondEndpointNeighbors>(g.getOutNeighborsArrayDescriptor());
+  ctx.SendJob(job);
+  size_t total = 0;
+  auto vertices = WithProgress(ctx, g.vertices());
+  #pragma omp parallel for reduction(+ : total) schedule(dynamic, 64)
+  for (auto u_iter = vertices.begin(); u_iter < vertices.end(); u_iter++) {
+    NodeID u = *u_iter;
+    auto u_neigh = g.out_neigh(u);
+    for (auto v_iter = u_neigh.begin(); v_iter < u_neigh.end(); v_iter++) {
+      NodeID v = *v_iter;
+      if (v > u)
+        break;
+      total += SortedIntersectionSize(u_neigh.begin(), v_iter,
+                                      g.out_neigh(v).begin(),
+                                      g.out_neigh(v).end());
+    }
+  }
+  return total;
+}
+
+
+// Heuristic to see if sufficiently dense power-law graph
+bool WorthRelabelling(const Graph &g) {
+  int64_t average_degree = g.num_edges() / g.num_nodes();
+  if (average_degree < 10)
+    return false;
+  SourcePicker<Graph> sp(g);
+  int64_t num_samples = min(int64_t(1000), g.num_nodes());
+  int64_t sample_total = 0;
+  pvector<int64_t> samples(num_samples);
+  for (int64_t trial=0; trial < num_samples; trial++) {
+    samples[trial] = g.out_degree(sp.PickNext());
+    sample_total += samples[trial];
+  }
+  sort(samples.begin(), samples.end());
+  double sample_average = static_cast<double>(sample_total) / num_samples;
+  double sample_median = samples[num_samples/2];
+  return sample_average / 1.3 > sample_median;
+}
+
+
+// Uses heuristic to see if worth relabeling. The ordered count needs high
+// degree vertices to have small IDs, which is what the degree sort gives.
+size_t Hybrid(const Graph &g, PickleKernelContext &ctx) {
+  if (WorthRelabelling(g))
+    return OrderedCount(ReorderGraph(g, ReorderMethod::kDegreeSort), ctx);
+  else
+    return OrderedCount(g, ctx);
+}
+
+
+void PrintTriangleStats(const Graph &g, size_t total_triangles) {
+  cout << total_triangles << " triangles" << endl;
+}
+
+
+// Compares with simple serial implementation that uses std::set_intersection
+bool TCVerifier(const Graph &g, size_t test_total) {
+  size_t total = 0;
+  vector<NodeID> intersection;
+  intersection.reserve(g.num_nodes());
+  for (NodeID u : g.vertices()) {
+    for (NodeID v : g.out_neigh(u)) {
+      intersection.clear();
+      set_intersection(g.out_neigh(u).begin(), g.out_neigh(u).end(),
+                       g.out_neigh(v).begin(), g.out_neigh(v).end(),
+                       back_inserter(intersection));
+      total += intersection.size();
+    }
+  }
+  total = total / 6;  // each triangle was counted 6 times
+  if (total != test_total)
+    cout << total << " != " << test_total << endl;
+  return total == test_total;
+}
+
+
+int main(int argc, char* argv[]) {
+  CLApp cli(argc, argv, "triangle count");
+  if (!cli.ParseArgs())
+    return -1;
+  Builder b(cli);
+  Graph g = b.MakeGraph();
+  if (g.directed()) {
+    cout << "Input graph is directed but tc requires undirected" << endl;
+    return -2;
+  }
+  Reordering<Graph> reordering(cli, g, Reordering<Graph>::kUnchanged);
+  PickleKernelContext ctx;
+  auto TCBound = [&ctx] (const Graph &g) { return Hybrid(g, ctx); };
+  bool all_ok = BenchmarkKernel(cli, reordering, TCBound, PrintTriangleStats,
+                                TCVerifier, ctx.device_info());
+  return all_ok ? 0 : -3;
+}
@@ -0,0 +1,193 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <getopt.h>
+#include <omp.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "graphs/gapbs/platform_atomics.h"
+#include "microbench.h"
+
+/*
+Contended throughput of the atomic memory operations in platform_atomics.h
+
+Each op is one parallel region in which every thread performs kOpsPerThread
+AMOs on the same variable, so ns/op is per batch and the comparison between
+rows is what matters. The legacy rows are what kernels used before the
+memory-order variants existed (__sync wrappers and hand-written CAS loops),
+the other rows use fetch_and_add, fetch_min and compare_and_swap with an
+explicit std::memory_order.
+
+Run with OMP_NUM_THREADS set to the contention level of interest.
+
+Usage: atomics_microbench [-t seconds] [-o results.csv] [-b baseline.csv]
+                          [-x percent]
+*/
+
+
+// Nothing here allocates, but microbench.h expects the counter
+std::atomic<uint64_t> g_alloc_count(0);
+
+const int kOpsPerThread = 4096;
+
+
+// What SSSP did before fetch_min
+template <typename T>
+bool LegacyCASMin(T &x, T new_val) {
+  T old_val = x;
+  while (new_val < old_val) {
+    if (compare_and_swap(x, old_val, new_val))
+      return true;
+    old_val = x;
+  }
+  return false;
+}
+
+// What float accumulation needed before fetch_and_add took float
+template <typename T>
+void LegacyCASAdd(T &x, T inc) {
+  T old_val, new_val;
+  do {
+    old_val = x;
+    new_val = old_val + inc;
+  } while (!compare_and_swap(x, old_val, new_val));
+}
+
+
+// Runs body(thread, i) kOpsPerThread times on every thread
+template <typename BodyFunc>
+void ContendedBatch(BodyFunc body) {
+  #pragma omp parallel
+  {
+    const int thread = omp_get_thread_num();
+    for (int i=0; i < kOpsPerThread; i++)
+      body(thread, i);
+  }
+}
+
+
+int main(int argc, char* argv[]) {
+  double min_seconds = 1;
+  std::string out_filename = "";
+  std::string baseline_filename = "";
+  double threshold = 10;
+  signed char c_opt;
+  while ((c_opt = getopt(argc, argv, "t:o:b:x:h")) != -1) {
+    switch (c_opt) {
+      case 't': min_seconds = std::stod(optarg);        break;
+      case 'o': out_filename = std::string(optarg);     break;
+      case 'b': baseline_filename = std::string(optarg);  break;
+      case 'x': threshold = std::stod(optarg);          break;
+      default:
+        std::cout << "atomics_microbench [-t seconds per benchmark] "
+                  << "[-o results.csv] [-b baseline.csv] "
+                  << "[-x allowed slowdown in percent]" << std::endl;
+        return c_opt == 'h' ? 0 : -1;
+    }
+  }
+
+  const int num_threads = omp_get_max_threads();
+  std::cout << num_threads << " threads, " << kOpsPerThread
+            << " ops per thread per batch" << std::endl;
+  MicroHarness harness(min_seconds);
+  MicroHarness::PrintHeader();
+
+  alignas(64) int64_t counter = 0;
+  harness.RunMicro("legacy fetch_and_add int64", [&] {
+    ContendedBatch([&] (int, int) { fetch_and_add(counter, 1); });
+    DoNotOptimize(counter);
+  });
+
+  harness.RunMicro("fetch_and_add int64 relaxed", [&] {
+    ContendedBatch([&] (int, int) {
+      fetch_and_add(counter, 1, std::memory_order_relaxed);
+    });
+    DoNotOptimize(counter);
+  });
+
+  // Every thread lowers the minimum on every op: the worst case for min
+  const int32_t kStart = std::numeric_limits<int32_t>::max();
+  alignas(64) int32_t dist = kStart;
+  auto Lowering = [num_threads, kStart] (int thread, int i) {
+    return kStart - 1 - (i * num_threads + thread);
+  };
+  harness.RunMicro("legacy CAS loop min int32 (lowers)", [&] {
+    dist = kStart;
+    ContendedBatch([&] (int thread, int i) {
+      LegacyCASMin(dist, Lowering(thread, i));
+    });
+    DoNotOptimize(dist);
+  });
+
+  harness.RunMicro("fetch_min int32 relaxed (lowers)", [&] {
+    dist = kStart;
+    ContendedBatch([&] (int thread, int i) {
+      fetch_min(dist, Lowering(thread, i), std::memory_order_relaxed);
+    });
+    DoNotOptimize(dist);
+  });
+
+  // The common case in SSSP: most relaxations do not improve the distance
+  harness.RunMicro("legacy CAS loop min int32 (no-op)", [&] {
+    dist = 0;
+    ContendedBatch([&] (int thread, int i) {
+      LegacyCASMin(dist, 1 + thread + i);
+    });
+    DoNotOptimize(dist);
+  });
+
+  harness.RunMicro("fetch_min int32 relaxed (no-op)", [&] {
+    dist = 0;
+    ContendedBatch([&] (int thread, int i) {
+      fetch_min(dist, 1 + thread + i, std::memory_order_relaxed);
+    });
+    DoNotOptimize(dist);
+  });
+
+  alignas(64) float score = 0;
+  harness.RunMicro("legacy CAS loop add float", [&] {
+    ContendedBatch([&] (int, int) { LegacyCASAdd(score, 0.5f); });
+    DoNotOptimize(score);
+  });
+
+  harness.RunMicro("omp atomic add float", [&] {
+    ContendedBatch([&] (int, int) {
+      #pragma omp atomic
+      score += 0.5f;
+    });
+    DoNotOptimize(score);
+  });
+
+  harness.RunMicro("fetch_and_add float relaxed", [&] {
+    ContendedBatch([&] (int, int) {
+      fetch_and_add(score, 0.5f, std::memory_order_relaxed);
+    });
+    DoNotOptimize(score);
+  });
+
+  alignas(64) double path_count = 0;
+  harness.RunMicro("legacy CAS loop add double", [&] {
+    ContendedBatch([&] (int, int) { LegacyCASAdd(path_count, 1.0); });
+    DoNotOptimize(path_count);
+  });
+
+  harness.RunMicro("fetch_and_add double relaxed", [&] {
+    ContendedBatch([&] (int, int) {
+      fetch_and_add(path_count, 1.0, std::memory_order_relaxed);
+    });
+    DoNotOptimize(path_count);
+  });
+
+  if (out_filename != "")
+    harness.WriteCSV(out_filename);
+  if (baseline_filename != "" &&
+      !harness.CompareToBaseline(baseline_filename, threshold))
+    return -3;
+  return 0;
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef MICROBENCH_H_
+#define MICROBENCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "graphs/gapbs/timer.h"
+
+/*
+Harness for the library microbenchmarks
+ - Each benchmark is a callable doing one operation; RunMicro() calibrates an
+   iteration count that runs for at least min_seconds, repeats the timed loop
+   kRepeats times and keeps the median repeat
+ - Allocations are counted by the replacement operator new in
+   pickle_microbench.cpp, which bumps g_alloc_count; the harness reports
+   allocations per operation over the kept repeat
+ - Results print as a table, can be written as CSV (-o) and compared with an
+   earlier CSV (-b). A benchmark regresses if its ns/op grows by more than the
+   threshold (-x, percent) or if it allocates more per op than before.
+*/
+
+
+extern std::atomic<uint64_t> g_alloc_count;
+
+
+// Keeps the compiler from discarding a value computed by the benchmark
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+
+struct MicroResult {
+  std::string name;
+  int64_t iterations;
+  double ns_per_op;
+  double allocs_per_op;
+};
+
+
+class MicroHarness {
+ public:
+  static const int kRepeats = 5;
+
+  explicit MicroHarness(double min_seconds) : min_seconds_(min_seconds) {}
+
+  // max_iters bounds benchmarks whose operations consume a resource
+  // (e.g. one uncacheable page per op)
+  template <typename OpFunc>
+  void RunMicro(const std::string &name, OpFunc op,
+                int64_t max_iters = INT64_MAX) {
+    int64_t iters = 1;
+    while (true) {
+      double seconds = TimeLoop(op, iters).first;
+      if (seconds >= min_seconds_ / kRepeats || iters >= max_iters)
+        break;
+      int64_t grow = seconds <= 0 ? 100 :
+          static_cast<int64_t>(1.2 * min_seconds_ / kRepeats / seconds) + 1;
+      iters = std::min(max_iters, iters * std::min<int64_t>(100, grow));
+    }
+    std::vector<std::pair<double, uint64_t>> repeats;
+    for (int r=0; r < kRepeats; r++)
+      repeats.push_back(TimeLoop(op, iters));
+    std::sort(repeats.begin(), repeats.end());
+    auto median = repeats[kRepeats / 2];
+    MicroResult result;
+    result.name = name;
+    result.iterations = iters;
+    result.ns_per_op = 1e9 * median.first / iters;
+    result.allocs_per_op = static_cast<double>(median.second) / iters;
+    printf("%-40s %12.1lf %12.2lf %12" PRId64 "\n", name.c_str(),
+           result.ns_per_op, result.allocs_per_op, iters);
+    results_.push_back(result);
+  }
+
+  static void PrintHeader() {
+    printf("%-40s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op",
+           "iterations");
+  }
+
+  void WriteCSV(const std::string &filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-5);
+    }
+    out << "benchmark,ns_per_op,allocs_per_op,iterations\n";
+    for (const MicroResult &r : results_)
+      out << r.name << "," << r.ns_per_op << "," << r.allocs_per_op << ","
+          << r.iterations << "\n";
+  }
+
+  // Returns false if any benchmark regressed against the baseline CSV
+  bool CompareToBaseline(const std::string &filename,
+                         double threshold_percent) const {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+      std::cout << "Couldn't open baseline " << filename << std::endl;
+      std::exit(-6);
+    }
+    std::vector<MicroResult> baseline;
+    std::string line;
+    std::getline(in, line);  // header
+    while (std::getline(in, line)) {
+      std::stringstream fields(line);
+      MicroResult r;
+      std::string ns, allocs;
+      std::getline(fields, r.name, ',');
+      std::getline(fields, ns, ',');
+      std::getline(fields, allocs, ',');
+      r.ns_per_op = std::stod(ns);
+      r.allocs_per_op = std::stod(allocs);
+      baseline.push_back(r);
+    }
+    bool all_ok = true;
+    printf("\n%-40s %12s %12s %10s\n", "benchmark", "baseline", "now",
+           "change");
+    for (const MicroResult &r : results_) {
+      auto it = std::find_if(baseline.begin(), baseline.end(),
+          [&r](const MicroResult &b) { return b.name == r.name; });
+      if (it == baseline.end())
+        continue;
+      double change = 100 * (r.ns_per_op - it->ns_per_op) / it->ns_per_op;
+      bool slower = change > threshold_percent;
+      bool more_allocs = r.allocs_per_op > it->allocs_per_op + 0.01;
+      printf("%-40s %12.1lf %12.1lf %+9.1lf%%%s%s\n", r.name.c_str(),
+             it->ns_per_op, r.ns_per_op, change,
+             slower ? "  SLOWER" : "", more_allocs ? "  MORE ALLOCS" : "");
+      all_ok &= !slower && !more_allocs;
+    }
+    return all_ok;
+  }
+
+ private:
+  double min_seconds_;
+  std::vector<MicroResult> results_;
+
+  template <typename OpFunc>
+  std::pair<double, uint64_t> TimeLoop(OpFunc &op, int64_t iters) {
+    Timer t;
+    uint64_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+    t.Start();
+    for (int64_t i=0; i < iters; i++)
+      op();
+    t.Stop();
+    uint64_t allocs = g_alloc_count.load(std::memory_order_relaxed) -
+                      allocs_before;
+    return std::make_pair(t.Seconds(), allocs);
+  }
+};
+
+#endif  // MICROBENCH_H_
@@ -0,0 +1,226 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <getopt.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <streambuf>
+#include <string>
+
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/sliding_queue.h"
+#include "graphs/gapbs/wrapper.h"
+#include "microbench.h"
+#include "pickle_device_manager.h"
+#include "pickle_job_shape.h"
+
+/*
+Microbenchmarks for the library-side overheads of the Pickle submission path
+
+Linked against stand_in_device.cpp instead of the real low-level layer, so
+what is measured is PickleDeviceManager, PickleJob and the descriptor
+bookkeeping in the GAPBS containers, not the driver.
+
+Usage: pickle_microbench [-t seconds] [-o results.csv] [-b baseline.csv]
+                         [-x percent]
+*/
+
+
+std::atomic<uint64_t> g_alloc_count(0);
+
+struct Queue : PickleShapeArray<> {};
+struct Parent : PickleShapeArray<> {};
+// the shape of createGraphJobUsingOutgoingEdges(&g, "bfs", &queue, &parent)
+typedef PickleJobShape<PickleLink<PickleOutIndex, PickleOutNeighbors>,
+                       PickleLink<PickleOutNeighbors, Parent>,
+                       PickleLink<Queue, PickleOutIndex>,
+                       PickleLink<Parent>> BFSShape;
+
+// Out of line so gcc does not pair the malloc/free inside them with the
+// new/delete expressions at call sites and flag them as mismatched
+#define MICROBENCH_NOINLINE __attribute__((noinline))
+
+MICROBENCH_NOINLINE void* operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+MICROBENCH_NOINLINE void* operator new[](size_t size) {
+  return operator new(size);
+}
+MICROBENCH_NOINLINE void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+MICROBENCH_NOINLINE void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+MICROBENCH_NOINLINE void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+MICROBENCH_NOINLINE void operator delete[](void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+
+// Swallows characters but still makes the stream format them, so the
+// library's logging to std::cout stays part of the measured cost
+class NullBuffer : public std::streambuf {
+ protected:
+  int overflow(int c) override { return c; }
+};
+
+
+typedef CSRGraph<int32_t> Graph;
+
+// Undirected 8-node ring; CSRGraph takes ownership of both arrays
+Graph MakeRing(int64_t num_nodes = 8) {
+  int32_t** index = new int32_t*[num_nodes + 1];
+  int32_t* neighs = new int32_t[2 * num_nodes];
+  for (int64_t n=0; n < num_nodes; n++) {
+    neighs[2*n] = (n + num_nodes - 1) % num_nodes;
+    neighs[2*n + 1] = (n + 1) % num_nodes;
+    index[n] = neighs + 2*n;
+  }
+  index[num_nodes] = neighs + 2*num_nodes;
+  return Graph(num_nodes, index, neighs);
+}
+
+
+int main(int argc, char* argv[]) {
+  double min_seconds = 1;
+  std::string out_filename = "";
+  std::string baseline_filename = "";
+  double threshold = 10;
+  signed char c_opt;
+  while ((c_opt = getopt(argc, argv, "t:o:b:x:h")) != -1) {
+    switch (c_opt) {
+      case 't': min_seconds = std::stod(optarg);        break;
+      case 'o': out_filename = std::string(optarg);     break;
+      case 'b': baseline_filename = std::string(optarg);  break;
+      case 'x': threshold = std::stod(optarg);          break;
+      default:
+        std::cout << "pickle_microbench [-t seconds per benchmark] "
+                  << "[-o results.csv] [-b baseline.csv] "
+                  << "[-x allowed slowdown in percent]" << std::endl;
+        return c_opt == 'h' ? 0 : -1;
+    }
+  }
+
+  NullBuffer null_buffer;
+  std::streambuf* cout_buffer = std::cout.rdbuf();
+  std::unique_ptr<PickleDeviceManager> pdev(new PickleDeviceManager());
+  Graph g = MakeRing(1024);
+  pvector<int32_t> parent(g.num_nodes());
+  SlidingQueue<int32_t> queue(g.num_nodes());
+  PickleJob job = createGraphJobUsingOutgoingEdges(&g, "bfs", &queue, &parent);
+
+  MicroHarness harness(min_seconds);
+  MicroHarness::PrintHeader();
+
+  harness.RunMicro("PickleArrayDescriptor construct", [] {
+    std::shared_ptr<PickleArrayDescriptor> descriptor(
+        new PickleArrayDescriptor());
+    DoNotOptimize(descriptor.get());
+  });
+
+  harness.RunMicro("pvector<int32_t>(1024) construct", [] {
+    pvector<int32_t> v(1024);
+    DoNotOptimize(v.data());
+  });
+
+  harness.RunMicro("CSRGraph construct (8 nodes)", [] {
+    Graph ring = MakeRing();
+    DoNotOptimize(ring.num_edges());
+  });
+
+  harness.RunMicro("createGraphJobUsingOutgoingEdges", [&] {
+    PickleJob bfs_job = createGraphJobUsingOutgoingEdges(&g, "bfs", &queue,
+                                                         &parent);
+    DoNotOptimize(bfs_job);
+  });
+
+  harness.RunMicro("PickleJob::getJobDescriptor (4 arrays)", [&] {
+    std::vector<uint8_t> descriptor = job.getJobDescriptor();
+    DoNotOptimize(descriptor.data());
+  });
+
+  harness.RunMicro("PickleStaticJob build (4 arrays)", [&] {
+    PickleStaticJob<BFSShape> static_job("bfs");
+    static_job.setGraph(g);
+    static_job.set<Queue>(queue.getArrayDescriptor());
+    static_job.set<Parent>(parent.getArrayDescriptor());
+    DoNotOptimize(static_job.getJobDescriptor().data());
+  });
+
+  PickleStaticJob<BFSShape> static_job("bfs");
+  static_job.setGraph(g);
+  static_job.set<Queue>(queue.getArrayDescriptor());
+  static_job.set<Parent>(parent.getArrayDescriptor());
+  harness.RunMicro("PickleStaticJob refill one array", [&] {
+    static_job.set<Queue>(queue.getArrayDescriptor());
+    DoNotOptimize(static_job.getJobDescriptor().data());
+  });
+
+  std::cout.rdbuf(&null_buffer);
+  harness.RunMicro("PickleDeviceManager::sendJob", [&] {
+    DoNotOptimize(pdev->sendJob(job));
+  });
+
+  uint64_t next_mmap_id = 1;
+  harness.RunMicro("getUCPagePtr first touch", [&] {
+    DoNotOptimize(pdev->getUCPagePtr(next_mmap_id++));
+  }, 2048);
+
+  pdev->getUCPagePtr(0);
+  harness.RunMicro("getUCPagePtr mapped", [&] {
+    DoNotOptimize(pdev->getUCPagePtr(0));
+  });
+
+  harness.RunMicro("PickleDeviceManager::resolveJob", [&] {
+    DoNotOptimize(pdev->resolveJob(job).verdict);
+  });
+
+  PickleJobOptions job_options;
+  job_options.progress_channels = pdev->allocateProgressChannels(1);
+  harness.RunMicro("submitJob + releaseJob", [&] {
+    DoNotOptimize(pdev->releaseJob(pdev->submitJob(job, job_options)));
+  });
+
+  harness.RunMicro("submitJob + releaseJob (static job)", [&] {
+    DoNotOptimize(pdev->releaseJob(
+        pdev->submitJob(static_job.getJobDescriptor(), job_options)));
+  });
+
+  harness.RunMicro("getDevicePrefetcherSpecs", [&] {
+    DoNotOptimize(pdev->getDevicePrefetcherSpecs());
+  });
+  std::cout.rdbuf(cout_buffer);
+
+  SlidingQueue<int32_t> flush_queue(1 << 20);
+  QueueBuffer<int32_t> lqueue(flush_queue);
+  int64_t flushes = 0;
+  harness.RunMicro("QueueBuffer 64 x push_back + flush", [&] {
+    if (++flushes % ((1 << 20) / 64) == 0)
+      flush_queue.reset();
+    for (int32_t i=0; i < 64; i++)
+      lqueue.push_back(i);
+    lqueue.flush();
+    flush_queue.slide_window();
+  });
+
+  if (out_filename != "")
+    harness.WriteCSV(out_filename);
+  if (baseline_filename != "" &&
+      !harness.CompareToBaseline(baseline_filename, threshold))
+    return -3;
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../src/pickle_device_low_level.h"
+
+/*
+Stand-in for src/pickle_device_low_level.cpp used by the microbenchmarks
+ - Implements the same low-level entry points without /dev/hey_pickle so the
+   library-side cost of PickleDeviceManager can be measured on any machine
+ - Pages come from anonymous mmaps and get fake, page-aligned paddrs
+ - Commands are copied into a buffer the way pwrite hands them to the driver,
+   but no system call is made, so timings exclude the kernel round trip
+ - Every device path behaves as the same device, so a test can enumerate
+   stand-in nodes (empty files under PICKLE_DEVICE_PATH) and drive one
+   manager per node
+ - Device specs are fixed (single prefetch mode, distance 32), and the
+   capabilities report protocol version 2 (4 concurrent jobs) with the
+   generators of the kernels in kernels/, numbered like the defaults of
+   PickleGeneratorRegistry
+*/
+
+
+namespace {
+
+const uint64_t kStandInPaddrBase = 0x80000000ULL;
+std::vector<uint8_t> command_buffer(4096);
+
+bool map_anonymous(size_t length, uint8_t** ptr) {
+  void* mmap_ptr = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mmap_ptr == MAP_FAILED) {
+    *ptr = nullptr;
+    return false;
+  }
+  *ptr = static_cast<uint8_t*>(mmap_ptr);
+  return true;
+}
+
+}  // namespace
+
+bool allocate_uncacheable_page(const std::string& device_path,
+                               const uint64_t mmap_id, uint8_t** ptr) {
+  return map_anonymous(4096, ptr);
+}
+
+bool allocate_perf_page(const std::string& device_path, uint8_t** ptr) {
+  return map_anonymous(8192, ptr);
+}
+
+bool get_mmap_paddr(const std::string& device_path, const uint64_t mmap_id,
+                    uint64_t& paddr) {
+  paddr = kStandInPaddrBase + (mmap_id << 12);
+  return true;
+}
+
+bool get_perf_page_paddr(const std::string& device_path, uint64_t& paddr) {
+  paddr = kStandInPaddrBase - 0x2000;
+  return true;
+}
+
+bool write_command_to_device(const std::string& device_path,
+                             uint64_t command_type, uint64_t command_length,
+                             const uint8_t* command) {
+  uint64_t header[2] = {command_type, command_length};
+  if (command_buffer.size() < command_length + sizeof(header))
+    command_buffer.resize(command_length + sizeof(header));
+  std::memcpy(command_buffer.data(), header, sizeof(header));
+  std::memcpy(command_buffer.data() + sizeof(header), command, command_length);
+  return true;
+}
+
+struct device_specs get_device_specs(const std::string& device_path) {
+  struct device_specs specs;
+  std::memset(&specs, 0, sizeof(specs));
+  specs.availability = 1;
+  specs.prefetch_distance = 32;
+  specs.prefetch_mode = SINGLE_PREFETCH_MODE;
+  specs.bulk_mode_chunk_size = 0;
+  return specs;
+}
+
+bool get_device_capabilities(const std::string& device_path,
+                             struct device_capabilities& caps) {
+  std::memset(&caps, 0, sizeof(caps));
+  caps.protocol_version = 2;
+  caps.max_arrays_per_job = 16;
+  caps.max_watch_ranges = 256;
+  caps.max_watch_range_bytes = 4096;
+  caps.max_concurrent_jobs = 4;
+  const char* names[] = {"bfs", "bfs-bu", "pr", "sssp", "cc", "bc", "tc",
+                         "msbfs"};
+  caps.num_generators = sizeof(names) / sizeof(names[0]);
+  for (uint64_t i = 0; i < caps.num_generators; i++) {
+    caps.generators[i].id = i + 1;
+    std::strncpy(caps.generators[i].name, names[i],
+                 PICKLE_GENERATOR_NAME_LENGTH - 1);
+  }
+  return true;
+}
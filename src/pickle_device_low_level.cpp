@@ -10,18 +10,21 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <cerrno>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "pickle_driver.h"
+#include "pickle_driver_compat.h"
 
-bool allocate_uncacheable_page(const uint64_t mmap_id, uint8_t** ptr) {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+bool allocate_uncacheable_page(const std::string& device_path,
+                               const uint64_t mmap_id, uint8_t** ptr) {
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   int err = 0;
 
@@ -30,7 +33,7 @@ bool allocate_uncacheable_page(const uint64_t mmap_id, uint8_t** ptr) {
   fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     return false;
   }
@@ -38,7 +41,7 @@ bool allocate_uncacheable_page(const uint64_t mmap_id, uint8_t** ptr) {
   uint8_t* mmap_ptr = (uint8_t*)mmap(NULL, 4096, PROT_READ | PROT_WRITE,
                                      MAP_FILE | MAP_SHARED, fd, 0);
   if (mmap_ptr == MAP_FAILED) {
-    std::cerr << "Failed to open mmap for" << pickle_driver_dev_str
+    std::cerr << "Failed to open mmap for" << device_path
               << std::endl;
     perror("Error");
     close(fd);
@@ -48,9 +51,8 @@ bool allocate_uncacheable_page(const uint64_t mmap_id, uint8_t** ptr) {
   return true;
 }
 
-bool allocate_perf_page(uint8_t** ptr) {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+bool allocate_perf_page(const std::string& device_path, uint8_t** ptr) {
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   int err = 0;
 
@@ -59,7 +61,7 @@ bool allocate_perf_page(uint8_t** ptr) {
   fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     return false;
   }
@@ -69,7 +71,7 @@ bool allocate_perf_page(uint8_t** ptr) {
   uint8_t* mmap_ptr = (uint8_t*)mmap(NULL, 8192, PROT_READ | PROT_WRITE,
                                      MAP_FILE | MAP_SHARED, fd, 0);
   if (mmap_ptr == MAP_FAILED) {
-    std::cerr << "Failed to open mmap for" << pickle_driver_dev_str
+    std::cerr << "Failed to open mmap for" << device_path
               << std::endl;
     perror("Error");
     close(fd);
@@ -79,9 +81,9 @@ bool allocate_perf_page(uint8_t** ptr) {
   return true;
 }
 
-bool get_mmap_paddr(const uint64_t mmap_id, uint64_t& paddr) {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+bool get_mmap_paddr(const std::string& device_path, const uint64_t mmap_id,
+                    uint64_t& paddr) {
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   int err = 0;
   struct process_pagetable_params params;
@@ -89,7 +91,7 @@ bool get_mmap_paddr(const uint64_t mmap_id, uint64_t& paddr) {
   fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     return false;
   }
@@ -112,9 +114,8 @@ bool get_mmap_paddr(const uint64_t mmap_id, uint64_t& paddr) {
   return true;
 }
 
-bool get_perf_page_paddr(uint64_t& paddr) {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+bool get_perf_page_paddr(const std::string& device_path, uint64_t& paddr) {
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   int err = 0;
   struct process_pagetable_params params;
@@ -122,7 +123,7 @@ bool get_perf_page_paddr(uint64_t& paddr) {
   fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     return false;
   }
@@ -145,10 +146,10 @@ bool get_perf_page_paddr(uint64_t& paddr) {
   return true;
 }
 
-bool write_command_to_device(uint64_t command_type, uint64_t command_length,
+bool write_command_to_device(const std::string& device_path,
+                             uint64_t command_type, uint64_t command_length,
                              const uint8_t* command) {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   uint64_t content1[2];
   uint64_t content1_size = 16;
@@ -160,13 +161,13 @@ bool write_command_to_device(uint64_t command_type, uint64_t command_length,
   fd = open(pickle_driver_dev, O_RDWR);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     return false;
   }
 
   if (pwrite(fd, content1_ptr8, 16, 0) != content1_size) {
-    std::cerr << "error while writing control to " << pickle_driver_dev_str
+    std::cerr << "error while writing control to " << device_path
               << std::endl;
     perror("Error");
     close(fd);
@@ -175,7 +176,7 @@ bool write_command_to_device(uint64_t command_type, uint64_t command_length,
 
   uint64_t written_bytes = pwrite(fd, command, command_length, 1);
   if (written_bytes != command_length) {
-    std::cerr << "error while writing command to " << pickle_driver_dev_str
+    std::cerr << "error while writing command to " << device_path
               << std::endl;
     std::cerr << "written bytes: " << written_bytes << std::endl;
     perror("Error");
@@ -188,16 +189,15 @@ bool write_command_to_device(uint64_t command_type, uint64_t command_length,
   return true;
 }
 
-struct device_specs get_device_specs() {
-  const std::string pickle_driver_dev_str = "/dev/hey_pickle";
-  const char* pickle_driver_dev = pickle_driver_dev_str.c_str();
+struct device_specs get_device_specs(const std::string& device_path) {
+  const char* pickle_driver_dev = device_path.c_str();
   int fd;
   struct device_specs specs;
 
   fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
 
   if (fd < 0) {
-    std::cerr << "failed to open " << pickle_driver_dev_str << std::endl;
+    std::cerr << "failed to open " << device_path << std::endl;
     perror("Error");
     exit(errno);
     return specs;
@@ -208,7 +208,7 @@ struct device_specs get_device_specs() {
   int err = ioctl(fd, IOC_PICKLE_DRIVER_GET_DEVICE_SPECS, &specs);
   if (err) {
     std::cerr << "error while IOC_PICKLE_DRIVER_GET_DEVICE_SPECS from "
-              << pickle_driver_dev_str << std::endl;
+              << device_path << std::endl;
     perror("Error");
     close(fd);
     exit(errno);
@@ -219,4 +219,38 @@ struct device_specs get_device_specs() {
   return specs;
 }
 
+bool get_device_capabilities(const std::string& device_path,
+                             struct device_capabilities& caps) {
+  const char* pickle_driver_dev = device_path.c_str();
+  int fd;
+
+  std::memset(&caps, 0, sizeof(caps));
+
+  fd = open(pickle_driver_dev, O_RDWR | O_SYNC);
+
+  if (fd < 0) {
+    std::cerr << "failed to open " << device_path << std::endl;
+    perror("Error");
+    return false;
+  }
+
+  int err = ioctl(fd, IOC_PICKLE_DRIVER_GET_DEVICE_CAPABILITIES, &caps);
+  if (err) {
+    // ENOTTY/EINVAL: a driver without the query, the caller falls back
+    if (errno != ENOTTY && errno != EINVAL) {
+      std::cerr << "error while IOC_PICKLE_DRIVER_GET_DEVICE_CAPABILITIES "
+                   "from "
+                << device_path << std::endl;
+      perror("Error");
+    }
+    close(fd);
+    return false;
+  }
+
+  close(fd);
+  if (caps.num_generators > PICKLE_MAX_GENERATORS)
+    caps.num_generators = PICKLE_MAX_GENERATORS;
+  return true;
+}
+
 #endif  // PICKLE_DEVICE_LOW_LEVEL_H
@@ -5,20 +5,31 @@
 #ifndef PICKLE_DEVICE_LOW_LEVEL_H
 #define PICKLE_DEVICE_LOW_LEVEL_H
 
+#include <string>
+
 #include "pickle_driver.h"
+#include "pickle_driver_compat.h"
+
+// Every call opens the device node at device_path (e.g. /dev/hey_pickle0)
 
 // Return an uncacheable page for device's type 1 communication
-bool allocate_uncacheable_page(const uint64_t mmap_id, uint8_t** ptr);
+bool allocate_uncacheable_page(const std::string& device_path,
+                               const uint64_t mmap_id, uint8_t** ptr);
 // Return an uncacheable page for device's type 2 communication
 // (performance monitoring related communication)
-bool allocate_perf_page(uint8_t** ptr);
+bool allocate_perf_page(const std::string& device_path, uint8_t** ptr);
 // Return the type 1 communication page paddr
-bool get_mmap_paddr(const uint64_t mmap_id, uint64_t& paddr);
+bool get_mmap_paddr(const std::string& device_path, const uint64_t mmap_id,
+                    uint64_t& paddr);
 // Return the type 2 commnucation page paddr
-bool get_perf_page_paddr(uint64_t& paddr);
+bool get_perf_page_paddr(const std::string& device_path, uint64_t& paddr);
 // Write command to the device
-bool write_command_to_device(uint64_t command_type, uint64_t command_length,
+bool write_command_to_device(const std::string& device_path,
+                             uint64_t command_type, uint64_t command_length,
                              const uint8_t* command);
 // Get device specification
-struct device_specs get_device_specs();
+struct device_specs get_device_specs(const std::string& device_path);
+// Get device capabilities; false if the driver predates the query
+bool get_device_capabilities(const std::string& device_path,
+                             struct device_capabilities& caps);
 #endif  // PICKLE_DEVICE_LOW_LEVEL_H
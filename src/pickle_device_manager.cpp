@@ -8,37 +8,249 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cerrno>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "pickle_device_low_level.h"
 
-PickleDeviceManager::PickleDeviceManager() {
+PickleDeviceManager::PickleDeviceManager()
+    : PickleDeviceManager(enumerateDevices().front()) {}
+
+PickleDeviceManager::PickleDeviceManager(const std::string& device_path)
+    : device_path(device_path) {
   perf_page_ptr = nullptr;
+  capabilities_queried = false;
+  next_job_id = 1;
+  next_job_sequence = 0;
+  loaded_job_id = 0;
+  next_channel_id = 0;
 }
 
-PickleDeviceManager::~PickleDeviceManager() { deallocateUncacheablePage(0); }
+PickleDeviceManager::~PickleDeviceManager() {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  // a released single-job device keeps running its job until the next load,
+  // so only concurrent devices are told
+  if (!active_jobs.empty() && runsConcurrentJobs()) {
+    for (const auto& id_job : active_jobs)
+      write_command_to_device(device_path, PickleDeviceCommand::RELEASE_JOB,
+                              sizeof(id_job.first),
+                              (const uint8_t*)&id_job.first);
+  }
+  active_jobs.clear();
+  loaded_job_id = 0;
+  while (!mmap_id_to_uc_ptr_map.empty())
+    deallocateUncacheablePage(mmap_id_to_uc_ptr_map.begin()->first);
+  if (perf_page_ptr != nullptr)
+    munmap((void*)perf_page_ptr, 8192);
+}
+
+std::string PickleDeviceManager::getDevicePathBase() {
+  const char* base = std::getenv("PICKLE_DEVICE_PATH");
+  return (base != nullptr && base[0] != '\0') ? base : "/dev/hey_pickle";
+}
+
+std::vector<std::string> PickleDeviceManager::enumerateDevices() {
+  const std::string base = getDevicePathBase();
+  std::vector<std::string> devices;
+  struct stat st;
+  for (int i = 0;; i++) {
+    std::string path = base + std::to_string(i);
+    if (stat(path.c_str(), &st) != 0)
+      break;
+    devices.push_back(path);
+  }
+  if (devices.empty())
+    devices.push_back(base);
+  return devices;
+}
+
+const std::string& PickleDeviceManager::getDevicePath() const {
+  return device_path;
+}
 
 bool PickleDeviceManager::sendJob(const PickleJob& job) {
+  return sendJob(job.getJobDescriptor());
+}
+
+bool PickleDeviceManager::sendJob(const std::vector<uint8_t>& job_descriptor) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
   std::cout << "sendJob" << std::endl;
-  std::vector<uint8_t> job_descriptor = job.getJobDescriptor();
+  // replaces whatever a single-job device ran, including a submitted job
+  loaded_job_id = 0;
+  PickleJobResolution resolution = resolveJob(job_descriptor);
+  if (resolution.verdict == PickleJobVerdict::JOB_REJECTED) {
+    std::cout << "PickleDeviceManager: rejected job "
+              << pickleJobDescriptorKernelName(job_descriptor) << ": "
+              << resolution.reason << std::endl;
+    return false;
+  }
+  if (resolution.verdict == PickleJobVerdict::JOB_DOWNGRADED) {
+    std::cout << "PickleDeviceManager: " << resolution.reason << std::endl;
+    std::vector<uint8_t> downgraded = job_descriptor;
+    pickleJobDescriptorSetKernelName(downgraded, resolution.kernel_name);
+    return writeJobToPickleDevice(downgraded);
+  }
   return writeJobToPickleDevice(job_descriptor);  // update the driver for this
 }
 
+PickleJobResolution PickleDeviceManager::resolveJob(const PickleJob& job) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  return generator_registry.resolve(job, getDeviceCapabilities());
+}
+
+PickleJobResolution PickleDeviceManager::resolveJob(
+    const std::vector<uint8_t>& job_descriptor) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  return generator_registry.resolve(job_descriptor, getDeviceCapabilities());
+}
+
+uint64_t PickleDeviceManager::submitJob(const PickleJob& job,
+                                        const PickleJobOptions& options) {
+  return submitJob(job.getJobDescriptor(), options);
+}
+
+uint64_t PickleDeviceManager::submitJob(
+    const std::vector<uint8_t>& job_descriptor,
+    const PickleJobOptions& options) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  PickleJobResolution resolution = resolveJob(job_descriptor);
+  if (resolution.verdict == PickleJobVerdict::JOB_REJECTED) {
+    std::cout << "PickleDeviceManager: rejected job "
+              << pickleJobDescriptorKernelName(job_descriptor) << ": "
+              << resolution.reason << std::endl;
+    return 0;
+  }
+  if (resolution.verdict == PickleJobVerdict::JOB_DOWNGRADED)
+    std::cout << "PickleDeviceManager: " << resolution.reason << std::endl;
+  for (uint64_t channel : options.progress_channels) {
+    if (mmap_id_to_uc_paddr_map.find(channel) ==
+        mmap_id_to_uc_paddr_map.end()) {
+      std::cout << "PickleDeviceManager: progress channel " << channel
+                << " is not mapped" << std::endl;
+      return 0;
+    }
+  }
+  const bool concurrent = runsConcurrentJobs();
+  if (concurrent &&
+      active_jobs.size() >= getDeviceCapabilities().max_concurrent_jobs) {
+    std::cout << "PickleDeviceManager: rejected job "
+              << pickleJobDescriptorKernelName(job_descriptor)
+              << ": device runs at most "
+              << getDeviceCapabilities().max_concurrent_jobs
+              << " jobs at once" << std::endl;
+    return 0;
+  }
+  ActiveJob active_job;
+  active_job.job_descriptor = job_descriptor;
+  if (resolution.verdict == PickleJobVerdict::JOB_DOWNGRADED)
+    pickleJobDescriptorSetKernelName(active_job.job_descriptor,
+                                     resolution.kernel_name);
+  active_job.options = options;
+  active_job.sequence = next_job_sequence++;
+  const uint64_t job_id = next_job_id++;
+  active_jobs[job_id] = active_job;
+  bool sent = concurrent ? writeSubmitJobToPickleDevice(job_id, active_job)
+                         : loadHighestPriorityJob();
+  if (!sent) {
+    active_jobs.erase(job_id);
+    return 0;
+  }
+  return job_id;
+}
+
+bool PickleDeviceManager::setJobPriority(const uint64_t job_id,
+                                         const uint64_t priority) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  auto it = active_jobs.find(job_id);
+  if (it == active_jobs.end())
+    return false;
+  it->second.options.priority = priority;
+  if (!runsConcurrentJobs())
+    return loadHighestPriorityJob();
+  uint64_t command[2] = {job_id, priority};
+  return write_command_to_device(device_path,
+                                 PickleDeviceCommand::SET_JOB_PRIORITY,
+                                 sizeof(command), (uint8_t*)command);
+}
+
+bool PickleDeviceManager::releaseJob(const uint64_t job_id) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  if (active_jobs.erase(job_id) == 0)
+    return false;
+  if (!runsConcurrentJobs()) {
+    // the device keeps running a released job until another one is loaded
+    if (loaded_job_id == job_id)
+      loaded_job_id = 0;
+    return active_jobs.empty() || loadHighestPriorityJob();
+  }
+  return write_command_to_device(device_path, PickleDeviceCommand::RELEASE_JOB,
+                                 sizeof(job_id), (const uint8_t*)&job_id);
+}
+
+std::vector<uint64_t> PickleDeviceManager::getActiveJobIds() {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  std::vector<uint64_t> job_ids;
+  for (const auto& id_job : active_jobs)
+    job_ids.push_back(id_job.first);
+  return job_ids;
+}
+
+std::vector<uint64_t> PickleDeviceManager::allocateProgressChannels(
+    const uint64_t count) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  std::vector<uint64_t> channels;
+  for (uint64_t i = 0; i < count; i++) {
+    while (mmap_id_to_uc_ptr_map.find(next_channel_id) !=
+           mmap_id_to_uc_ptr_map.end())
+      next_channel_id++;
+    getUCPagePtr(next_channel_id);
+    channels.push_back(next_channel_id++);
+  }
+  return channels;
+}
+
+bool PickleDeviceManager::runsConcurrentJobs() {
+  const PickleDeviceCapabilities& caps = getDeviceCapabilities();
+  return caps.protocol_version >= 2 && caps.max_concurrent_jobs > 1;
+}
+
+bool PickleDeviceManager::loadHighestPriorityJob() {
+  auto best = active_jobs.end();
+  for (auto it = active_jobs.begin(); it != active_jobs.end(); it++) {
+    if (best == active_jobs.end() ||
+        it->second.options.priority > best->second.options.priority ||
+        (it->second.options.priority == best->second.options.priority &&
+         it->second.sequence > best->second.sequence))
+      best = it;
+  }
+  if (best == active_jobs.end() || best->first == loaded_job_id)
+    return true;
+  if (!writeJobToPickleDevice(best->second.job_descriptor))
+    return false;
+  loaded_job_id = best->first;
+  return true;
+}
+
 uint8_t* PickleDeviceManager::getUCPagePtr(const uint64_t mmap_id) {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
   if (mmap_id_to_uc_ptr_map.find(mmap_id) == mmap_id_to_uc_ptr_map.end()) {
     uint8_t* mmap_ptr = nullptr;
-    bool allocate_success = allocate_uncacheable_page(mmap_id, &mmap_ptr);
+    bool allocate_success =
+        allocate_uncacheable_page(device_path, mmap_id, &mmap_ptr);
     if (!allocate_success) {
       std::cout << "PickleDeviceManager: failed to allocate a new uncacheable "
                    "page for mmap_id: "
@@ -46,7 +258,7 @@ uint8_t* PickleDeviceManager::getUCPagePtr(const uint64_t mmap_id) {
       exit(1);
     }
     uint64_t paddr = 0;
-    bool get_paddr_success = get_mmap_paddr(mmap_id, paddr);
+    bool get_paddr_success = get_mmap_paddr(device_path, mmap_id, paddr);
     if (!get_paddr_success) {
       std::cout << "PickleDeviceManager: failed to get paddr for an "
                    "uncacheable page for mmap_id: "
@@ -62,8 +274,9 @@ uint8_t* PickleDeviceManager::getUCPagePtr(const uint64_t mmap_id) {
 }
 
 uint8_t* PickleDeviceManager::getPerfPagePtr() {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
   if (perf_page_ptr == nullptr) {
-    bool allocate_success = allocate_perf_page(&perf_page_ptr);
+    bool allocate_success = allocate_perf_page(device_path, &perf_page_ptr);
     if (!allocate_success) {
       std::cout << "PickleDeviceManager: failed to allocate the perf page"
                 << std::endl;
@@ -86,7 +299,12 @@ void PickleDeviceManager::registerUncacheablePage(const uint64_t mmap_id,
 }
 
 void PickleDeviceManager::deallocateUncacheablePage(const uint64_t mmap_id) {
-  munmap((void*)mmap_id_to_uc_ptr_map[mmap_id], 4096);
+  auto it = mmap_id_to_uc_ptr_map.find(mmap_id);
+  if (it == mmap_id_to_uc_ptr_map.end())
+    return;
+  munmap((void*)it->second, 4096);
+  mmap_id_to_uc_ptr_map.erase(it);
+  mmap_id_to_uc_paddr_map.erase(mmap_id);
 }
 
 bool PickleDeviceManager::writeUncacheablePagePaddr(const uint64_t mmap_id) {
@@ -97,21 +315,41 @@ bool PickleDeviceManager::writeUncacheablePagePaddr(const uint64_t mmap_id) {
   uint8_t* range_ptr8 = (uint8_t*)(range_ptr64);
   std::cout << "writeUncacheablePagePaddr 0x" << std::hex << range[0] << " - 0x"
             << range[1] << std::dec << std::endl;
-  return write_command_to_device(PickleDeviceCommand::ADD_WATCH_RANGE, 16,
+  return write_command_to_device(device_path,
+                                 PickleDeviceCommand::ADD_WATCH_RANGE, 16,
                                  range_ptr8);
 }
 
 bool PickleDeviceManager::writeJobToPickleDevice(
     const std::vector<uint8_t>& job_descriptor) {
-  return write_command_to_device(PickleDeviceCommand::SEND_JOB_DESCRIPTOR,
+  return write_command_to_device(device_path,
+                                 PickleDeviceCommand::SEND_JOB_DESCRIPTOR,
                                  job_descriptor.size(), job_descriptor.data());
 }
 
+// Layout: job id, priority, number of progress channels, the channels'
+// page paddrs, then the job descriptor
+bool PickleDeviceManager::writeSubmitJobToPickleDevice(
+    const uint64_t job_id, const ActiveJob& active_job) {
+  std::vector<uint64_t> header;
+  header.push_back(job_id);
+  header.push_back(active_job.options.priority);
+  header.push_back(active_job.options.progress_channels.size());
+  for (uint64_t channel : active_job.options.progress_channels)
+    header.push_back(mmap_id_to_uc_paddr_map[channel]);
+  std::vector<uint8_t> command((uint8_t*)header.data(),
+                               (uint8_t*)(header.data() + header.size()));
+  command.insert(command.end(), active_job.job_descriptor.begin(),
+                 active_job.job_descriptor.end());
+  return write_command_to_device(device_path, PickleDeviceCommand::SUBMIT_JOB,
+                                 command.size(), command.data());
+}
+
 PickleDevicePrefetcherSpecs PickleDeviceManager::getDevicePrefetcherSpecs() {
   PickleDevicePrefetcherSpecs specs;
   struct device_specs k_specs;
 
-  k_specs = get_device_specs();
+  k_specs = get_device_specs(device_path);
 
   specs.availability = k_specs.availability;
   specs.prefetch_distance = k_specs.prefetch_distance;
@@ -125,3 +363,34 @@ PickleDevicePrefetcherSpecs PickleDeviceManager::getDevicePrefetcherSpecs() {
   specs.bulk_mode_chunk_size = k_specs.bulk_mode_chunk_size;
   return specs;
 }
+
+const PickleDeviceCapabilities& PickleDeviceManager::getDeviceCapabilities() {
+  std::lock_guard<std::recursive_mutex> lock(manager_mutex);
+  if (capabilities_queried)
+    return capabilities;
+  capabilities_queried = true;
+  struct device_capabilities k_caps;
+  if (!get_device_capabilities(device_path, k_caps)) {
+    std::cout << "PickleDeviceManager: no capability query, assuming "
+                 "protocol version 0"
+              << std::endl;
+    return capabilities;
+  }
+  capabilities.protocol_version = k_caps.protocol_version;
+  capabilities.max_arrays_per_job = k_caps.max_arrays_per_job;
+  capabilities.max_watch_ranges = k_caps.max_watch_ranges;
+  capabilities.max_watch_range_bytes = k_caps.max_watch_range_bytes;
+  if (capabilities.protocol_version >= 2)
+    capabilities.max_concurrent_jobs = k_caps.max_concurrent_jobs;
+  capabilities.generators_known = true;
+  for (uint64_t i = 0; i < k_caps.num_generators; i++) {
+    const struct device_generator& g = k_caps.generators[i];
+    capabilities.generators.push_back(
+        {g.id, std::string(g.name, strnlen(g.name, sizeof(g.name)))});
+  }
+  return capabilities;
+}
+
+PickleGeneratorRegistry& PickleDeviceManager::getGeneratorRegistry() {
+  return generator_registry;
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef PICKLE_DRIVER_COMPAT_H
+#define PICKLE_DRIVER_COMPAT_H
+
+#include <sys/ioctl.h>
+
+#include <cstdint>
+
+// Driver interfaces newer than some installed pickle_driver.h; include it
+// after pickle_driver.h so definitions from the driver take precedence.
+
+// Capability query, protocol version 1; older drivers fail the ioctl.
+// max_concurrent_jobs is valid from protocol version 2 (job ids, see
+// PickleDeviceCommand::SUBMIT_JOB).
+#ifndef IOC_PICKLE_DRIVER_GET_DEVICE_CAPABILITIES
+#define PICKLE_MAX_GENERATORS 32
+#define PICKLE_GENERATOR_NAME_LENGTH 32
+struct device_generator {
+  uint64_t id;
+  char name[PICKLE_GENERATOR_NAME_LENGTH];
+};
+struct device_capabilities {
+  uint64_t protocol_version;
+  uint64_t max_arrays_per_job;
+  uint64_t max_watch_ranges;
+  uint64_t max_watch_range_bytes;
+  uint64_t num_generators;
+  struct device_generator generators[PICKLE_MAX_GENERATORS];
+  uint64_t max_concurrent_jobs;
+};
+#define IOC_PICKLE_DRIVER_GET_DEVICE_CAPABILITIES \
+  _IOR('p', 4, struct device_capabilities)
+#endif  // IOC_PICKLE_DRIVER_GET_DEVICE_CAPABILITIES
+
+#endif  // PICKLE_DRIVER_COMPAT_H
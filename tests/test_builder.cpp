@@ -0,0 +1,113 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+
+Graph BuildGraph(std::vector<std::string> args) {
+  std::vector<char*> argv;
+  args.insert(args.begin(), "test_builder");
+  for (std::string &arg : args)
+    argv.push_back(&arg[0]);
+  optind = 1;
+  CLBase cli(argv.size(), argv.data());
+  cli.ParseArgs();
+  return Builder(cli).MakeGraph();
+}
+
+// Random edges with skewed out-degrees, self loops and duplicates, enough of
+// them for the in-place compaction to run rounds past its serial prefix
+void WriteEdgeList(const std::string &filename) {
+  const NodeID kNumNodes = 1 << 12;
+  std::mt19937 rng(27);
+  std::ofstream el(filename);
+  for (int i=0; i < 16 * kNumNodes; i++) {
+    NodeID u = int64_t(rng() % kNumNodes) * (rng() % kNumNodes) / kNumNodes;
+    NodeID v = rng() % 8 == 0 ? u : rng() % kNumNodes;
+    for (int copies = rng() % 4 == 0 ? 2 : 1; copies > 0; copies--)
+      el << u << " " << v << "\n";
+  }
+}
+
+template <typename Neighborhood>
+bool SameNeighborhood(Neighborhood a, Neighborhood b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+// The in-place builder matches the regular one neighbor for neighbor, in
+// and out
+bool SameAsInPlace(std::vector<std::string> args, const std::string &name) {
+  Graph regular = BuildGraph(args);
+  args.push_back("-m");
+  Graph in_place = BuildGraph(args);
+  bool pass = in_place.num_nodes() == regular.num_nodes() &&
+              in_place.num_edges_directed() == regular.num_edges_directed() &&
+              in_place.directed() == regular.directed();
+  for (NodeID u=0; pass && u < regular.num_nodes(); u++) {
+    pass = SameNeighborhood(regular.out_neigh(u), in_place.out_neigh(u)) &&
+           SameNeighborhood(regular.in_neigh(u), in_place.in_neigh(u));
+  }
+  if (!pass)
+    std::cout << name << ": in-place graph differs" << std::endl;
+  return pass;
+}
+
+// Builds the same edge list with the regular and the in-place builder and
+// checks that both produce identical, squished CSRs with matching descriptors
+int main() {
+  const std::string filename = "/tmp/test_builder.el";
+  {
+    std::ofstream el(filename);
+    el << "# u v\n0 1\n0 2\n1 2\n2 0\n2 0\n3 3\n3 1\n";
+  }
+
+  char arg0[] = "test_builder";
+  char arg1[] = "-f";
+  char* arg2 = const_cast<char*>(filename.c_str());
+  char arg3[] = "-m";
+  char* regular_argv[] = {arg0, arg1, arg2};
+  char* in_place_argv[] = {arg0, arg1, arg2, arg3};
+  CLBase regular_cli(3, regular_argv);
+  regular_cli.ParseArgs();
+  optind = 1;
+  CLBase in_place_cli(4, in_place_argv);
+  in_place_cli.ParseArgs();
+
+  Graph regular = Builder(regular_cli).MakeGraph();
+  Graph in_place = Builder(in_place_cli).MakeGraph();
+  std::remove(filename.c_str());
+
+  bool pass = (regular.num_nodes() == 4) && (regular.num_edges() == 5) &&
+              (in_place.num_edges() == regular.num_edges());
+  for (NodeID u=0; pass && u < regular.num_nodes(); u++) {
+    pass &= std::equal(regular.out_neigh(u).begin(), regular.out_neigh(u).end(),
+                       in_place.out_neigh(u).begin(),
+                       in_place.out_neigh(u).end());
+    pass &= std::equal(regular.in_neigh(u).begin(), regular.in_neigh(u).end(),
+                       in_place.in_neigh(u).begin(), in_place.in_neigh(u).end());
+  }
+  std::shared_ptr<PickleArrayDescriptor> neighs =
+      in_place.getOutNeighborsArrayDescriptor();
+  pass &= (neighs->vaddr_end - neighs->vaddr_start) / neighs->element_size ==
+          (uint64_t) in_place.num_edges_directed();
+  pass &= neighs->vaddr_start == (uint64_t) in_place.out_neigh(0).begin();
+
+  const std::string el = "/tmp/test_builder_large.el";
+  WriteEdgeList(el);
+  pass = pass && SameAsInPlace({"-f", el}, "directed") &&
+         SameAsInPlace({"-f", el, "-s"}, "undirected");
+  std::remove(el.c_str());
+
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
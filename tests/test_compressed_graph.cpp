@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/compressed_graph.h"
+
+typedef CompressedGraph<NodeID> CGraph;
+
+Graph BuildGraph(std::vector<std::string> args) {
+  std::vector<char*> argv;
+  args.insert(args.begin(), "test_compressed_graph");
+  for (std::string &arg : args)
+    argv.push_back(&arg[0]);
+  optind = 1;
+  CLBase cli(argv.size(), argv.data());
+  cli.ParseArgs();
+  return Builder(cli).MakeGraph();
+}
+
+// Degrees around the block size (64) of the codec, zero and partial blocks
+// only, and gaps from 1 up to the width of the whole ID range
+void WriteEdgeList(const std::string &filename) {
+  const NodeID kNumNodes = 1 << 20;
+  const int degrees[] = {1, 2, 3, 4, 5, 31, 63, 64, 65, 127, 128, 129, 192,
+                         200, 1000};
+  std::mt19937 rng(8);
+  std::ofstream el(filename);
+  NodeID u = 1;  // vertex 0 has no edges
+  for (int degree : degrees) {
+    for (int i=0; i < degree; i++)
+      el << u << " " << rng() % kNumNodes << "\n";
+    u += 2;  // every other vertex has no out-edges
+    for (int i=0; i < degree; i++)
+      el << u << " " << u + 1 + i << "\n";  // gaps of 1
+    u += 2;
+  }
+  el << u << " 0\n" << u << " " << kNumNodes - 1 << "\n";  // widest gap
+}
+
+template <typename Neighborhood>
+bool SameNeighbors(const std::vector<NodeID> &decoded, int64_t num_decoded,
+                   Neighborhood expected) {
+  std::vector<NodeID> sorted(expected.begin(), expected.end());
+  std::sort(sorted.begin(), sorted.end());
+  return num_decoded == static_cast<int64_t>(sorted.size()) &&
+         std::equal(sorted.begin(), sorted.end(), decoded.begin());
+}
+
+// Compares every neighborhood of g with its encoding, decoded alone and
+// with the whole graph, also after a write and read of the .csg file
+bool RoundTrip(const Graph &g, const std::string &name) {
+  const std::string filename = "/tmp/test_compressed_graph.csg";
+  CGraph encoded(g);
+  {
+    std::fstream out(filename, std::ios::out | std::ios::binary);
+    encoded.Write(out);
+  }
+  CGraph read(filename);
+  std::remove(filename.c_str());
+  Graph decoded = read.Decode();
+  bool pass = encoded.directed() == g.directed() &&
+              encoded.num_nodes() == g.num_nodes() &&
+              decoded.num_nodes() == g.num_nodes() &&
+              decoded.num_edges_directed() == g.num_edges_directed();
+  std::vector<NodeID> neighs;
+  for (NodeID u=0; pass && u < g.num_nodes(); u++) {
+    for (const CGraph *c : {&encoded, &read}) {
+      pass &= c->out_degree(u) == g.out_degree(u) &&
+              c->in_degree(u) == g.in_degree(u);
+      neighs.assign(g.out_degree(u), -1);
+      pass &= SameNeighbors(neighs, c->DecodeOutNeigh(u, neighs.data()),
+                            g.out_neigh(u));
+      neighs.assign(g.in_degree(u), -1);
+      pass &= SameNeighbors(neighs, c->DecodeInNeigh(u, neighs.data()),
+                            g.in_neigh(u));
+    }
+    neighs.assign(decoded.out_neigh(u).begin(), decoded.out_neigh(u).end());
+    pass &= SameNeighbors(neighs, neighs.size(), g.out_neigh(u));
+    neighs.assign(decoded.in_neigh(u).begin(), decoded.in_neigh(u).end());
+    pass &= SameNeighbors(neighs, neighs.size(), g.in_neigh(u));
+    if (!pass)
+      std::cout << name << ": vertex " << u << " differs" << std::endl;
+  }
+  return pass;
+}
+
+int main() {
+  const std::string el = "/tmp/test_compressed_graph.el";
+  WriteEdgeList(el);
+  bool pass = RoundTrip(BuildGraph({"-f", el}), "crafted directed") &&
+              RoundTrip(BuildGraph({"-f", el, "-s"}), "crafted undirected");
+  std::remove(el.c_str());
+  pass = pass && RoundTrip(BuildGraph({"-g", "12"}), "kronecker") &&
+         RoundTrip(BuildGraph({"-u", "12", "-k", "70"}), "uniform degree 70");
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
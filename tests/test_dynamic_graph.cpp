@@ -0,0 +1,175 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/dynamic_graph.h"
+
+typedef DynamicGraph<NodeID> DynGraph;
+typedef std::set<std::pair<NodeID, NodeID>> EdgeSet;
+
+Graph BuildGraph(std::vector<std::string> args) {
+  std::vector<char*> argv;
+  args.insert(args.begin(), "test_dynamic_graph");
+  for (std::string &arg : args)
+    argv.push_back(&arg[0]);
+  optind = 1;
+  CLBase cli(argv.size(), argv.data());
+  cli.ParseArgs();
+  return Builder(cli).MakeGraph();
+}
+
+// Random directed edges with skewed out-degrees (synthetic graphs, -g and
+// -u, are always symmetrized)
+void WriteEdgeList(const std::string &filename) {
+  const NodeID kNumNodes = 1 << 10;
+  std::mt19937 rng(14);
+  std::ofstream el(filename);
+  for (int i=0; i < 16 * kNumNodes; i++) {
+    NodeID u = int64_t(rng() % kNumNodes) * (rng() % kNumNodes) / kNumNodes;
+    el << u << " " << rng() % kNumNodes << "\n";
+  }
+}
+
+// What ApplyBatch does, on a set holding both orientations of an
+// undirected edge
+void ApplyToReference(const DynGraph::EdgeList &inserts,
+                      const DynGraph::EdgeList &deletes, bool directed,
+                      EdgeSet *edges) {
+  for (const DynGraph::Edge &e : deletes) {
+    edges->erase({e.u, e.v});
+    if (!directed)
+      edges->erase({e.v, e.u});
+  }
+  for (const DynGraph::Edge &e : inserts) {
+    if (e.u == e.v)
+      continue;
+    edges->insert({e.u, e.v});
+    if (!directed)
+      edges->insert({e.v, e.u});
+  }
+}
+
+// Inserts of new, present and just deleted edges and self loops; deletes
+// of base, delta and missing edges
+void RandomBatch(std::mt19937 &rng, NodeID num_nodes, const EdgeSet &edges,
+                 DynGraph::EdgeList *inserts, DynGraph::EdgeList *deletes) {
+  std::uniform_int_distribution<NodeID> vertex(0, num_nodes - 1);
+  std::vector<std::pair<NodeID, NodeID>> present;
+  std::sample(edges.begin(), edges.end(), std::back_inserter(present), 200,
+              rng);
+  for (const auto &e : present) {
+    if (rng() % 2)
+      deletes->push_back(DynGraph::Edge(e.first, e.second));
+    if (rng() % 8 == 0)
+      inserts->push_back(DynGraph::Edge(e.first, e.second));
+  }
+  for (int i=0; i < 200; i++) {
+    NodeID u = vertex(rng);
+    NodeID v = rng() % 16 == 0 ? u : vertex(rng);
+    inserts->push_back(DynGraph::Edge(u, v));
+    if (rng() % 8 == 0)
+      inserts->push_back(DynGraph::Edge(u, v));
+    if (rng() % 4 == 0)
+      deletes->push_back(DynGraph::Edge(vertex(rng), vertex(rng)));
+  }
+}
+
+template <typename Neighborhood>
+bool SameNeighbors(Neighborhood neighs, const EdgeSet &edges, NodeID u) {
+  std::vector<NodeID> got;
+  for (NodeID v : neighs)
+    got.push_back(v);
+  std::sort(got.begin(), got.end());
+  auto first = edges.lower_bound({u, 0});
+  auto last = edges.lower_bound({u + 1, 0});
+  std::vector<NodeID> expected;
+  for (auto it = first; it != last; ++it)
+    expected.push_back(it->second);
+  return got == expected;
+}
+
+int64_t Degree(const EdgeSet &edges, NodeID u) {
+  return std::distance(edges.lower_bound({u, 0}),
+                       edges.lower_bound({u + 1, 0}));
+}
+
+bool Matches(const DynGraph &g, const EdgeSet &out_edges,
+             const std::string &name) {
+  if (g.num_edges_directed() != static_cast<int64_t>(out_edges.size())) {
+    std::cout << name << ": edge count differs" << std::endl;
+    return false;
+  }
+  EdgeSet in_edges;
+  for (const auto &e : out_edges)
+    in_edges.insert({e.second, e.first});
+  for (NodeID u=0; u < g.num_nodes(); u++) {
+    if (!SameNeighbors(g.out_neigh(u), out_edges, u) ||
+        !SameNeighbors(g.in_neigh(u), in_edges, u) ||
+        g.out_degree(u) != Degree(out_edges, u) ||
+        g.in_degree(u) != Degree(in_edges, u)) {
+      std::cout << name << ": vertex " << u << " differs" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// Applies random batches to a DynamicGraph and checks every neighborhood
+// against a set of the edges after each; compact_every > 0 starts a
+// compaction every that many batches, installed a few batches later
+bool Run(Graph &&base, const std::string &name, int compact_every) {
+  EdgeSet edges;
+  for (NodeID u : base.vertices()) {
+    for (NodeID v : base.out_neigh(u))
+      edges.insert({u, v});
+  }
+  DynGraph g(std::move(base));
+  std::mt19937 rng(name.size() * 31 + compact_every);
+  bool pass = Matches(g, edges, name + " base");
+  for (int batch=1; pass && batch <= 30; batch++) {
+    if (compact_every > 0 && batch % compact_every == 0)
+      g.StartCompaction();
+    DynGraph::EdgeList inserts, deletes;
+    RandomBatch(rng, g.num_nodes(), edges, &inserts, &deletes);
+    const uint64_t version = g.version();
+    g.ApplyBatch(inserts, deletes);
+    ApplyToReference(inserts, deletes, g.directed(), &edges);
+    pass = g.version() != version &&
+           Matches(g, edges, name + " batch " + std::to_string(batch));
+    if (pass && compact_every > 0 && batch % compact_every == 2) {
+      g.FinishCompaction();
+      pass = Matches(g, edges, name + " compaction " + std::to_string(batch));
+    }
+  }
+  g.FinishCompaction();
+  return pass && Matches(g, edges, name + " end");
+}
+
+int main() {
+  const std::string el = "/tmp/test_dynamic_graph.el";
+  WriteEdgeList(el);
+  bool pass = Run(BuildGraph({"-f", el}), "directed", 0) &&
+              Run(BuildGraph({"-f", el}), "directed compacted", 5) &&
+              Run(BuildGraph({"-f", el, "-s"}), "skewed undirected", 0);
+  std::remove(el.c_str());
+  pass = pass &&
+         Run(BuildGraph({"-g", "10"}), "undirected compacted", 4) &&
+         Run(BuildGraph({"-u", "9", "-k", "4"}), "sparse compacted", 3);
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/pvector.h"
+#include "graphs/gapbs/sliding_queue.h"
+#include "graphs/gapbs/wrapper.h"
+#include "pickle_job_shape.h"
+
+struct Consumer : PickleShapeArray<> {};
+struct Selector : PickleShapeArray<> {};
+
+bool SameDescriptor(const std::string &name, const PickleJob &built,
+                    const std::vector<uint8_t> &shaped) {
+  const std::vector<uint8_t> expected = built.getJobDescriptor();
+  if (expected == shaped)
+    return true;
+  std::cout << name << ": static descriptor differs" << std::endl;
+  built.print();
+  return false;
+}
+
+// Lays out the jobs of the createGraphJobUsing*Edges builders with the
+// equivalent static shapes and compares the descriptor bytes
+int main() {
+  char arg0[] = "test_job_shape";
+  char arg1[] = "-g";
+  char arg2[] = "10";
+  char* argv[] = {arg0, arg1, arg2};
+  optind = 1;
+  CLBase cli(3, argv);
+  cli.ParseArgs();
+  Graph g = Builder(cli).MakeGraph();
+  pvector<float> scores(g.num_nodes());
+  pvector<NodeID> parents(g.num_nodes());
+  SlidingQueue<NodeID> queue(g.num_nodes());
+
+  PickleStaticJob<PickleChain<PickleOutIndex, PickleOutNeighbors, Consumer>>
+      out_job("out");
+  out_job.setGraph(g);
+  out_job.set<Consumer>(scores.getArrayDescriptor());
+  bool pass = out_job.complete() && SameDescriptor("out",
+      createGraphJobUsingOutgoingEdges(&g, "out", nullptr, &scores),
+      out_job.getJobDescriptor());
+
+  PickleStaticJob<PickleChain<PickleInIndex, PickleInNeighbors, Consumer>>
+      in_job("in");
+  in_job.setGraph(g);
+  in_job.set<Consumer>(scores.getArrayDescriptor());
+  pass &= in_job.complete() && SameDescriptor("in",
+      createGraphJobUsingIncomingEdges(&g, "in", nullptr, &scores),
+      in_job.getJobDescriptor());
+
+  // a selector comes after the neighbors, a consumer last
+  PickleStaticJob<PickleJobShape<PickleLink<PickleOutIndex, PickleOutNeighbors>,
+                                 PickleLink<PickleOutNeighbors, Consumer>,
+                                 PickleLink<Selector, PickleOutIndex>,
+                                 PickleLink<Consumer>>>
+      selected_job("selected");
+  selected_job.setGraph(g);
+  selected_job.set<Selector>(queue.getArrayDescriptor());
+  selected_job.set<Consumer>(parents.getArrayDescriptor());
+  pass &= selected_job.complete() && SameDescriptor("selected",
+      createGraphJobUsingOutgoingEdges(&g, "selected", &queue, &parents),
+      selected_job.getJobDescriptor());
+
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
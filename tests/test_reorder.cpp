@@ -0,0 +1,134 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/reorder.h"
+
+template <typename BuilderT>
+auto BuildGraph(std::vector<std::string> args) {
+  std::vector<char*> argv;
+  args.insert(args.begin(), "test_reorder");
+  for (std::string &arg : args)
+    argv.push_back(&arg[0]);
+  optind = 1;
+  CLBase cli(argv.size(), argv.data());
+  cli.ParseArgs();
+  return BuilderT(cli).MakeGraph();
+}
+
+// Random directed edges with skewed out-degrees and a few isolated
+// vertices (synthetic graphs, -g and -u, are always symmetrized)
+void WriteEdgeList(const std::string &filename) {
+  const NodeID kNumNodes = 1 << 11;
+  std::mt19937 rng(26);
+  std::ofstream el(filename);
+  for (int i=0; i < 8 * kNumNodes; i++) {
+    NodeID u = int64_t(rng() % kNumNodes) * (rng() % kNumNodes) / kNumNodes;
+    el << u << " " << rng() % (kNumNodes - 16) << "\n";
+  }
+  el << kNumNodes - 1 << " " << kNumNodes - 2 << "\n";
+}
+
+NodeID IdOf(NodeID d) { return d; }
+NodeID IdOf(const WNode &d) { return d.v; }
+NodeID WithId(NodeID, NodeID id) { return id; }
+WNode WithId(const WNode &d, NodeID id) { return WNode(id, d.w); }
+
+// WNode's == ignores the weight
+template <typename DestID_>
+bool SameList(std::vector<DestID_> a, std::vector<DestID_> b) {
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [] (const DestID_ &x, const DestID_ &y) {
+                      return !(x < y) && !(y < x);
+                    });
+}
+
+// The neighborhood of u in from, relabeled with ids, equals the one of
+// ids[u] in to
+template <typename GraphT_, typename Neighs>
+bool SameNeighborhoods(const GraphT_ &from, const GraphT_ &to,
+                       const pvector<NodeID> &ids, Neighs neighs) {
+  typedef typename std::remove_reference<
+      decltype(*neighs(from, 0).begin())>::type DestID_;
+  for (NodeID u=0; u < from.num_nodes(); u++) {
+    std::vector<DestID_> mapped, expected;
+    for (const DestID_ &d : neighs(from, u))
+      mapped.push_back(WithId(d, ids[IdOf(d)]));
+    for (const DestID_ &d : neighs(to, ids[u]))
+      expected.push_back(d);
+    if (!SameList(mapped, expected))
+      return false;
+  }
+  return true;
+}
+
+// Relabels g with every method and checks that the mapping is a
+// permutation whose two directions invert each other, that per-vertex
+// values survive a round trip, and that the relabeled graph maps onto g
+// and g onto it edge for edge (weights included), in and out
+template <typename GraphT_>
+bool CheckReorder(const GraphT_ &g, const std::string &name) {
+  const ReorderMethod methods[] = {
+      ReorderMethod::kNone, ReorderMethod::kDegreeSort,
+      ReorderMethod::kHubCluster, ReorderMethod::kRCM, ReorderMethod::kGorder};
+  auto out = [] (const GraphT_ &h, NodeID u) { return h.out_neigh(u); };
+  auto in = [] (const GraphT_ &h, NodeID u) { return h.in_neigh(u); };
+  pvector<int64_t> values(g.num_nodes());
+  for (NodeID n=0; n < g.num_nodes(); n++)
+    values[n] = int64_t(n) * 7919 + 13;
+  bool pass = true;
+  for (ReorderMethod method : methods) {
+    VertexMapping<NodeID> mapping;
+    GraphT_ r = ReorderGraph(g, method, &mapping);
+    bool ok = r.num_nodes() == g.num_nodes() &&
+              r.num_edges_directed() == g.num_edges_directed() &&
+              r.directed() == g.directed() &&
+              static_cast<NodeID>(mapping.new_ids.size()) == g.num_nodes();
+    std::vector<bool> seen(g.num_nodes(), false);
+    for (NodeID n=0; ok && n < g.num_nodes(); n++) {
+      NodeID new_id = mapping.ToNew(n);
+      ok = new_id >= 0 && new_id < g.num_nodes() && !seen[new_id] &&
+           mapping.ToOld(new_id) == n && mapping.ToNew(mapping.ToOld(n)) == n;
+      if (ok)
+        seen[new_id] = true;
+    }
+    pvector<int64_t> round_trip =
+        mapping.ToOriginal(mapping.ToReordered(values));
+    ok = ok && std::equal(values.begin(), values.end(), round_trip.begin());
+    ok = ok && SameNeighborhoods(g, r, mapping.new_ids, out) &&
+         SameNeighborhoods(r, g, mapping.old_ids, out) &&
+         SameNeighborhoods(g, r, mapping.new_ids, in) &&
+         SameNeighborhoods(r, g, mapping.old_ids, in);
+    if (!ok)
+      std::cout << name << ": " << ReorderMethodName(method) << " failed"
+                << std::endl;
+    pass &= ok;
+  }
+  return pass;
+}
+
+int main() {
+  const std::string el = "/tmp/test_reorder.el";
+  WriteEdgeList(el);
+  bool pass = CheckReorder(BuildGraph<Builder>({"-f", el}), "directed") &&
+              CheckReorder(BuildGraph<Builder>({"-f", el, "-s"}),
+                           "undirected");
+  std::remove(el.c_str());
+  pass = pass && CheckReorder(BuildGraph<Builder>({"-g", "11"}), "kronecker") &&
+         CheckReorder(BuildGraph<WeightedBuilder>({"-g", "10"}), "weighted");
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
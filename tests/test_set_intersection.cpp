@@ -0,0 +1,80 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "graphs/gapbs/set_intersection.h"
+
+// size distinct values of [-universe/2, universe/2), in increasing order
+std::vector<int32_t> RandomSortedList(std::mt19937 &rng, size_t size,
+                                      int32_t universe) {
+  std::vector<int32_t> values(universe), list;
+  std::iota(values.begin(), values.end(), -universe / 2);
+  std::sample(values.begin(), values.end(), std::back_inserter(list), size,
+              rng);
+  return list;
+}
+
+bool Check(const std::vector<int32_t> &a, const std::vector<int32_t> &b) {
+  std::vector<int32_t> expected;
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(expected));
+  const int32_t *pa = a.data(), *pb = b.data();
+  // a non-pointer iterator takes the scalar merge, as in trace builds
+  std::list<int32_t> la(a.begin(), a.end()), lb(b.begin(), b.end());
+  size_t sizes[] = {
+      SortedIntersectionSize(pa, pa + a.size(), pb, pb + b.size()),
+      SortedIntersectionSize(b, a),
+      intersection::MergeIntersectionSize(pa, pa + a.size(),
+                                          pb, pb + b.size()),
+      intersection::MergeIntersectionSize(la.begin(), la.end(),
+                                          lb.begin(), lb.end()),
+      intersection::GallopingIntersectionSize(a.begin(), a.end(),
+                                              b.begin(), b.end()),
+      intersection::GallopingIntersectionSize(b.begin(), b.end(),
+                                              a.begin(), a.end())};
+  for (size_t size : sizes) {
+    if (size != expected.size()) {
+      std::cout << "lists of " << a.size() << " and " << b.size() << ": "
+                << size << " != " << expected.size() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Compares the intersection sizes of SortedIntersectionSize and of each of
+// its kernels with std::set_intersection on random strictly increasing
+// lists: empty, shorter than a SIMD block, of similar lengths with unequal
+// tails, and skewed past kGallopRatio so the galloping kernel is picked
+int main() {
+  std::mt19937 rng(27491095);
+  bool pass = Check({}, {}) && Check({}, {1, 2, 3}) && Check({5}, {}) &&
+              Check({1, 2, 3, 4}, {1, 2, 3, 4}) &&
+              Check({1, 2, 3, 4, 5}, {5, 6, 7, 8, 9});
+  const size_t short_sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 31, 64, 100};
+  for (int trial=0; pass && trial < 2000; trial++) {
+    size_t a_size = short_sizes[trial % 12];
+    size_t b_size;
+    switch (trial % 3) {
+      case 0: b_size = a_size + rng() % 9; break;                 // similar
+      case 1: b_size = rng() % 4; break;                          // tiny
+      default: b_size = (a_size + 1) * (33 + rng() % 200); break; // skewed
+    }
+    // small universes give many common elements, large ones few
+    int32_t universe = 1 + rng() % (trial % 2 ? 64 : 1 << 16);
+    universe = std::max<int32_t>(universe, std::max(a_size, b_size));
+    pass = Check(RandomSortedList(rng, a_size, universe),
+                 RandomSortedList(rng, b_size, universe));
+  }
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <omp.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <iostream>
+#include <memory>
+
+#include "graphs/gapbs/work_stealing.h"
+
+// Busy work growing with i inside the heavy prefix of the range, so the
+// static share of the first worker dwarfs everyone else's
+int64_t Work(int64_t i, int64_t begin, int64_t heavy_end) {
+  int64_t spins = i < heavy_end ? 10 * (heavy_end - i) : 1;
+  volatile int64_t sink = begin;
+  for (int64_t s=0; s < spins; s++)
+    sink = sink + s;
+  return sink;
+}
+
+bool RunsOnce(WorkStealingScheduler &scheduler, int64_t begin, int64_t end,
+              int64_t grain) {
+  const int64_t length = end - begin;
+  const int64_t heavy_end = begin + length / 64;
+  std::unique_ptr<std::atomic<int>[]> runs(new std::atomic<int>[length]);
+  for (int64_t i=0; i < length; i++)
+    runs[i].store(0);
+  std::atomic<int64_t> published(0), out_of_range(0);
+  #pragma omp parallel
+  scheduler.For(begin, end, grain,
+      [&](int64_t i) {
+        if (i < begin || i >= end) {
+          out_of_range++;
+          return;
+        }
+        Work(i, begin, heavy_end);
+        runs[i - begin]++;
+      },
+      [&](int, int64_t range_begin, int64_t range_end) {
+        published += range_end - range_begin;
+      });
+  bool pass = out_of_range == 0 && published == length;
+  for (int64_t i=0; i < length; i++) {
+    if (runs[i] != 1) {
+      std::cout << "[" << begin << ", " << end << ") grain " << grain
+                << ": index " << begin + i << " ran " << runs[i]
+                << " times" << std::endl;
+      return false;
+    }
+  }
+  if (!pass)
+    std::cout << "[" << begin << ", " << end << ") grain " << grain
+              << ": published " << published << " indices" << std::endl;
+  return pass;
+}
+
+// Runs For over ranges whose work is concentrated in the first worker's
+// share, with more threads than cores so workers are preempted mid-steal,
+// and checks that every index runs exactly once
+int main() {
+  omp_set_num_threads(32);
+  WorkStealingScheduler scheduler;
+  bool pass = true;
+  const int64_t grains[] = {1, 7, 64, 1 << 20};
+  for (int trial=0; pass && trial < 5; trial++) {
+    for (int64_t grain : grains) {
+      pass &= RunsOnce(scheduler, 0, 1 << 14, grain) &&
+              RunsOnce(scheduler, -5000, 123457, grain) &&
+              RunsOnce(scheduler, 3, 20, grain) &&
+              RunsOnce(scheduler, 9, 9, grain);
+    }
+  }
+  std::cout << (pass ? "PASS" : "FAIL") << std::endl;
+  return pass ? 0 : 1;
+}
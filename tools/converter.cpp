@@ -0,0 +1,51 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <iostream>
+
+#include "graphs/gapbs/benchmark.h"
+#include "graphs/gapbs/builder.h"
+#include "graphs/gapbs/command_line.h"
+#include "graphs/gapbs/graph.h"
+#include "graphs/gapbs/writer.h"
+
+
+/*
+GAP Benchmark Suite
+Tool:   Converter
+
+Builds a graph the way the kernels do (file or generator) and writes it out
+as an edge list (-e), a serialized graph (-b), a sharded serialized graph
+(-x, -n shards) that kernels stream from disk (StreamingGraph) or a
+compressed serialized graph (-z) that kernels decode on load
+(CompressedGraph)
+*/
+
+
+using namespace std;
+
+template <typename BuilderT, typename WriterT>
+void Convert(const CLConvert &cli) {
+  BuilderT b(cli);
+  auto g = b.MakeGraph();
+  g.PrintStats();
+  WriterT w(g);
+  if (cli.out_sgs())
+    w.WriteShardedGraph(cli.out_filename(), cli.num_shards());
+  else if (cli.out_csg())
+    w.WriteCompressedGraph(cli.out_filename());
+  else
+    w.WriteGraph(cli.out_filename(), cli.out_sg());
+}
+
+int main(int argc, char* argv[]) {
+  CLConvert cli(argc, argv, "converter");
+  if (!cli.ParseArgs())
+    return -1;
+  if (cli.out_weighted())
+    Convert<WeightedBuilder, WeightedWriter>(cli);
+  else
+    Convert<Builder, Writer>(cli);
+  return 0;
+}
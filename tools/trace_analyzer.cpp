@@ -0,0 +1,652 @@
+// Copyright (c) 2026 The Regents of the University of California
+// All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "graphs/gapbs/access_trace.h"
+#include "pickle_job.h"
+
+/*
+Offline prefetch coverage and timeliness of a PickleJob
+
+Replays an access trace recorded by a <kernel>-trace build with
+PICKLE_TRACE_FILE set (access_recorder.h) through a cache model twice, once
+on demand accesses alone and once with a model of the device prefetching for
+a job, and reports per array:
+ - coverage: share of the demand misses the prefetches remove
+ - late: share of the useful prefetches still in flight when demanded
+ - accuracy: share of the issued prefetches a demand access used
+ - overhead: extra lines fetched from memory, relative to the misses without
+   prefetching
+
+Model
+ - Each thread of the trace has a private set-associative LRU cache and its
+   own device walker; time is counted in the thread's accesses
+ - The walker follows the job like the device would: the array no other
+   array targets drives it, and every publish period driver accesses it
+   walks the chain for the next distance driver positions, loading each
+   element's value to find the element it indexes (Index) or points to
+   (Pointer) in the next array. A link out of an array of 8-byte
+   non-decreasing values (CSR offsets or pointers) or a Ranged one covers
+   [value(i), value(i+1)), up to the range limit
+ - Values come from the trace itself: the next value this thread reads at
+   that address, else the first any thread read. A chain stops at an element
+   no thread read, or at a SetBits selector (its bits are not traced)
+ - A prefetch becomes usable latency accesses after it is issued
+
+Usage: trace_analyzer [-j job] [-d job.bin] [-D distance] [-p period]
+                      [-l latency] [-c cache KiB] [-w ways] [-L line bytes]
+                      [-r range limit] trace
+ -j evaluates one job of the trace (the last is the recorder's proposal),
+ -d a raw job descriptor (PickleJob::getJobDescriptor) instead
+*/
+
+
+struct JobArray {
+  uint64_t id;
+  uint64_t dst;
+  uint64_t vaddr_start;
+  uint64_t vaddr_end;
+  uint64_t element_size;
+  uint64_t access_type;
+  uint64_t addressing_mode;
+  bool ranged;
+
+  uint64_t num_elements() const {
+    if (access_type == AccessType::SetBits)
+      return (vaddr_end - vaddr_start) * 8;
+    return (vaddr_end - vaddr_start) / std::max<uint64_t>(element_size, 1);
+  }
+
+  uint64_t ElementAddress(uint64_t pos) const {
+    if (access_type == AccessType::SetBits)
+      return vaddr_start + pos / 64 * 8;
+    return vaddr_start + pos * element_size;
+  }
+};
+
+struct Job {
+  std::string kernel_name;
+  std::vector<JobArray> arrays;
+  int driver;
+  int times_sent;
+};
+
+static const uint64_t kNoArray = -1ULL;
+
+bool ParseJob(const std::vector<uint8_t> &bytes, Job *job) {
+  const size_t kArrayBytes = 7 * 8;
+  if (bytes.empty() || bytes.size() < 1 + bytes[0] * kArrayBytes)
+    return false;
+  job->arrays.resize(bytes[0]);
+  const uint8_t *pos = bytes.data() + 1;
+  for (JobArray &a : job->arrays) {
+    uint64_t fields[7];
+    std::memcpy(fields, pos, kArrayBytes);
+    pos += kArrayBytes;
+    a = JobArray{fields[0], fields[1], fields[2], fields[3], fields[4],
+                 fields[5], fields[6], false};
+    if (a.dst != kNoArray && a.dst >= bytes[0])
+      return false;
+  }
+  job->kernel_name.assign(pos, bytes.data() + bytes.size());
+  // the driver is the first array no other array targets
+  job->driver = -1;
+  for (size_t i=0; i < job->arrays.size() && job->driver < 0; i++) {
+    bool targeted = false;
+    for (const JobArray &a : job->arrays)
+      targeted |= a.dst == job->arrays[i].id && &a != &job->arrays[i];
+    if (!targeted)
+      job->driver = i;
+  }
+  return job->driver >= 0;
+}
+
+
+struct Config {
+  uint64_t distance = 32;
+  uint64_t period = 0;  // 0: distance / 4, as PickleKernelContext publishes
+  uint64_t latency = 100;
+  uint64_t cache_bytes = 1 << 20;
+  uint64_t ways = 16;
+  uint64_t line_bytes = 64;
+  uint64_t range_limit = 256;
+};
+
+
+// Counts per traced array
+struct ArrayCounts {
+  uint64_t accesses = 0;
+  uint64_t baseline_misses = 0;
+  uint64_t misses = 0;
+  uint64_t timely = 0;
+  uint64_t late = 0;
+  uint64_t issued = 0;
+
+  void Add(const ArrayCounts &o) {
+    accesses += o.accesses;
+    baseline_misses += o.baseline_misses;
+    misses += o.misses;
+    timely += o.timely;
+    late += o.late;
+    issued += o.issued;
+  }
+};
+
+
+class Cache {
+ public:
+  struct Line {
+    uint64_t tag = kNoArray;
+    uint64_t last_use = 0;
+    uint64_t ready = 0;
+    bool prefetched = false;  // filled by a prefetch and not yet demanded
+  };
+
+  Cache(const Config &config) :
+      line_shift_(__builtin_ctzll(config.line_bytes)), ways_(config.ways),
+      num_sets_(std::max<uint64_t>(
+          1, config.cache_bytes / config.line_bytes / config.ways)),
+      lines_(num_sets_ * ways_) {}
+
+  uint64_t LineOf(uint64_t addr) const { return addr >> line_shift_; }
+
+  Line* Find(uint64_t line) {
+    Line *set = &lines_[(line % num_sets_) * ways_];
+    for (uint64_t w=0; w < ways_; w++) {
+      if (set[w].tag == line)
+        return &set[w];
+    }
+    return nullptr;
+  }
+
+  // Evicts the least recently used line of the set for this one
+  Line* Fill(uint64_t line) {
+    Line *set = &lines_[(line % num_sets_) * ways_];
+    Line *victim = set;
+    for (uint64_t w=1; w < ways_; w++) {
+      if (set[w].last_use < victim->last_use)
+        victim = &set[w];
+    }
+    *victim = Line();
+    victim->tag = line;
+    return victim;
+  }
+
+ private:
+  int line_shift_;
+  uint64_t ways_;
+  uint64_t num_sets_;
+  std::vector<Line> lines_;
+};
+
+
+// Maps addresses to the traced array that holds them
+class ArrayMap {
+ public:
+  explicit ArrayMap(const std::vector<TraceArray> &arrays) {
+    for (size_t i=0; i < arrays.size(); i++)
+      starts_.push_back({arrays[i].vaddr_start, i});
+    std::sort(starts_.begin(), starts_.end());
+    ends_.resize(arrays.size());
+    for (size_t i=0; i < arrays.size(); i++)
+      ends_[i] = arrays[i].vaddr_end;
+  }
+
+  // Index of the array, or the number of arrays for "other"
+  size_t Lookup(uint64_t addr) const {
+    auto it = std::upper_bound(starts_.begin(), starts_.end(),
+                               std::make_pair(addr, kNoArray));
+    if (it != starts_.begin()) {
+      --it;
+      if (addr < ends_[it->second])
+        return it->second;
+    }
+    return ends_.size();
+  }
+
+ private:
+  std::vector<std::pair<uint64_t, size_t>> starts_;
+  std::vector<uint64_t> ends_;
+};
+
+
+struct Record {
+  uint64_t addr;
+  bool has_value;
+  uint64_t value;
+};
+
+std::vector<Record> DecodeStream(const AccessTrace &trace, size_t t) {
+  std::vector<Record> records;
+  records.reserve(trace.stream_records[t]);
+  const std::vector<uint8_t> &bytes = trace.streams[t];
+  TraceStreamReader reader(bytes.data(), bytes.data() + bytes.size());
+  Record r;
+  while (reader.Next(&r.addr, &r.has_value, &r.value))
+    records.push_back(r);
+  return records;
+}
+
+
+// Values read at each address: first by any thread, and over time by the
+// thread being replayed
+class ValueImage {
+ public:
+  void AddGlobal(uint64_t addr, uint64_t value) {
+    global_.insert({addr, value});
+  }
+
+  void SetThread(const std::vector<Record> &records) {
+    thread_.clear();
+    for (uint64_t t=0; t < records.size(); t++) {
+      const Record &r = records[t];
+      if (!r.has_value)
+        continue;
+      std::vector<std::pair<uint64_t, uint64_t>> &history = thread_[r.addr];
+      if (history.empty() || history.back().second != r.value)
+        history.push_back({t, r.value});
+    }
+  }
+
+  bool Lookup(uint64_t addr, uint64_t now, uint64_t *value) const {
+    auto it = thread_.find(addr);
+    if (it != thread_.end()) {
+      const auto &history = it->second;
+      auto next = std::lower_bound(
+          history.begin(), history.end(), std::make_pair(now, uint64_t(0)));
+      *value = next != history.end() ? next->second : history.back().second;
+      return true;
+    }
+    auto g = global_.find(addr);
+    if (g == global_.end())
+      return false;
+    *value = g->second;
+    return true;
+  }
+
+  // Whether the known 8-byte values in [start, end) never decrease
+  bool NonDecreasing(uint64_t start, uint64_t end) const {
+    std::vector<std::pair<uint64_t, uint64_t>> values;
+    for (const auto &kv : global_) {
+      if (kv.first >= start && kv.first < end)
+        values.push_back(kv);
+    }
+    if (values.size() < 2)
+      return false;
+    std::sort(values.begin(), values.end());
+    for (size_t i=1; i < values.size(); i++) {
+      if (values[i].second < values[i-1].second)
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  std::unordered_map<uint64_t, uint64_t> global_;
+  std::unordered_map<uint64_t,
+                     std::vector<std::pair<uint64_t, uint64_t>>> thread_;
+};
+
+
+struct ReplayResult {
+  std::vector<ArrayCounts> counts;  // per traced array, then "other"
+  uint64_t unknown_values = 0;      // chain steps at elements no thread read
+  // per job array, Pointer values outside the target that would be in range
+  // as Index values: the link likely has the wrong addressing mode
+  std::vector<uint64_t> index_like;
+};
+
+
+// Replays one thread's accesses with and without the device walking a job
+class ThreadReplay {
+ public:
+  ThreadReplay(const Config &config, const Job *job, const ValueImage &image,
+               const ArrayMap &arrays, ReplayResult *result) :
+      config_(config), job_(job), image_(image), arrays_(arrays),
+      result_(*result), counts_(result->counts), baseline_(config),
+      cache_(config), now_(0), next_pos_(0), ticks_(0),
+      last_line_(kNoArray) {}
+
+  void Run(const std::vector<Record> &records) {
+    const JobArray *driver = job_ ? &job_->arrays[job_->driver] : nullptr;
+    const uint64_t period = config_.period != 0 ? config_.period :
+                            std::max<uint64_t>(1, config_.distance / 4);
+    for (now_=0; now_ < records.size(); now_++) {
+      const uint64_t addr = records[now_].addr;
+      ArrayCounts &c = counts_[arrays_.Lookup(addr)];
+      c.accesses++;
+      Demand(addr, &c);
+      if (driver != nullptr && addr >= driver->vaddr_start &&
+          addr < driver->vaddr_end && ++ticks_ % period == 0)
+        Advance(*driver, (addr - driver->vaddr_start) /
+                         std::max<uint64_t>(driver->element_size, 1));
+    }
+  }
+
+ private:
+  const Config &config_;
+  const Job *job_;
+  const ValueImage &image_;
+  const ArrayMap &arrays_;
+  ReplayResult &result_;
+  std::vector<ArrayCounts> &counts_;
+  Cache baseline_;
+  Cache cache_;
+  uint64_t now_;
+  uint64_t next_pos_;
+  uint64_t ticks_;
+  uint64_t last_line_;
+
+  void Demand(uint64_t addr, ArrayCounts *c) {
+    const uint64_t line = baseline_.LineOf(addr);
+    Cache::Line *b = baseline_.Find(line);
+    if (b == nullptr) {
+      c->baseline_misses++;
+      b = baseline_.Fill(line);
+    }
+    b->last_use = now_ + 1;
+    Cache::Line *l = cache_.Find(line);
+    if (l == nullptr) {
+      c->misses++;
+      l = cache_.Fill(line);
+    } else if (l->prefetched) {
+      if (l->ready <= now_)
+        c->timely++;
+      else
+        c->late++;
+      l->prefetched = false;
+    }
+    l->last_use = now_ + 1;
+  }
+
+  void Prefetch(uint64_t addr) {
+    const uint64_t line = cache_.LineOf(addr);
+    if (line == last_line_)
+      return;
+    last_line_ = line;
+    if (cache_.Find(line) != nullptr)
+      return;
+    counts_[arrays_.Lookup(addr)].issued++;
+    Cache::Line *l = cache_.Fill(line);
+    l->prefetched = true;
+    l->ready = now_ + config_.latency;
+    l->last_use = now_;
+  }
+
+  // The device heard the thread is at pos of the driver
+  void Advance(const JobArray &driver, uint64_t pos) {
+    if (next_pos_ <= pos || next_pos_ > pos + config_.distance + 1)
+      next_pos_ = pos + 1;
+    const uint64_t end = std::min(pos + config_.distance + 1,
+                                  driver.num_elements());
+    for (; next_pos_ < end; next_pos_++)
+      Walk(driver, next_pos_, 0);
+  }
+
+  void Walk(const JobArray &a, uint64_t pos, size_t depth) {
+    if (pos >= a.num_elements())
+      return;
+    const uint64_t addr = a.ElementAddress(pos);
+    Prefetch(addr);
+    if (a.dst == kNoArray || depth >= job_->arrays.size())
+      return;
+    uint64_t value;
+    if (a.access_type == AccessType::SetBits ||
+        !image_.Lookup(addr, now_, &value)) {
+      result_.unknown_values++;
+      return;
+    }
+    const JobArray &dst = job_->arrays[a.dst];
+    uint64_t first;
+    if (!TargetPosition(a, dst, value, &first))
+      return;
+    if (!a.ranged) {
+      Walk(dst, first, depth + 1);
+      return;
+    }
+    uint64_t next_value, last;
+    if (!image_.Lookup(addr + a.element_size, now_, &next_value)) {
+      result_.unknown_values++;
+      return;
+    }
+    if (!TargetPosition(a, dst, next_value, &last))
+      return;
+    last = std::min(last, first + config_.range_limit);
+    for (uint64_t p=first; p < last; p++)
+      Walk(dst, p, depth + 1);
+  }
+
+  bool TargetPosition(const JobArray &a, const JobArray &dst, uint64_t value,
+                      uint64_t *pos) {
+    if (a.addressing_mode == AddressingMode::Index) {
+      *pos = value;
+      return true;
+    }
+    if (value < dst.vaddr_start || value > dst.vaddr_end) {
+      if (value <= dst.num_elements())
+        result_.index_like[&a - job_->arrays.data()]++;
+      return false;
+    }
+    *pos = (value - dst.vaddr_start) /
+           std::max<uint64_t>(dst.element_size, 1);
+    return true;
+  }
+};
+
+
+ReplayResult Replay(const AccessTrace &trace, const Config &config,
+                    const Job *job, ValueImage &image) {
+  ArrayMap arrays(trace.arrays);
+  ReplayResult result;
+  result.counts.resize(trace.arrays.size() + 1);
+  result.index_like.resize(job != nullptr ? job->arrays.size() : 0);
+  for (size_t t=0; t < trace.streams.size(); t++) {
+    std::vector<Record> records = DecodeStream(trace, t);
+    image.SetThread(records);
+    ThreadReplay replay(config, job, image, arrays, &result);
+    replay.Run(records);
+  }
+  return result;
+}
+
+
+std::string Percent(uint64_t num, uint64_t den) {
+  if (den == 0)
+    return "-";
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%.1f%%", 100.0 * num / den);
+  return buf;
+}
+
+std::string ArrayLabel(const AccessTrace &trace, size_t i) {
+  if (i == trace.arrays.size())
+    return "other";
+  const TraceArray &a = trace.arrays[i];
+  std::string name = a.name == "unknown" ? "array" : a.name;
+  return name + "[" + std::to_string((a.vaddr_end - a.vaddr_start) /
+                                     std::max<uint64_t>(a.element_size, 1)) +
+         " x " + std::to_string(a.element_size) + "B]";
+}
+
+void PrintJob(const AccessTrace &trace, const Job &job) {
+  ArrayMap arrays(trace.arrays);
+  std::cout << "Job " << job.kernel_name << " (sent " << job.times_sent
+            << "x), driven by array " << job.driver << ":" << std::endl;
+  for (size_t i=0; i < job.arrays.size(); i++) {
+    const JobArray &a = job.arrays[i];
+    std::cout << "  " << i << " " << ArrayLabel(trace,
+                                               arrays.Lookup(a.vaddr_start));
+    if (a.dst != kNoArray)
+      std::cout << " -> " << a.dst
+                << (a.addressing_mode == AddressingMode::Index ? " (Index" :
+                                                                " (Pointer")
+                << (a.ranged ? ", ranged)" : ")");
+    std::cout << std::endl;
+  }
+}
+
+void PrintResult(const AccessTrace &trace, const ReplayResult &result) {
+  const std::vector<ArrayCounts> &counts = result.counts;
+  printf("  %-28s %10s %10s %9s %7s %9s %9s\n", "array", "accesses",
+         "misses", "coverage", "late", "accuracy", "overhead");
+  ArrayCounts total;
+  for (size_t i=0; i < counts.size(); i++) {
+    const ArrayCounts &c = counts[i];
+    total.Add(c);
+    if (c.accesses == 0 && c.issued == 0)
+      continue;
+    const uint64_t removed = c.baseline_misses - std::min(c.baseline_misses,
+                                                          c.misses);
+    const uint64_t traffic = c.misses + c.issued;
+    printf("  %-28s %10" PRIu64 " %10" PRIu64 " %9s %7s %9s %9s\n",
+           ArrayLabel(trace, i).c_str(), c.accesses, c.baseline_misses,
+           Percent(removed, c.baseline_misses).c_str(),
+           Percent(c.late, c.timely + c.late).c_str(),
+           Percent(c.timely + c.late, c.issued).c_str(),
+           Percent(traffic - std::min(traffic, c.baseline_misses),
+                   c.baseline_misses).c_str());
+  }
+  const uint64_t removed = total.baseline_misses -
+                           std::min(total.baseline_misses, total.misses);
+  const uint64_t traffic = total.misses + total.issued;
+  printf("  %-28s %10" PRIu64 " %10" PRIu64 " %9s %7s %9s %9s\n", "total",
+         total.accesses, total.baseline_misses,
+         Percent(removed, total.baseline_misses).c_str(),
+         Percent(total.late, total.timely + total.late).c_str(),
+         Percent(total.timely + total.late, total.issued).c_str(),
+         Percent(traffic - std::min(traffic, total.baseline_misses),
+                 total.baseline_misses).c_str());
+  if (result.unknown_values != 0)
+    std::cout << "  " << result.unknown_values << " chain steps stopped at "
+              << "elements no thread read" << std::endl;
+  for (size_t i=0; i < result.index_like.size(); i++) {
+    if (result.index_like[i] != 0)
+      std::cout << "  " << result.index_like[i] << " values of job array "
+                << i << " miss its Pointer target but fit as indexes; "
+                << "should the link use Index?" << std::endl;
+  }
+}
+
+
+int main(int argc, char* argv[]) {
+  Config config;
+  int job_index = -1;
+  std::string descriptor_filename = "";
+  signed char c_opt;
+  while ((c_opt = getopt(argc, argv, "j:d:D:p:l:c:w:L:r:h")) != -1) {
+    switch (c_opt) {
+      case 'j': job_index = std::stoi(optarg);                  break;
+      case 'd': descriptor_filename = std::string(optarg);      break;
+      case 'D': config.distance = std::stoull(optarg);          break;
+      case 'p': config.period = std::stoull(optarg);            break;
+      case 'l': config.latency = std::stoull(optarg);           break;
+      case 'c': config.cache_bytes = std::stoull(optarg) << 10; break;
+      case 'w': config.ways = std::stoull(optarg);              break;
+      case 'L': config.line_bytes = std::stoull(optarg);        break;
+      case 'r': config.range_limit = std::stoull(optarg);       break;
+      default:
+        std::cout << "trace_analyzer [-j job] [-d job.bin] [-D distance] "
+                  << "[-p publish period] [-l latency in accesses] "
+                  << "[-c cache KiB] [-w ways] [-L line bytes] "
+                  << "[-r range limit] trace" << std::endl;
+        return c_opt == 'h' ? 0 : -1;
+    }
+  }
+  if (optind != argc - 1) {
+    std::cout << "trace_analyzer needs one trace file" << std::endl;
+    return -1;
+  }
+  if (config.ways == 0 || config.line_bytes == 0 ||
+      (config.line_bytes & (config.line_bytes - 1)) != 0) {
+    std::cout << "line size must be a power of two and ways at least 1"
+              << std::endl;
+    return -1;
+  }
+
+  AccessTrace trace;
+  if (!trace.Read(argv[optind]))
+    return -1;
+  std::vector<std::vector<uint8_t>> descriptors = trace.jobs;
+  if (!descriptor_filename.empty()) {
+    std::ifstream in(descriptor_filename, std::ios::binary);
+    if (!in.is_open()) {
+      std::cout << "Couldn't open " << descriptor_filename << std::endl;
+      return -1;
+    }
+    descriptors = {std::vector<uint8_t>(std::istreambuf_iterator<char>(in),
+                                        std::istreambuf_iterator<char>())};
+  } else if (job_index >= 0) {
+    if (job_index >= static_cast<int>(descriptors.size())) {
+      std::cout << "The trace holds " << descriptors.size() << " jobs"
+                << std::endl;
+      return -1;
+    }
+    descriptors = {descriptors[job_index]};
+  }
+
+  ValueImage image;
+  uint64_t records = 0;
+  for (size_t t=0; t < trace.streams.size(); t++) {
+    for (const Record &r : DecodeStream(trace, t)) {
+      if (r.has_value)
+        image.AddGlobal(r.addr, r.value);
+    }
+    records += trace.stream_records[t];
+  }
+  std::cout << "Trace: " << records << " accesses by "
+            << trace.streams.size() << " threads to " << trace.arrays.size()
+            << " arrays" << std::endl;
+  std::cout << "Model: " << (config.cache_bytes >> 10) << " KiB "
+            << config.ways << "-way cache per thread, " << config.line_bytes
+            << "B lines, distance " << config.distance << ", latency "
+            << config.latency << " accesses" << std::endl;
+
+  // identical descriptors (a job resent every step) are replayed once
+  std::vector<Job> jobs;
+  std::map<std::vector<uint8_t>, size_t> seen;
+  for (const std::vector<uint8_t> &bytes : descriptors) {
+    auto it = seen.find(bytes);
+    if (it != seen.end()) {
+      jobs[it->second].times_sent++;
+      continue;
+    }
+    Job job;
+    if (!ParseJob(bytes, &job)) {
+      std::cout << "Skipping a malformed or rootless job descriptor"
+                << std::endl;
+      continue;
+    }
+    for (JobArray &a : job.arrays) {
+      a.ranged = a.access_type == AccessType::Ranged ||
+                 (a.element_size == 8 && a.access_type != AccessType::SetBits &&
+                  image.NonDecreasing(a.vaddr_start, a.vaddr_end));
+    }
+    job.times_sent = 1;
+    seen[bytes] = jobs.size();
+    jobs.push_back(job);
+  }
+
+  std::cout << std::endl << "Without prefetching:" << std::endl;
+  PrintResult(trace, Replay(trace, config, nullptr, image));
+  for (const Job &job : jobs) {
+    std::cout << std::endl;
+    PrintJob(trace, job);
+    PrintResult(trace, Replay(trace, config, &job, image));
+  }
+  return 0;
+}